@@ -0,0 +1,88 @@
+#ifndef ARG_PARSE_H_
+#define ARG_PARSE_H_
+
+//!  Checked parsing of numeric command-line values.
+/*!
+  \file arg_parse.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  std::stoul and friends throw std::invalid_argument, which the drivers do
+  not catch, and quietly wrap negative input around to huge unsigned values.
+  These helpers accept only a whole value that fits its type and report
+  anything else as a std::runtime_error naming the flag, so a bad value ends
+  up on the drivers' ordinary "Error: ..." path.
+ */
+
+#include <charconv>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+
+//! Parses the value given for a command-line flag.
+/*!
+  Unsigned types reject a leading minus sign rather than wrapping it.
+  \param flag the flag the value belongs to, for the error message
+  \param value the text to parse
+  \return The parsed value
+  \throws std::runtime_error if value is not entirely a number of type Number
+ */
+template <typename Number>
+Number ParseNumberArg(const std::string &flag, const std::string &value) {
+    Number number{};
+    const char *end = value.data() + value.size();
+    const std::from_chars_result kResult =
+        std::from_chars(value.data(), end, number);
+
+    if (kResult.ec == std::errc::result_out_of_range) {
+        throw std::runtime_error(flag + ": \"" + value + "\" is out of range");
+    }
+    if (kResult.ec != std::errc() || kResult.ptr != end || value.empty()) {
+        throw std::runtime_error(flag + ": \"" + value +
+                                 "\" is not a valid number");
+    }
+
+    return number;
+} // ParseNumberArg
+
+//! Parses a fraction given for a command-line flag.
+/*!
+  NaN is rejected along with everything else outside [0, 1], since every
+  comparison against it would be false.
+  \param flag the flag the value belongs to, for the error message
+  \param value the text to parse
+  \return The parsed value
+  \throws std::runtime_error if value is not a number between 0 and 1
+ */
+double ParseFractionArg(const std::string &flag, const std::string &value) {
+    const double kFraction = ParseNumberArg<double>(flag, value);
+    if (!(kFraction >= 0.0 && kFraction <= 1.0)) {
+        throw std::runtime_error(flag + ": \"" + value +
+                                 "\" is not between 0 and 1");
+    }
+
+    return kFraction;
+} // ParseFractionArg
+
+//! Parses a size in MiB given for a command-line flag.
+/*!
+  \param flag the flag the value belongs to, for the error message
+  \param value the text to parse, a whole number of MiB
+  \return The size in bytes
+  \throws std::runtime_error if value is not a count of MiB that fits in
+  std::size_t once converted to bytes
+ */
+std::size_t ParseMibArg(const std::string &flag, const std::string &value) {
+    const std::size_t kMib = ParseNumberArg<std::size_t>(flag, value);
+    if (kMib > std::numeric_limits<std::size_t>::max() >> 20) {
+        throw std::runtime_error(flag + ": \"" + value + "\" is out of range");
+    }
+
+    return kMib << 20;
+} // ParseMibArg
+
+#endif
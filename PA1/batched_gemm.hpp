@@ -0,0 +1,344 @@
+#ifndef BATCHED_GEMM_H_
+#define BATCHED_GEMM_H_
+
+//!  Batched products of many same-shape small matrices.
+/*!
+  \file batched_gemm.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  A MatBatch cuts the batch into blocks of kBatchBlockLanes matrices and
+  stores element (row, col) of every matrix in a block next to each other,
+  so one vector register holds the same element of kGemmVecLen different
+  matrices. The kernels run the textbook triple loop once per group of
+  lanes, and every multiply-add serves a whole group; no packing, no
+  per-product allocation and no runtime-sized inner loops. Blocks are
+  contiguous, so a kernel streams through a few pages at a time instead of
+  touching one page per element.
+
+  Common shapes, including every shape part_two_b multiplies, are compiled
+  as templates with all three loops unrolled. Other shapes fall back to the
+  same loop with runtime bounds.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./gemm.hpp"
+
+//! Matrices interleaved together in one block of a MatBatch; a multiple of
+//! kGemmVecLen.
+const Eigen::Index kBatchBlockLanes = 16;
+
+
+//! Class holding count same-shape matrices, interleaved in blocks.
+class MatBatch {
+  public:
+    //! Holds an empty batch.
+    MatBatch() = default;
+
+    //! Holds count zero rows x cols matrices.
+    /*!
+      \param rows the rows of every matrix
+      \param cols the columns of every matrix
+      \param count the number of matrices
+     */
+    MatBatch(Eigen::Index rows, Eigen::Index cols, Eigen::Index count)
+        : rows_(rows), cols_(cols), count_(count),
+          block_count_((count + kBatchBlockLanes - 1) / kBatchBlockLanes),
+          data_(static_cast<std::size_t>(rows * cols * block_count_ *
+                                         kBatchBlockLanes), 0.0) {
+    } // constructor
+
+    //! Returns the rows of every matrix.
+    Eigen::Index GetRows() const {
+        return rows_;
+    } // GetRows
+
+    //! Returns the columns of every matrix.
+    Eigen::Index GetCols() const {
+        return cols_;
+    } // GetCols
+
+    //! Returns the number of matrices.
+    Eigen::Index GetCount() const {
+        return count_;
+    } // GetCount
+
+    //! Returns the number of blocks; the last is padded with zero matrices.
+    Eigen::Index GetBlockCount() const {
+        return block_count_;
+    } // GetBlockCount
+
+    //! Returns the interleaved storage.
+    const double *GetData() const {
+        return data_.data();
+    } // GetData
+
+    //! Returns the interleaved storage.
+    double *GetData() {
+        return data_.data();
+    } // GetData
+
+    //! Returns element (row, col) of matrix index.
+    double &At(Eigen::Index index, Eigen::Index row, Eigen::Index col) {
+        return data_[GetOffset(index, row, col)];
+    } // At
+
+    //! Returns element (row, col) of matrix index.
+    double At(Eigen::Index index, Eigen::Index row, Eigen::Index col) const {
+        return data_[GetOffset(index, row, col)];
+    } // At
+
+    //! Copies mat, which must be rows x cols, into slot index.
+    void Set(Eigen::Index index, const Eigen::MatrixXd &mat) {
+        if (mat.rows() != rows_ || mat.cols() != cols_) {
+            throw std::runtime_error("matrix does not match the batch shape");
+        }
+
+        for (Eigen::Index col = 0; col < cols_; col++) {
+            for (Eigen::Index row = 0; row < rows_; row++) {
+                At(index, row, col) = mat(row, col);
+            }
+        }
+    } // Set
+
+    //! Returns a copy of matrix index.
+    Eigen::MatrixXd Get(Eigen::Index index) const {
+        Eigen::MatrixXd mat(rows_, cols_);
+        for (Eigen::Index col = 0; col < cols_; col++) {
+            for (Eigen::Index row = 0; row < rows_; row++) {
+                mat(row, col) = At(index, row, col);
+            }
+        }
+
+        return mat;
+    } // Get
+
+  private:
+    //! Returns where element (row, col) of matrix index is stored.
+    Eigen::Index GetOffset(Eigen::Index index, Eigen::Index row,
+                           Eigen::Index col) const {
+        return ((index / kBatchBlockLanes) * rows_ * cols_ + row +
+                col * rows_) * kBatchBlockLanes + index % kBatchBlockLanes;
+    } // GetOffset
+
+    Eigen::Index rows_ = 0;
+    Eigen::Index cols_ = 0;
+    Eigen::Index count_ = 0;
+    Eigen::Index block_count_ = 0;
+    std::vector<double> data_;
+};
+
+//! Signature shared by every batched product kernel: C = A * B across
+//! block_count blocks of interleaved storage.
+typedef void (*BatchedGemmKernel)(Eigen::Index block_count, const double *a,
+                                  const double *b, double *c);
+
+//! A shape with a compiled kernel.
+struct BatchedGemmShape {
+    //! Rows of A and C.
+    Eigen::Index m;
+    //! Columns of A and rows of B.
+    Eigen::Index k;
+    //! Columns of B and C.
+    Eigen::Index n;
+    //! The kernel for m x k times k x n.
+    BatchedGemmKernel kernel;
+};
+
+
+//! Builds a batch from same-shape matrices.
+/*!
+  \param mats the matrices, all of one shape
+  \return The batch
+ */
+MatBatch MakeMatBatch(const std::vector<Eigen::MatrixXd> &mats) {
+    if (mats.empty()) {
+        return MatBatch();
+    }
+
+    MatBatch batch(mats[0].rows(), mats[0].cols(),
+                   static_cast<Eigen::Index>(mats.size()));
+    for (std::size_t index = 0; index < mats.size(); index++) {
+        batch.Set(static_cast<Eigen::Index>(index), mats[index]);
+    }
+
+    return batch;
+} // MakeMatBatch
+
+//! Computes C = A * B for every lane, with M, K and N fixed at compile time.
+/*!
+  \param block_count the number of blocks to compute
+  \param a interleaved M x K matrices
+  \param b interleaved K x N matrices
+  \param c interleaved M x N matrices, overwritten
+ */
+template <int M, int K, int N>
+void BatchedGemmFixed(Eigen::Index block_count, const double *a,
+                      const double *b, double *c) {
+    typedef double BatchVec
+        __attribute__((vector_size(kGemmVecLen * sizeof(double))));
+    const Eigen::Index kLanes = kBatchBlockLanes;
+
+    for (Eigen::Index block = 0; block < block_count; block++) {
+        for (Eigen::Index lane = 0; lane < kLanes; lane += kGemmVecLen) {
+            BatchVec a_vecs[M * K];
+            BatchVec b_vecs[K * N];
+#pragma GCC unroll 64
+            for (int element = 0; element < M * K; element++) {
+                __builtin_memcpy(&a_vecs[element],
+                                 a + element * kLanes + lane,
+                                 sizeof(BatchVec));
+            }
+#pragma GCC unroll 64
+            for (int element = 0; element < K * N; element++) {
+                __builtin_memcpy(&b_vecs[element],
+                                 b + element * kLanes + lane,
+                                 sizeof(BatchVec));
+            }
+
+#pragma GCC unroll 16
+            for (int col = 0; col < N; col++) {
+#pragma GCC unroll 16
+                for (int row = 0; row < M; row++) {
+                    BatchVec sum = a_vecs[row] * b_vecs[col * K];
+#pragma GCC unroll 16
+                    for (int depth = 1; depth < K; depth++) {
+                        sum += a_vecs[row + depth * M] *
+                               b_vecs[depth + col * K];
+                    }
+                    __builtin_memcpy(c + (row + col * M) * kLanes + lane,
+                                     &sum, sizeof(BatchVec));
+                }
+            }
+        }
+
+        a += M * K * kLanes;
+        b += K * N * kLanes;
+        c += M * N * kLanes;
+    }
+} // BatchedGemmFixed
+
+//! Computes C = A * B for every lane, for shapes without a compiled kernel.
+/*!
+  \param m the rows of A and C
+  \param k the columns of A and rows of B
+  \param n the columns of B and C
+  \param block_count the number of blocks to compute
+  \param a interleaved m x k matrices
+  \param b interleaved k x n matrices
+  \param c interleaved m x n matrices, overwritten
+ */
+void BatchedGemmDynamic(Eigen::Index m, Eigen::Index k, Eigen::Index n,
+                        Eigen::Index block_count, const double *a,
+                        const double *b, double *c) {
+    typedef double BatchVec
+        __attribute__((vector_size(kGemmVecLen * sizeof(double))));
+    const Eigen::Index kLanes = kBatchBlockLanes;
+
+    for (Eigen::Index block = 0; block < block_count; block++) {
+        for (Eigen::Index lane = 0; lane < kLanes; lane += kGemmVecLen) {
+            for (Eigen::Index col = 0; col < n; col++) {
+                for (Eigen::Index row = 0; row < m; row++) {
+                    BatchVec sum = {};
+                    for (Eigen::Index depth = 0; depth < k; depth++) {
+                        BatchVec a_vec;
+                        BatchVec b_vec;
+                        __builtin_memcpy(
+                            &a_vec, a + (row + depth * m) * kLanes + lane,
+                            sizeof(BatchVec));
+                        __builtin_memcpy(
+                            &b_vec, b + (depth + col * k) * kLanes + lane,
+                            sizeof(BatchVec));
+                        sum += a_vec * b_vec;
+                    }
+                    __builtin_memcpy(c + (row + col * m) * kLanes + lane,
+                                     &sum, sizeof(BatchVec));
+                }
+            }
+        }
+
+        a += m * k * kLanes;
+        b += k * n * kLanes;
+        c += m * n * kLanes;
+    }
+} // BatchedGemmDynamic
+
+//! Shapes with compiled kernels: small cubes, matrix-vector products and
+//! every product of part_one's 5 x 5, 5 x 6 and 6 x 5 matrices.
+const BatchedGemmShape kBatchedGemmShapes[] = {
+    {2, 2, 2, &BatchedGemmFixed<2, 2, 2>},
+    {3, 3, 3, &BatchedGemmFixed<3, 3, 3>},
+    {4, 4, 4, &BatchedGemmFixed<4, 4, 4>},
+    {5, 5, 5, &BatchedGemmFixed<5, 5, 5>},
+    {6, 6, 6, &BatchedGemmFixed<6, 6, 6>},
+    {8, 8, 8, &BatchedGemmFixed<8, 8, 8>},
+    {3, 3, 1, &BatchedGemmFixed<3, 3, 1>},
+    {4, 4, 1, &BatchedGemmFixed<4, 4, 1>},
+    {5, 5, 6, &BatchedGemmFixed<5, 5, 6>},
+    {5, 6, 5, &BatchedGemmFixed<5, 6, 5>},
+    {6, 5, 5, &BatchedGemmFixed<6, 5, 5>},
+    {6, 5, 6, &BatchedGemmFixed<6, 5, 6>},
+};
+
+//! Finds the compiled kernel for a shape.
+/*!
+  \param m the rows of A and C
+  \param k the columns of A and rows of B
+  \param n the columns of B and C
+  \return The kernel, or nullptr if the shape has none
+ */
+BatchedGemmKernel FindBatchedGemmKernel(Eigen::Index m, Eigen::Index k,
+                                        Eigen::Index n) {
+    for (const BatchedGemmShape &shape : kBatchedGemmShapes) {
+        if (shape.m == m && shape.k == k && shape.n == n) {
+            return shape.kernel;
+        }
+    }
+
+    return nullptr;
+} // FindBatchedGemmKernel
+
+//! Computes product[i] = input_1[i] * input_2[i] for every i in the batch.
+/*!
+  product is only reallocated when its shape or count is wrong, so reusing
+  it across calls keeps the product allocation-free.
+  \param input_1 the left operands
+  \param input_2 the right operands, as many as input_1
+  \param product the output batch
+ */
+void BatchedGemm(const MatBatch &input_1, const MatBatch &input_2,
+                 MatBatch &product) {
+    if (input_1.GetCount() != input_2.GetCount()) {
+        throw std::runtime_error("batches hold different numbers of matrices");
+    }
+    if (input_1.GetCols() != input_2.GetRows()) {
+        throw std::runtime_error(
+            "matrices have incompatible dimensions for multiplication");
+    }
+
+    const Eigen::Index m = input_1.GetRows();
+    const Eigen::Index k = input_1.GetCols();
+    const Eigen::Index n = input_2.GetCols();
+    if (product.GetRows() != m || product.GetCols() != n ||
+            product.GetCount() != input_1.GetCount()) {
+        product = MatBatch(m, n, input_1.GetCount());
+    }
+
+    const BatchedGemmKernel kernel = FindBatchedGemmKernel(m, k, n);
+    if (kernel != nullptr) {
+        kernel(input_1.GetBlockCount(), input_1.GetData(), input_2.GetData(),
+               product.GetData());
+    } else {
+        BatchedGemmDynamic(m, k, n, input_1.GetBlockCount(),
+                           input_1.GetData(), input_2.GetData(),
+                           product.GetData());
+    }
+} // BatchedGemm
+
+#endif
@@ -0,0 +1,594 @@
+// Jacob Hartt
+// CS2300(T/R)
+// 10/16/2026
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <eigen3/Eigen/Dense> // Headers are located at /usr/include/eigen3
+
+#include "../arg_parse.hpp"
+#include "../batched_gemm.hpp"
+#include "../compressed_mat.hpp"
+#include "../integer_mat.hpp"
+#include "../mat_io.hpp"
+#include "../mat_sum.hpp"
+#include "../parallel_gemm.hpp"
+#include "../structured_gemm.hpp"
+
+
+// Matrices per batch in the batched product cases.
+const Eigen::Index kBenchmarkBatchCount = 4096;
+
+// Samples shorter than this are batched, so tiny shapes still get a
+// measurable interval per sample.
+const double kMinSampleSeconds = 1e-3;
+
+// One operation to time, and what it moves and computes per call.
+struct BenchmarkCase {
+    std::string name;
+    std::string kernel;
+    std::vector<Eigen::Index> shape;
+    double flops;
+    double bytes;
+    std::function<void()> run;
+};
+
+// Timing statistics for one case, in seconds per call.
+struct BenchmarkResult {
+    const BenchmarkCase *bench_case;
+    int samples;
+    long long calls_per_sample;
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double mean;
+};
+
+// The same kernels the part_two drivers' MatSumCustom, MatSumEigen,
+// MatProductCustom and MatProductEigen call, with the same allocation of a
+// fresh result on every call. The Into cases reuse one result instead, as
+// the drivers' MatSumCustomInto and MatProductCustomInto do.
+Eigen::MatrixXd MatSumCustom(const Eigen::MatrixXd &input_1,
+                             const Eigen::MatrixXd &input_2);
+Eigen::MatrixXd MatSumEigen(const Eigen::MatrixXd &input_1,
+                            const Eigen::MatrixXd &input_2);
+Eigen::MatrixXd MatProductCustom(const Eigen::MatrixXd &input_1,
+                                 const Eigen::MatrixXd &input_2,
+                                 unsigned int thread_count);
+Eigen::MatrixXd MatProductEigen(const Eigen::MatrixXd &input_1,
+                                const Eigen::MatrixXd &input_2);
+
+// Times bench_case: calibrates a batch size, then takes samples batches.
+BenchmarkResult RunBenchmark(const BenchmarkCase &bench_case, int samples);
+
+// Returns the q-th quantile (0 to 1) of sorted values.
+double Quantile(const std::vector<double> &sorted, double q);
+
+// Adds sum, product and file I/O cases over the standard shapes. Matrices
+// the cases refer to are kept in storage, and the files the I/O cases use
+// are added to scratch_files.
+void AddBenchmarkCases(std::vector<BenchmarkCase> &cases,
+                       std::deque<Eigen::MatrixXd> &storage,
+                       std::vector<std::string> &scratch_files,
+                       const std::string &scratch_dir,
+                       unsigned int thread_count, bool quick);
+
+// Prints a human-readable table of results.
+void PrintResults(const std::vector<BenchmarkResult> &results);
+
+// Writes results as JSON to json_path.
+void WriteResultsJson(const std::vector<BenchmarkResult> &results,
+                      const std::string &json_path, int samples,
+                      unsigned int thread_count);
+
+// Prints how to call the program.
+void PrintUsage(const std::string &program_name);
+
+// Keeps results alive so the compiler cannot drop the timed work.
+volatile double benchmark_sink = 0.0;
+
+
+int main(int argc, char *argv[]) {
+    int samples = 20;
+    unsigned int thread_count = 0;
+    bool quick = false;
+    std::string json_path;
+    std::string scratch_dir = ".";
+
+    try {
+        for (int arg = 1; arg < argc; arg++) {
+            const std::string kFlag = argv[arg];
+            const bool kHasValue = arg + 1 < argc;
+
+            if (kFlag == "--samples" && kHasValue) {
+                samples = std::max(1, ParseNumberArg<int>(kFlag, argv[++arg]));
+            } else if (kFlag == "--threads" && kHasValue) {
+                thread_count =
+                    ParseNumberArg<unsigned int>(kFlag, argv[++arg]);
+            } else if (kFlag == "--json" && kHasValue) {
+                json_path = argv[++arg];
+            } else if (kFlag == "--scratch" && kHasValue) {
+                scratch_dir = argv[++arg];
+            } else if (kFlag == "--quick") {
+                quick = true;
+            } else {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        std::vector<BenchmarkCase> cases;
+        std::deque<Eigen::MatrixXd> storage;
+        std::vector<std::string> scratch_files;
+        AddBenchmarkCases(cases, storage, scratch_files, scratch_dir,
+                          thread_count, quick);
+
+        std::vector<BenchmarkResult> results;
+        for (const BenchmarkCase &bench_case : cases) {
+            results.push_back(RunBenchmark(bench_case, samples));
+        }
+
+        PrintResults(results);
+        if (!json_path.empty()) {
+            WriteResultsJson(results, json_path, samples, thread_count);
+        }
+
+        for (const std::string &path : scratch_files) {
+            std::remove(path.c_str());
+        }
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // main
+
+Eigen::MatrixXd MatSumCustom(const Eigen::MatrixXd &input_1,
+                             const Eigen::MatrixXd &input_2) {
+    Eigen::MatrixXd sum_mat;
+    SumContiguous(input_1, input_2, sum_mat);
+    return sum_mat;
+} // MatSumCustom
+
+Eigen::MatrixXd MatSumEigen(const Eigen::MatrixXd &input_1,
+                            const Eigen::MatrixXd &input_2) {
+    return input_1 + input_2;
+} // MatSumEigen
+
+Eigen::MatrixXd MatProductCustom(const Eigen::MatrixXd &input_1,
+                                 const Eigen::MatrixXd &input_2,
+                                 unsigned int thread_count) {
+    Eigen::MatrixXd product_mat;
+    GemmParallel(input_1, input_2, product_mat, thread_count);
+    return product_mat;
+} // MatProductCustom
+
+Eigen::MatrixXd MatProductEigen(const Eigen::MatrixXd &input_1,
+                                const Eigen::MatrixXd &input_2) {
+    return input_1 * input_2;
+} // MatProductEigen
+
+BenchmarkResult RunBenchmark(const BenchmarkCase &bench_case, int samples) {
+    typedef std::chrono::steady_clock Clock;
+    auto time_calls = [&bench_case](long long calls) {
+        const Clock::time_point kStart = Clock::now();
+        for (long long call = 0; call < calls; call++) {
+            bench_case.run();
+        }
+        return std::chrono::duration<double>(Clock::now() - kStart).count();
+    };
+
+    // warm caches and the allocator, then grow the batch until it is long
+    // enough for the clock
+    bench_case.run();
+    long long calls = 1;
+    while (time_calls(calls) < kMinSampleSeconds && calls < (1LL << 30)) {
+        calls *= 2;
+    }
+
+    std::vector<double> seconds;
+    for (int sample = 0; sample < samples; sample++) {
+        seconds.push_back(time_calls(calls) / static_cast<double>(calls));
+    }
+    std::sort(seconds.begin(), seconds.end());
+
+    BenchmarkResult result;
+    result.bench_case = &bench_case;
+    result.samples = samples;
+    result.calls_per_sample = calls;
+    result.min = seconds.front();
+    result.p50 = Quantile(seconds, 0.50);
+    result.p90 = Quantile(seconds, 0.90);
+    result.p99 = Quantile(seconds, 0.99);
+    result.mean = 0.0;
+    for (double value : seconds) {
+        result.mean += value / static_cast<double>(samples);
+    }
+
+    return result;
+} // RunBenchmark
+
+double Quantile(const std::vector<double> &sorted, double q) {
+    // linear interpolation between the closest ranks
+    const double position = q * static_cast<double>(sorted.size() - 1);
+    const std::size_t lower = static_cast<std::size_t>(position);
+    const std::size_t upper = std::min(lower + 1, sorted.size() - 1);
+    const double fraction = position - static_cast<double>(lower);
+
+    return sorted[lower] + fraction * (sorted[upper] - sorted[lower]);
+} // Quantile
+
+void AddBenchmarkCases(std::vector<BenchmarkCase> &cases,
+                       std::deque<Eigen::MatrixXd> &storage,
+                       std::vector<std::string> &scratch_files,
+                       const std::string &scratch_dir,
+                       unsigned int thread_count, bool quick) {
+    auto make = [&storage](Eigen::Index rows, Eigen::Index cols)
+            -> const Eigen::MatrixXd & {
+        storage.push_back(Eigen::MatrixXd::Random(rows, cols));
+        return storage.back();
+    };
+    auto shape_name = [](const std::vector<Eigen::Index> &shape) {
+        std::string name;
+        for (Eigen::Index dim : shape) {
+            name += (name.empty() ? "" : "x") + std::to_string(dim);
+        }
+        return name;
+    };
+
+    // rows x cols: part_one's shapes, squares, and tall-skinny
+    std::vector<std::vector<Eigen::Index>> sum_shapes{
+        {5, 6}, {6, 5}, {256, 256}, {1024, 1024}, {100000, 8}};
+    // m x k x n: part_one's shapes, squares, tall-skinny and a long inner
+    // dimension
+    std::vector<std::vector<Eigen::Index>> product_shapes{
+        {5, 6, 5}, {6, 5, 6}, {64, 64, 64}, {256, 256, 256},
+        {1024, 1024, 1024}, {20000, 32, 32}, {32, 20000, 32}};
+    std::vector<Eigen::Index> io_sizes{5, 256, 1024};
+    if (quick) {
+        sum_shapes.resize(3);
+        product_shapes.resize(4);
+        io_sizes.resize(2);
+    }
+
+    for (const std::vector<Eigen::Index> &shape : sum_shapes) {
+        const Eigen::MatrixXd &input_1 = make(shape[0], shape[1]);
+        const Eigen::MatrixXd &input_2 = make(shape[0], shape[1]);
+        const double kElements = static_cast<double>(input_1.size());
+
+        cases.push_back({"sum " + shape_name(shape), "MatSumCustom", shape,
+                         kElements, 3.0 * kElements * sizeof(double),
+                         [&input_1, &input_2] {
+            benchmark_sink = MatSumCustom(input_1, input_2)(0, 0);
+        }});
+        cases.push_back({"sum " + shape_name(shape), "MatSumEigen", shape,
+                         kElements, 3.0 * kElements * sizeof(double),
+                         [&input_1, &input_2] {
+            benchmark_sink = MatSumEigen(input_1, input_2)(0, 0);
+        }});
+        storage.emplace_back();
+        Eigen::MatrixXd &sum_mat = storage.back();
+        cases.push_back({"sum " + shape_name(shape), "MatSumCustomInto",
+                         shape, kElements, 3.0 * kElements * sizeof(double),
+                         [&input_1, &input_2, &sum_mat] {
+            SumContiguous(input_1, input_2, sum_mat);
+            benchmark_sink = sum_mat(0, 0);
+        }});
+    }
+
+    for (const std::vector<Eigen::Index> &shape : product_shapes) {
+        const Eigen::MatrixXd &input_1 = make(shape[0], shape[1]);
+        const Eigen::MatrixXd &input_2 = make(shape[1], shape[2]);
+        const double kFlops = 2.0 * static_cast<double>(shape[0]) *
+                              static_cast<double>(shape[1]) *
+                              static_cast<double>(shape[2]);
+        // compulsory traffic: both operands read and the product written once
+        const double kBytes = static_cast<double>(
+            input_1.size() + input_2.size() + shape[0] * shape[2]) *
+            sizeof(double);
+
+        cases.push_back({"product " + shape_name(shape), "MatProductCustom",
+                         shape, kFlops, kBytes,
+                         [&input_1, &input_2, thread_count] {
+            benchmark_sink =
+                MatProductCustom(input_1, input_2, thread_count)(0, 0);
+        }});
+        cases.push_back({"product " + shape_name(shape), "MatProductEigen",
+                         shape, kFlops, kBytes, [&input_1, &input_2] {
+            benchmark_sink = MatProductEigen(input_1, input_2)(0, 0);
+        }});
+        storage.emplace_back();
+        Eigen::MatrixXd &product_mat = storage.back();
+        cases.push_back({"product " + shape_name(shape),
+                         "MatProductCustomInto", shape, kFlops, kBytes,
+                         [&input_1, &input_2, &product_mat, thread_count] {
+            GemmParallel(input_1, input_2, product_mat, thread_count);
+            benchmark_sink = product_mat(0, 0);
+        }});
+    }
+
+    // the same small products, batched and one at a time
+    for (const std::vector<Eigen::Index> &shape : product_shapes) {
+        if (shape[0] > 8 || shape[1] > 8 || shape[2] > 8) {
+            continue;
+        }
+
+        std::vector<Eigen::MatrixXd> lefts;
+        std::vector<Eigen::MatrixXd> rights;
+        for (Eigen::Index index = 0; index < kBenchmarkBatchCount; index++) {
+            lefts.push_back(Eigen::MatrixXd::Random(shape[0], shape[1]));
+            rights.push_back(Eigen::MatrixXd::Random(shape[1], shape[2]));
+        }
+        auto batch_1 = std::make_shared<MatBatch>(MakeMatBatch(lefts));
+        auto batch_2 = std::make_shared<MatBatch>(MakeMatBatch(rights));
+        auto batch_product = std::make_shared<MatBatch>();
+        auto left_mats = std::make_shared<std::vector<Eigen::MatrixXd>>(
+            std::move(lefts));
+        auto right_mats = std::make_shared<std::vector<Eigen::MatrixXd>>(
+            std::move(rights));
+
+        const std::vector<Eigen::Index> kBatchShape{
+            shape[0], shape[1], shape[2], kBenchmarkBatchCount};
+        const double kCount = static_cast<double>(kBenchmarkBatchCount);
+        const double kFlops = kCount * 2.0 * static_cast<double>(shape[0]) *
+                              static_cast<double>(shape[1]) *
+                              static_cast<double>(shape[2]);
+        const double kBytes = kCount * static_cast<double>(
+            shape[0] * shape[1] + shape[1] * shape[2] + shape[0] * shape[2]) *
+            sizeof(double);
+
+        cases.push_back({"batched " + shape_name(kBatchShape), "BatchedGemm",
+                         kBatchShape, kFlops, kBytes,
+                         [batch_1, batch_2, batch_product] {
+            BatchedGemm(*batch_1, *batch_2, *batch_product);
+            benchmark_sink = batch_product->At(0, 0, 0);
+        }});
+        cases.push_back({"batched " + shape_name(kBatchShape),
+                         "MatProductEigen", kBatchShape, kFlops, kBytes,
+                         [left_mats, right_mats] {
+            for (Eigen::Index index = 0; index < kBenchmarkBatchCount;
+                    index++) {
+                benchmark_sink = MatProductEigen((*left_mats)[index],
+                                                 (*right_mats)[index])(0, 0);
+            }
+        }});
+    }
+
+    // integer-valued counters, like part_one's, exact in int32 and double
+    std::vector<std::vector<Eigen::Index>> integer_shapes{
+        {256, 256, 256}, {1024, 1024, 1024}};
+    if (quick) {
+        integer_shapes.resize(1);
+    }
+    for (const std::vector<Eigen::Index> &shape : integer_shapes) {
+        storage.push_back(Eigen::MatrixXd::Random(shape[0], shape[1]));
+        Eigen::MatrixXd &input_1 = storage.back();
+        storage.push_back(Eigen::MatrixXd::Random(shape[1], shape[2]));
+        Eigen::MatrixXd &input_2 = storage.back();
+        input_1 = (input_1 * 100.0).array().round().matrix();
+        input_2 = (input_2 * 100.0).array().round().matrix();
+
+        auto integer_1 = std::make_shared<IntegerMat>();
+        auto integer_2 = std::make_shared<IntegerMat>();
+        ToIntegerMat(input_1, *integer_1);
+        ToIntegerMat(input_2, *integer_2);
+
+        const double kElements = static_cast<double>(input_1.size());
+        const double kFlops = 2.0 * static_cast<double>(shape[0]) *
+                              static_cast<double>(shape[1]) *
+                              static_cast<double>(shape[2]);
+        const double kBytes = static_cast<double>(
+            input_1.size() + input_2.size() + shape[0] * shape[2]) *
+            sizeof(std::int32_t);
+
+        cases.push_back({"int product " + shape_name(shape),
+                         "MultiplyIntegerMats", shape, kFlops, kBytes,
+                         [integer_1, integer_2] {
+            IntegerMat product;
+            MultiplyIntegerMats(*integer_1, *integer_2, product);
+            benchmark_sink = static_cast<double>(product.GetNarrow()(0, 0));
+        }});
+        cases.push_back({"int product " + shape_name(shape),
+                         "MultiplyIfInteger", shape, kFlops, kBytes,
+                         [&input_1, &input_2] {
+            Eigen::MatrixXd product;
+            MultiplyIfInteger(input_1, input_2, product);
+            benchmark_sink = product(0, 0);
+        }});
+        cases.push_back({"int sum " + shape_name({shape[0], shape[1]}),
+                         "SumIntegerMats", {shape[0], shape[1]}, kElements,
+                         3.0 * kElements * sizeof(std::int32_t),
+                         [integer_1] {
+            IntegerMat sum;
+            SumIntegerMats(*integer_1, *integer_1, sum);
+            benchmark_sink = static_cast<double>(sum.GetNarrow()(0, 0));
+        }});
+    }
+
+    // Gram matrices A * A^T, computed whole and as one mirrored triangle
+    std::vector<std::vector<Eigen::Index>> gram_shapes{
+        {256, 256, 256}, {1024, 512, 1024}};
+    if (quick) {
+        gram_shapes.resize(1);
+    }
+    for (const std::vector<Eigen::Index> &shape : gram_shapes) {
+        storage.push_back(Eigen::MatrixXd::Random(shape[0], shape[1]));
+        Eigen::MatrixXd &input = storage.back();
+        storage.push_back(input.transpose());
+        Eigen::MatrixXd &input_transpose = storage.back();
+
+        const double kFlops = 2.0 * static_cast<double>(shape[0]) *
+                              static_cast<double>(shape[1]) *
+                              static_cast<double>(shape[2]);
+        const double kBytes = static_cast<double>(
+            input.size() + shape[0] * shape[2]) * sizeof(double);
+
+        cases.push_back({"gram " + shape_name(shape), "MatProductCustom",
+                         shape, kFlops, kBytes,
+                         [&input, &input_transpose, thread_count] {
+            benchmark_sink =
+                MatProductCustom(input, input_transpose, thread_count)(0, 0);
+        }});
+        cases.push_back({"gram " + shape_name(shape), "GemmGram", shape,
+                         kFlops, kBytes, [&input, thread_count] {
+            Eigen::MatrixXd product;
+            GemmGram(input, false, product, thread_count);
+            benchmark_sink = product(0, 0);
+        }});
+    }
+
+    auto file_bytes = [](const std::string &path) {
+        struct stat file_stat;
+        if (stat(path.c_str(), &file_stat) != 0) {
+            throw std::runtime_error(path + ": cannot stat scratch file");
+        }
+        return static_cast<double>(file_stat.st_size);
+    };
+
+    for (Eigen::Index size : io_sizes) {
+        const Eigen::MatrixXd &mat = make(size, size);
+        const std::vector<Eigen::Index> shape{size, size};
+        const std::string kTextPath =
+            scratch_dir + "/benchmark_io_" + std::to_string(size) + ".txt";
+        const std::string kBinaryPath =
+            scratch_dir + "/benchmark_io_" + std::to_string(size) + ".bin";
+
+        // the read cases read back what these first writes leave behind
+        WriteMatFile(mat, kTextPath);
+        WriteMatFileBinary(mat, kBinaryPath);
+        scratch_files.push_back(kTextPath);
+        scratch_files.push_back(kBinaryPath);
+        const double kTextBytes = file_bytes(kTextPath);
+        const double kBinaryBytes = file_bytes(kBinaryPath);
+
+        cases.push_back({"write text " + shape_name(shape), "WriteMatFile",
+                         shape, 0.0, kTextBytes, [&mat, kTextPath] {
+            WriteMatFile(mat, kTextPath);
+        }});
+        cases.push_back({"read text " + shape_name(shape), "ReadMatFile",
+                         shape, 0.0, kTextBytes, [kTextPath] {
+            benchmark_sink = ReadMatFile(kTextPath)(0, 0);
+        }});
+        cases.push_back({"write binary " + shape_name(shape),
+                         "WriteMatFileBinary", shape, 0.0, kBinaryBytes,
+                         [&mat, kBinaryPath] {
+            WriteMatFileBinary(mat, kBinaryPath);
+        }});
+        cases.push_back({"read binary " + shape_name(shape), "ReadMatFile",
+                         shape, 0.0, kBinaryBytes, [kBinaryPath] {
+            benchmark_sink = ReadMatFile(kBinaryPath)(0, 0);
+        }});
+
+        // random doubles do not compress, so the compressed format is timed
+        // on a counter like part_one's; its GB/s counts the bytes of the
+        // matrix, not of the file, to compare directly with binary reads
+        const Eigen::MatrixXd &counter = make(size, size);
+        storage.back() = Eigen::MatrixXd::NullaryExpr(
+            size, size, [size](Eigen::Index row, Eigen::Index col) {
+                return 3.0 + 5.0 * static_cast<double>(row + col * size);
+            });
+        const std::string kCompressedPath =
+            scratch_dir + "/benchmark_io_" + std::to_string(size) + ".cmp";
+        WriteMatFileCompressed(counter, kCompressedPath);
+        scratch_files.push_back(kCompressedPath);
+        const double kCounterBytes =
+            static_cast<double>(counter.size()) * sizeof(double);
+
+        cases.push_back({"write compressed " + shape_name(shape),
+                         "WriteMatFileCompressed", shape, 0.0, kCounterBytes,
+                         [&counter, kCompressedPath] {
+            WriteMatFileCompressed(counter, kCompressedPath);
+        }});
+        cases.push_back({"read compressed " + shape_name(shape),
+                         "ReadMatFile", shape, 0.0, kCounterBytes,
+                         [kCompressedPath] {
+            benchmark_sink = ReadMatFile(kCompressedPath)(0, 0);
+        }});
+    }
+} // AddBenchmarkCases
+
+void PrintResults(const std::vector<BenchmarkResult> &results) {
+    std::printf("%-26s %-22s %12s %12s %12s %10s %10s\n", "case", "kernel",
+                "p50 (s)", "p90 (s)", "p99 (s)", "GFLOP/s", "GB/s");
+
+    for (const BenchmarkResult &result : results) {
+        const BenchmarkCase &bench_case = *result.bench_case;
+        std::printf("%-26s %-22s %12.4e %12.4e %12.4e %10.3f %10.3f\n",
+                    bench_case.name.c_str(), bench_case.kernel.c_str(),
+                    result.p50, result.p90, result.p99,
+                    bench_case.flops / result.p50 * 1e-9,
+                    bench_case.bytes / result.p50 * 1e-9);
+    }
+} // PrintResults
+
+void WriteResultsJson(const std::vector<BenchmarkResult> &results,
+                      const std::string &json_path, int samples,
+                      unsigned int thread_count) {
+    std::ofstream json_file(json_path);
+    if (!json_file) {
+        throw std::runtime_error(json_path + ": cannot open for writing");
+    }
+
+    char timestamp[32];
+    const std::time_t kNow = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ",
+                  std::gmtime(&kNow));
+
+    json_file.precision(9);
+    json_file << "{\n"
+              << "  \"timestamp\": \"" << timestamp << "\",\n"
+              << "  \"compiler\": \"" << __VERSION__ << "\",\n"
+              << "  \"threads\": " << ResolveThreadCount(thread_count)
+              << ",\n"
+              << "  \"samples\": " << samples << ",\n"
+              << "  \"results\": [";
+
+    for (std::size_t index = 0; index < results.size(); index++) {
+        const BenchmarkResult &result = results[index];
+        const BenchmarkCase &bench_case = *result.bench_case;
+
+        json_file << (index == 0 ? "\n" : ",\n")
+                  << "    {\"case\": \"" << bench_case.name
+                  << "\", \"kernel\": \"" << bench_case.kernel
+                  << "\", \"shape\": [";
+        for (std::size_t dim = 0; dim < bench_case.shape.size(); dim++) {
+            json_file << (dim == 0 ? "" : ", ") << bench_case.shape[dim];
+        }
+        json_file << "], \"calls_per_sample\": " << result.calls_per_sample
+                  << ", \"seconds\": {\"min\": " << result.min
+                  << ", \"p50\": " << result.p50
+                  << ", \"p90\": " << result.p90
+                  << ", \"p99\": " << result.p99
+                  << ", \"mean\": " << result.mean << "}"
+                  << ", \"gflops\": " << bench_case.flops / result.p50 * 1e-9
+                  << ", \"gbps\": " << bench_case.bytes / result.p50 * 1e-9
+                  << "}";
+    }
+
+    json_file << "\n  ]\n}\n";
+
+    if (!json_file) {
+        throw std::runtime_error(json_path + ": write failed");
+    }
+} // WriteResultsJson
+
+void PrintUsage(const std::string &program_name) {
+    std::cerr << "Usage: " << program_name << " [--samples N] [--threads N] "
+              << "[--json <path>] [--scratch <dir>] [--quick]" << std::endl;
+} // PrintUsage
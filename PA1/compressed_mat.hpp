@@ -0,0 +1,566 @@
+#ifndef COMPRESSED_MAT_H_
+#define COMPRESSED_MAT_H_
+
+//!  Chunked, losslessly compressed matrix files.
+/*!
+  \file compressed_mat.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  A compressed file is a 64 byte header, a table with one entry per chunk
+  and then the chunk payloads. A chunk is a run of up to chunk_elements
+  column-major elements and is encoded on its own, so chunks can be read
+  and decoded in parallel with one pread each.
+
+  Every chunk is stored with whichever codec makes it smallest:
+
+    - kRaw: the doubles as they are.
+    - kFloatDelta: each element's bit pattern minus the previous one's.
+    - kIntegerDelta: for chunks of whole numbers, each value minus the
+      previous one as a zigzag-coded integer.
+
+  Both delta codecs then shuffle the bytes so that byte 0 of every element
+  comes first, then byte 1 and so on, and run-length encode the result.
+  Counters, constant columns and repeated rows turn into long runs of equal
+  bytes, which the run-length stage stores in two bytes per run.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./thread_pool.hpp"
+
+//! Magic bytes at the start of every compressed matrix file.
+const char kCompressedMatMagic[8] = {'P', 'A', '1', 'C', 'M', 'P', 'R', '\0'};
+
+//! The compressed format version written by this header.
+const std::uint32_t kCompressedMatVersion = 1;
+
+//! Elements per chunk when none is given; 512 KiB of raw doubles.
+const std::uint64_t kDefaultCompressedChunkElements = 1 << 16;
+
+//! Longest literal run the run-length coder emits.
+const std::size_t kRleMaxLiteral = 128;
+//! Shortest repeat the run-length coder emits as a run.
+const std::size_t kRleMinRun = 3;
+//! Longest repeat one run-length control byte describes.
+const std::size_t kRleMaxRun = kRleMinRun + 127;
+
+//! How a chunk's payload is encoded.
+enum class MatCodec : std::uint32_t {
+    //! Raw little endian doubles.
+    kRaw = 0,
+    //! Bit-pattern deltas, byte-shuffled and run-length encoded.
+    kFloatDelta = 1,
+    //! Zigzag integer deltas, byte-shuffled and run-length encoded.
+    kIntegerDelta = 2,
+};
+
+//! On-disk header of a compressed matrix file.
+struct CompressedMatHeader {
+    //! Always kCompressedMatMagic.
+    char magic[8];
+    //! Format version, kCompressedMatVersion for files written here.
+    std::uint32_t version;
+    //! Byte offset of the chunk table.
+    std::uint32_t table_offset;
+    //! Number of rows of the matrix.
+    std::uint64_t rows;
+    //! Number of columns of the matrix.
+    std::uint64_t cols;
+    //! Elements in every chunk but the last.
+    std::uint64_t chunk_elements;
+    //! Number of chunks.
+    std::uint64_t chunk_count;
+    //! Pads the header out to 64 bytes.
+    std::uint8_t reserved[16];
+};
+
+static_assert(sizeof(CompressedMatHeader) == 64,
+              "CompressedMatHeader must match the on-disk header size");
+
+//! On-disk chunk table entry.
+struct CompressedChunkEntry {
+    //! Byte offset of the payload from the start of the file.
+    std::uint64_t offset;
+    //! Bytes in the payload.
+    std::uint32_t size;
+    //! The MatCodec of the payload.
+    std::uint32_t codec;
+};
+
+static_assert(sizeof(CompressedChunkEntry) == 16,
+              "CompressedChunkEntry must match the on-disk entry size");
+
+//! One encoded chunk, held in memory.
+struct CompressedChunk {
+    //! How payload is encoded.
+    MatCodec codec = MatCodec::kRaw;
+    //! The encoded bytes.
+    std::vector<std::uint8_t> payload;
+};
+
+
+//! Checks whether the file at read_file_path starts with the compressed
+//! magic.
+/*!
+  \param read_file_path the path of the file
+  \return Whether the file is a compressed matrix file
+ */
+bool IsCompressedMatFile(const std::string &read_file_path) {
+    std::ifstream read_file(read_file_path, std::ios::binary);
+    char magic[sizeof(kCompressedMatMagic)] = {};
+    read_file.read(magic, sizeof(magic));
+
+    return read_file.gcount() == sizeof(magic) &&
+           std::memcmp(magic, kCompressedMatMagic, sizeof(magic)) == 0;
+} // IsCompressedMatFile
+
+//! Appends the run-length encoding of size bytes to out.
+/*!
+  A control byte c below 128 is followed by c + 1 literal bytes; c of 128 or
+  more is followed by one byte repeated c - 128 + kRleMinRun times.
+  \param in the bytes to encode
+  \param size the number of bytes
+  \param out the destination
+ */
+void EncodeRle(const std::uint8_t *in, std::size_t size,
+               std::vector<std::uint8_t> &out) {
+    const auto run_at = [&](std::size_t start) {
+        std::size_t run = 1;
+        while (start + run < size && run < kRleMaxRun &&
+               in[start + run] == in[start]) {
+            run++;
+        }
+        return run;
+    };
+
+    std::size_t index = 0;
+    while (index < size) {
+        const std::size_t run = run_at(index);
+        if (run >= kRleMinRun) {
+            out.push_back(static_cast<std::uint8_t>(128 + run - kRleMinRun));
+            out.push_back(in[index]);
+            index += run;
+            continue;
+        }
+
+        // collect literals up to the next run worth encoding
+        std::size_t end = index + run;
+        while (end < size && end - index < kRleMaxLiteral &&
+               run_at(end) < kRleMinRun) {
+            end++;
+        }
+        end = std::min(end, index + kRleMaxLiteral);
+
+        out.push_back(static_cast<std::uint8_t>(end - index - 1));
+        out.insert(out.end(), in + index, in + end);
+        index = end;
+    }
+} // EncodeRle
+
+//! Decodes run-length encoded bytes that must expand to exactly size bytes.
+/*!
+  \param in the encoded bytes
+  \param in_size the number of encoded bytes
+  \param out the destination
+  \param size the decoded size
+  \return Whether the input was well formed and of the right size
+ */
+bool DecodeRle(const std::uint8_t *in, std::size_t in_size,
+               std::uint8_t *out, std::size_t size) {
+    std::size_t read = 0;
+    std::size_t written = 0;
+
+    while (read < in_size) {
+        const std::uint8_t control = in[read++];
+
+        if (control < 128) {
+            const std::size_t length = control + 1u;
+            if (in_size - read < length || size - written < length) {
+                return false;
+            }
+            std::memcpy(out + written, in + read, length);
+            read += length;
+            written += length;
+        } else {
+            const std::size_t length = control - 128u + kRleMinRun;
+            if (read == in_size || size - written < length) {
+                return false;
+            }
+            std::memset(out + written, in[read++], length);
+            written += length;
+        }
+    }
+
+    return written == size;
+} // DecodeRle
+
+//! Splits count 8-byte words into 8 planes: byte 0 of every word, then
+//! byte 1 and so on.
+void ShuffleBytes(const std::uint64_t *words, std::size_t count,
+                  std::uint8_t *planes) {
+    for (std::size_t word = 0; word < count; word++) {
+        for (std::size_t byte = 0; byte < 8; byte++) {
+            planes[byte * count + word] =
+                static_cast<std::uint8_t>(words[word] >> (8 * byte));
+        }
+    }
+} // ShuffleBytes
+
+//! Reassembles word index of count from the planes ShuffleBytes wrote.
+std::uint64_t GatherShuffledWord(const std::uint8_t *planes, std::size_t count,
+                                 std::size_t index) {
+    std::uint64_t word = 0;
+    for (std::size_t byte = 0; byte < 8; byte++) {
+        word |= static_cast<std::uint64_t>(planes[byte * count + index])
+                << (8 * byte);
+    }
+
+    return word;
+} // GatherShuffledWord
+
+//! Checks whether every element is a whole number the integer codec can
+//! store exactly; -0.0 is not, since it would come back as 0.0.
+bool IsIntegerChunk(const double *elements, std::size_t count) {
+    const double kLimit = std::ldexp(1.0, 53);
+
+    for (std::size_t index = 0; index < count; index++) {
+        const double value = elements[index];
+        if (!(std::abs(value) <= kLimit) || std::trunc(value) != value ||
+                (value == 0.0 && std::signbit(value))) {
+            return false;
+        }
+    }
+
+    return true;
+} // IsIntegerChunk
+
+//! Encodes a chunk with every codec that applies and keeps the smallest.
+/*!
+  \param elements the elements of the chunk
+  \param count the number of elements
+  \return The encoded chunk
+ */
+CompressedChunk CompressMatChunk(const double *elements, std::size_t count) {
+    CompressedChunk best;
+    best.payload.resize(count * sizeof(double));
+    std::memcpy(best.payload.data(), elements, best.payload.size());
+
+    std::vector<std::uint64_t> words(count);
+    std::vector<std::uint8_t> planes(count * sizeof(double));
+    const auto try_codec = [&](MatCodec codec) {
+        CompressedChunk candidate;
+        candidate.codec = codec;
+        ShuffleBytes(words.data(), count, planes.data());
+        EncodeRle(planes.data(), planes.size(), candidate.payload);
+
+        if (candidate.payload.size() < best.payload.size()) {
+            best = std::move(candidate);
+        }
+    };
+
+    std::uint64_t previous = 0;
+    for (std::size_t index = 0; index < count; index++) {
+        std::uint64_t bits;
+        std::memcpy(&bits, elements + index, sizeof(bits));
+        words[index] = bits - previous;
+        previous = bits;
+    }
+    try_codec(MatCodec::kFloatDelta);
+
+    if (IsIntegerChunk(elements, count)) {
+        std::int64_t previous_value = 0;
+        for (std::size_t index = 0; index < count; index++) {
+            const std::int64_t value =
+                static_cast<std::int64_t>(elements[index]);
+            const std::int64_t delta = value - previous_value;
+            words[index] = (static_cast<std::uint64_t>(delta) << 1) ^
+                           static_cast<std::uint64_t>(delta >> 63);
+            previous_value = value;
+        }
+        try_codec(MatCodec::kIntegerDelta);
+    }
+
+    return best;
+} // CompressMatChunk
+
+//! Returns the most elements a chunk table entry's payload can decode to.
+/*!
+  Raw payloads hold exactly their size in doubles; run-length payloads
+  expand at most two bytes into kRleMaxRun. Checking each chunk against
+  this before allocating keeps a corrupt header from demanding more memory
+  than the file could ever fill.
+  \param entry the chunk table entry
+  \return The element bound, 0 for unknown codecs
+ */
+std::uint64_t MaxChunkElements(const CompressedChunkEntry &entry) {
+    switch (static_cast<MatCodec>(entry.codec)) {
+        case MatCodec::kRaw:
+            return entry.size / sizeof(double);
+        case MatCodec::kFloatDelta:
+        case MatCodec::kIntegerDelta:
+            return std::uint64_t(entry.size / 2) * kRleMaxRun /
+                   sizeof(double);
+    }
+
+    return 0;
+} // MaxChunkElements
+
+//! Decodes one chunk.
+/*!
+  \param codec the chunk's codec
+  \param payload the encoded bytes
+  \param size the number of encoded bytes
+  \param elements the destination for count elements
+  \param count the number of elements in the chunk
+  \return Whether the payload was well formed
+ */
+bool DecompressMatChunk(MatCodec codec, const std::uint8_t *payload,
+                        std::size_t size, double *elements,
+                        std::size_t count) {
+    if (codec == MatCodec::kRaw) {
+        if (size != count * sizeof(double)) {
+            return false;
+        }
+        std::memcpy(elements, payload, size);
+        return true;
+    }
+    if (codec != MatCodec::kFloatDelta && codec != MatCodec::kIntegerDelta) {
+        return false;
+    }
+
+    // reused across calls, so decoding a chunk allocates nothing
+    thread_local std::vector<std::uint8_t> planes;
+    planes.resize(count * sizeof(double));
+    if (!DecodeRle(payload, size, planes.data(), planes.size())) {
+        return false;
+    }
+
+    // unshuffle and undo the deltas in one pass
+    if (codec == MatCodec::kFloatDelta) {
+        std::uint64_t bits = 0;
+        for (std::size_t index = 0; index < count; index++) {
+            bits += GatherShuffledWord(planes.data(), count, index);
+            std::memcpy(elements + index, &bits, sizeof(bits));
+        }
+    } else {
+        // unsigned, so a corrupt chunk wraps instead of overflowing
+        std::uint64_t value = 0;
+        for (std::size_t index = 0; index < count; index++) {
+            const std::uint64_t zigzag =
+                GatherShuffledWord(planes.data(), count, index);
+            value += (zigzag >> 1) ^ (0 - (zigzag & 1));
+            elements[index] =
+                static_cast<double>(static_cast<std::int64_t>(value));
+        }
+    }
+
+    return true;
+} // DecompressMatChunk
+
+//! Writes a matrix in the compressed format, encoding chunks in parallel.
+/*!
+  \param mat the matrix to write
+  \param write_file_path the path of the output file
+  \param thread_count threads encoding chunks, 0 for one per hardware thread
+  \param chunk_elements the elements per chunk
+ */
+void WriteMatFileCompressed(
+        const Eigen::MatrixXd &mat, const std::string &write_file_path,
+        unsigned int thread_count = 0,
+        std::uint64_t chunk_elements = kDefaultCompressedChunkElements) {
+    if (chunk_elements == 0 ||
+            chunk_elements * sizeof(double) > UINT32_MAX / 2) {
+        throw std::runtime_error("chunk size out of range");
+    }
+
+    const std::uint64_t kElements = static_cast<std::uint64_t>(mat.size());
+    const std::uint64_t kChunkCount =
+        (kElements + chunk_elements - 1) / chunk_elements;
+    std::vector<CompressedChunk> chunks(kChunkCount);
+
+    {
+        ThreadPool pool(thread_count);
+        std::vector<std::future<void>> tasks;
+        for (std::uint64_t chunk = 0; chunk < kChunkCount; chunk++) {
+            tasks.push_back(pool.Submit([&, chunk] {
+                const std::uint64_t first = chunk * chunk_elements;
+                chunks[chunk] = CompressMatChunk(
+                    mat.data() + first,
+                    std::min(chunk_elements, kElements - first));
+            }));
+        }
+        for (std::future<void> &task : tasks) {
+            task.get();
+        }
+    }
+
+    CompressedMatHeader header = {};
+    std::memcpy(header.magic, kCompressedMatMagic, sizeof(header.magic));
+    header.version = kCompressedMatVersion;
+    header.table_offset = sizeof(CompressedMatHeader);
+    header.rows = static_cast<std::uint64_t>(mat.rows());
+    header.cols = static_cast<std::uint64_t>(mat.cols());
+    header.chunk_elements = chunk_elements;
+    header.chunk_count = kChunkCount;
+
+    std::vector<CompressedChunkEntry> table(kChunkCount);
+    std::uint64_t offset =
+        header.table_offset + kChunkCount * sizeof(CompressedChunkEntry);
+    for (std::uint64_t chunk = 0; chunk < kChunkCount; chunk++) {
+        table[chunk].offset = offset;
+        table[chunk].size =
+            static_cast<std::uint32_t>(chunks[chunk].payload.size());
+        table[chunk].codec = static_cast<std::uint32_t>(chunks[chunk].codec);
+        offset += table[chunk].size;
+    }
+
+    std::ofstream mat_file(write_file_path, std::ios::binary);
+    if (!mat_file) {
+        throw std::runtime_error(write_file_path + ": cannot open for writing");
+    }
+
+    mat_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    mat_file.write(reinterpret_cast<const char *>(table.data()),
+                   static_cast<std::streamsize>(
+                       table.size() * sizeof(CompressedChunkEntry)));
+    for (const CompressedChunk &chunk : chunks) {
+        mat_file.write(reinterpret_cast<const char *>(chunk.payload.data()),
+                       static_cast<std::streamsize>(chunk.payload.size()));
+    }
+
+    mat_file.close();
+    if (!mat_file) {
+        throw std::runtime_error(write_file_path + ": write failed");
+    }
+} // WriteMatFileCompressed
+
+//! Reads a compressed matrix file, reading and decoding chunks in parallel.
+/*!
+  \param read_file_path the path of the compressed file
+  \param thread_count threads decoding chunks, 0 for one per hardware thread
+  \return The matrix stored in the file
+ */
+Eigen::MatrixXd ReadMatFileCompressed(const std::string &read_file_path,
+                                      unsigned int thread_count = 0) {
+    const int descriptor = open(read_file_path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error(read_file_path + ": cannot open file");
+    }
+
+    const auto read_exact = [&](void *out, std::size_t size,
+                                std::uint64_t offset) {
+        return pread(descriptor, out, size, static_cast<off_t>(offset)) ==
+               static_cast<ssize_t>(size);
+    };
+
+    try {
+        CompressedMatHeader header;
+        struct stat file_stat;
+        if (fstat(descriptor, &file_stat) != 0 ||
+                !read_exact(&header, sizeof(header), 0) ||
+                std::memcmp(header.magic, kCompressedMatMagic,
+                            sizeof(header.magic)) != 0) {
+            throw std::runtime_error(read_file_path +
+                                     ": not a compressed matrix file");
+        }
+
+        const std::uint64_t kFileSize =
+            static_cast<std::uint64_t>(file_stat.st_size);
+        const std::uint64_t kElements = header.rows * header.cols;
+        if (header.version != kCompressedMatVersion ||
+                header.chunk_elements == 0 ||
+                (header.cols != 0 &&
+                 kElements / header.cols != header.rows) ||
+                header.chunk_count != (kElements + header.chunk_elements - 1) /
+                                          header.chunk_elements ||
+                header.chunk_count > kFileSize / sizeof(CompressedChunkEntry)) {
+            throw std::runtime_error(read_file_path +
+                                     ": malformed compressed header");
+        }
+
+        std::vector<CompressedChunkEntry> table(header.chunk_count);
+        if (!read_exact(table.data(),
+                        table.size() * sizeof(CompressedChunkEntry),
+                        header.table_offset)) {
+            throw std::runtime_error(read_file_path +
+                                     ": compressed file is truncated");
+        }
+        for (std::uint64_t chunk = 0; chunk < header.chunk_count; chunk++) {
+            const CompressedChunkEntry &entry = table[chunk];
+            if (entry.offset > kFileSize ||
+                    entry.size > kFileSize - entry.offset) {
+                throw std::runtime_error(read_file_path +
+                                         ": compressed file is truncated");
+            }
+            if (std::min(header.chunk_elements,
+                         kElements - chunk * header.chunk_elements) >
+                    MaxChunkElements(entry)) {
+                throw std::runtime_error(
+                    read_file_path + ": chunk " + std::to_string(chunk) +
+                    " is too small for its elements");
+            }
+        }
+
+        Eigen::MatrixXd mat(static_cast<Eigen::Index>(header.rows),
+                            static_cast<Eigen::Index>(header.cols));
+        {
+            ThreadPool pool(thread_count);
+            std::vector<std::future<void>> tasks;
+            for (std::uint64_t chunk = 0; chunk < header.chunk_count;
+                    chunk++) {
+                tasks.push_back(pool.Submit([&, chunk] {
+                    const CompressedChunkEntry &entry = table[chunk];
+                    const std::uint64_t first = chunk * header.chunk_elements;
+                    thread_local std::vector<std::uint8_t> payload;
+                    payload.resize(entry.size);
+
+                    if (!read_exact(payload.data(), payload.size(),
+                                    entry.offset) ||
+                            !DecompressMatChunk(
+                                static_cast<MatCodec>(entry.codec),
+                                payload.data(), payload.size(),
+                                mat.data() + first,
+                                std::min(header.chunk_elements,
+                                         kElements - first))) {
+                        throw std::runtime_error(
+                            read_file_path + ": chunk " +
+                            std::to_string(chunk) + " is corrupt");
+                    }
+                }));
+            }
+
+            // every task finishes before the pool is destroyed, so none
+            // outlives mat even when one of them throws
+            for (std::future<void> &task : tasks) {
+                task.wait();
+            }
+            for (std::future<void> &task : tasks) {
+                task.get();
+            }
+        }
+
+        close(descriptor);
+        return mat;
+    } catch (...) {
+        close(descriptor);
+        throw;
+    }
+} // ReadMatFileCompressed
+
+#endif
@@ -0,0 +1,412 @@
+#ifndef GEMM_H_
+#define GEMM_H_
+
+//!  A packed, cache-blocked matrix product kernel.
+/*!
+  \file gemm.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  The kernel follows the usual GotoBLAS layout: the k dimension is cut into
+  kc-deep slabs sized for L1, the rows of A into mc-tall blocks sized for L2
+  and the columns of B into nc-wide panels sized for L3. Each block of A and
+  panel of B is copied into a contiguous, zero-padded buffer so that the
+  register-tiled micro-kernel only ever streams unit-stride memory.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+//! Rows of C computed by one micro-kernel call.
+const Eigen::Index kGemmMr = 8;
+//! Columns of C computed by one micro-kernel call.
+const Eigen::Index kGemmNr = 4;
+
+//! Doubles per vector register the micro-kernel is written for.
+#ifdef __AVX__
+const Eigen::Index kGemmVecLen = 4;
+#else
+const Eigen::Index kGemmVecLen = 2;
+#endif
+
+//! Cache block sizes used by GemmBlocked.
+struct GemmBlocking {
+    //! Rows of A packed at once (L2 resident), a multiple of kGemmMr.
+    Eigen::Index mc;
+    //! Depth of each packed slab of A and B (L1 resident).
+    Eigen::Index kc;
+    //! Columns of B packed at once (L3 resident), a multiple of kGemmNr.
+    Eigen::Index nc;
+};
+
+//! Block sizes that suit most current x86-64 cores.
+const GemmBlocking kDefaultGemmBlocking = {96, 256, 4096};
+
+
+//! Read access to a strided matrix held in memory.
+/*!
+  The packing routines read operands only through operator(), so anything
+  with the same call signature (for example a lazily evaluated sum) can be
+  fed to the kernel without first being stored.
+ */
+struct StridedOperand {
+    //! Pointer to element (0, 0).
+    const double *data;
+    //! Distance between vertically adjacent elements.
+    Eigen::Index row_stride;
+    //! Distance between horizontally adjacent elements.
+    Eigen::Index col_stride;
+
+    //! Returns element (row, col).
+    double operator()(Eigen::Index row, Eigen::Index col) const {
+        return data[row * row_stride + col * col_stride];
+    } // operator()
+};
+
+//! Describes column-major storage with leading dimension ld.
+StridedOperand ColMajorOperand(const double *data, Eigen::Index ld) {
+    return StridedOperand{data, 1, ld};
+} // ColMajorOperand
+
+//! Describes the transpose of column-major storage with leading dimension
+//! ld, read in place instead of copied.
+StridedOperand TransposedOperand(const double *data, Eigen::Index ld) {
+    return StridedOperand{data, ld, 1};
+} // TransposedOperand
+
+//! Describes a dense matrix's own storage, in either storage order.
+template <typename Derived>
+StridedOperand StorageOperand(const Eigen::PlainObjectBase<Derived> &mat) {
+    return Derived::IsRowMajor
+        ? StridedOperand{mat.data(), mat.outerStride(), 1}
+        : StridedOperand{mat.data(), 1, mat.outerStride()};
+} // StorageOperand
+
+
+//! Shifts another operand so that (0, 0) reads (row_0, col_0).
+template <typename Operand>
+struct OffsetOperand {
+    //! The shifted operand.
+    Operand operand;
+    //! Row of the underlying operand read as row 0.
+    Eigen::Index row_0;
+    //! Column of the underlying operand read as column 0.
+    Eigen::Index col_0;
+
+    //! Returns element (row, col) of the shifted view.
+    double operator()(Eigen::Index row, Eigen::Index col) const {
+        return operand(row_0 + row, col_0 + col);
+    } // operator()
+};
+
+//! Makes an OffsetOperand, deducing the operand type.
+template <typename Operand>
+OffsetOperand<Operand> OffsetBy(const Operand &operand, Eigen::Index row_0,
+                                Eigen::Index col_0) {
+    return OffsetOperand<Operand>{operand, row_0, col_0};
+} // OffsetBy
+
+//! Copies an mc x kc block of A into kGemmMr-row slivers.
+/*!
+  Each sliver is stored depth-first so the micro-kernel reads kGemmMr
+  consecutive values per step. Rows past mc are zero filled.
+  \param mc the number of rows to pack
+  \param kc the number of columns to pack
+  \param a the operand to read from
+  \param row_0 the operand row of the block's first row
+  \param col_0 the operand column of the block's first column
+  \param packed the destination buffer
+  \param sliver_rows rows per sliver, for kernels with another tile height
+ */
+template <typename Operand, typename Packed>
+void PackBlockA(Eigen::Index mc, Eigen::Index kc, const Operand &a,
+                Eigen::Index row_0, Eigen::Index col_0, Packed *packed,
+                Eigen::Index sliver_rows = kGemmMr) {
+    for (Eigen::Index row = 0; row < mc; row += sliver_rows) {
+        const Eigen::Index rows = std::min(sliver_rows, mc - row);
+
+        for (Eigen::Index depth = 0; depth < kc; depth++) {
+            Eigen::Index index = 0;
+
+            for (; index < rows; index++) {
+                packed[index] = a(row_0 + row + index, col_0 + depth);
+            }
+            for (; index < sliver_rows; index++) {
+                packed[index] = 0;
+            }
+
+            packed += sliver_rows;
+        }
+    }
+} // PackBlockA
+
+//! Copies a kc x nc panel of B into kGemmNr-column slivers.
+/*!
+  \param kc the number of rows to pack
+  \param nc the number of columns to pack
+  \param b the operand to read from
+  \param row_0 the operand row of the panel's first row
+  \param col_0 the operand column of the panel's first column
+  \param packed the destination buffer
+  \param sliver_cols columns per sliver, for kernels with another tile width
+ */
+template <typename Operand, typename Packed>
+void PackPanelB(Eigen::Index kc, Eigen::Index nc, const Operand &b,
+                Eigen::Index row_0, Eigen::Index col_0, Packed *packed,
+                Eigen::Index sliver_cols = kGemmNr) {
+    for (Eigen::Index col = 0; col < nc; col += sliver_cols) {
+        const Eigen::Index cols = std::min(sliver_cols, nc - col);
+
+        for (Eigen::Index depth = 0; depth < kc; depth++) {
+            Eigen::Index index = 0;
+
+            for (; index < cols; index++) {
+                packed[index] = b(row_0 + depth, col_0 + col + index);
+            }
+            for (; index < sliver_cols; index++) {
+                packed[index] = 0;
+            }
+
+            packed += sliver_cols;
+        }
+    }
+} // PackPanelB
+
+//! Accumulates a kGemmMr x kGemmNr tile of C from packed slivers.
+/*!
+  The accumulator is a fixed-size array of vectors, which the compiler keeps
+  in registers. Only the rows x cols corner is written back so edge tiles
+  can reuse the same code.
+  \param kc the shared depth of the slivers
+  \param a_sliver packed sliver of A
+  \param b_sliver packed sliver of B
+  \param c pointer to the top-left element of the tile in C
+  \param ldc the leading dimension of C
+  \param rows the number of valid rows in the tile
+  \param cols the number of valid columns in the tile
+ */
+void GemmMicroKernel(Eigen::Index kc, const double *a_sliver,
+                     const double *b_sliver, double *c, Eigen::Index ldc,
+                     Eigen::Index rows, Eigen::Index cols) {
+    // GCC vector extensions keep the tile in registers at -O2 without
+    // writing the kernel against one instruction set's intrinsics.
+    typedef double GemmVec
+        __attribute__((vector_size(kGemmVecLen * sizeof(double))));
+    const Eigen::Index kVecsPerCol = kGemmMr / kGemmVecLen;
+
+    GemmVec accumulator[kGemmNr][kVecsPerCol] = {};
+
+    for (Eigen::Index depth = 0; depth < kc; depth++) {
+        GemmVec a_vecs[kVecsPerCol];
+#pragma GCC unroll 8
+        for (Eigen::Index vec = 0; vec < kVecsPerCol; vec++) {
+            __builtin_memcpy(&a_vecs[vec], a_sliver + kGemmVecLen * vec,
+                             sizeof(GemmVec));
+        }
+
+#pragma GCC unroll 8
+        for (Eigen::Index col = 0; col < kGemmNr; col++) {
+            const double b_value = b_sliver[col];
+
+#pragma GCC unroll 8
+            for (Eigen::Index vec = 0; vec < kVecsPerCol; vec++) {
+                accumulator[col][vec] += a_vecs[vec] * b_value;
+            }
+        }
+
+        a_sliver += kGemmMr;
+        b_sliver += kGemmNr;
+    }
+
+    for (Eigen::Index col = 0; col < cols; col++) {
+        for (Eigen::Index row = 0; row < rows; row++) {
+            c[row + col * ldc] += accumulator[col][row / kGemmVecLen]
+                                                     [row % kGemmVecLen];
+        }
+    }
+} // GemmMicroKernel
+
+//! Block mask for GemmBlockedMasked that keeps every block.
+struct GemmAllBlocks {
+    //! Returns true: no block of a general product can be skipped.
+    bool operator()(Eigen::Index, Eigen::Index, Eigen::Index, Eigen::Index,
+                    Eigen::Index, Eigen::Index) const {
+        return true;
+    } // operator()
+};
+
+//! Computes C += A * B, skipping the blocks a mask rules out.
+/*!
+  Before packing a panel of B or a block of A, and before each micro-kernel
+  call, needed(pc, kc, row, rows, col, cols) is asked whether depth slab
+  [pc, pc + kc) contributes anything wanted to C's block of rows x cols at
+  (row, col). Structured products use it to skip a triangle's zero half or
+  a symmetric result's upper half; a general product keeps everything.
+  Skipped slabs never change the grouping of the rest, so every element
+  that is computed comes out exactly as in the unmasked product.
+  \param m the number of rows of A and C
+  \param n the number of columns of B and C
+  \param k the number of columns of A and rows of B
+  \param a the left operand
+  \param b the right operand
+  \param c pointer to column-major C
+  \param ldc the leading dimension of C
+  \param blocking the cache block sizes to use
+  \param needed the block mask
+ */
+template <typename OperandA, typename OperandB, typename BlockMask>
+void GemmBlockedMasked(Eigen::Index m, Eigen::Index n, Eigen::Index k,
+                       const OperandA &a, const OperandB &b,
+                       double *c, Eigen::Index ldc,
+                       const GemmBlocking &blocking, BlockMask needed) {
+    assert(blocking.mc > 0 && blocking.mc % kGemmMr == 0);
+    assert(blocking.nc > 0 && blocking.nc % kGemmNr == 0);
+    assert(blocking.kc > 0);
+
+    if (m == 0 || n == 0 || k == 0) {
+        return;
+    }
+
+    // never allocate more than the operands can fill
+    const Eigen::Index mc_max = std::min(blocking.mc,
+                                         (m + kGemmMr - 1) / kGemmMr * kGemmMr);
+    const Eigen::Index nc_max = std::min(blocking.nc,
+                                         (n + kGemmNr - 1) / kGemmNr * kGemmNr);
+    const Eigen::Index kc_max = std::min(blocking.kc, k);
+
+    // kept per thread, so repeated calls skip the allocation and page faults
+    thread_local std::vector<double> packed_a;
+    thread_local std::vector<double> packed_b;
+    if (packed_a.size() < static_cast<std::size_t>(mc_max * kc_max)) {
+        packed_a.resize(mc_max * kc_max);
+    }
+    if (packed_b.size() < static_cast<std::size_t>(kc_max * nc_max)) {
+        packed_b.resize(kc_max * nc_max);
+    }
+
+    for (Eigen::Index jc = 0; jc < n; jc += blocking.nc) {
+        const Eigen::Index nc = std::min(blocking.nc, n - jc);
+
+        for (Eigen::Index pc = 0; pc < k; pc += blocking.kc) {
+            const Eigen::Index kc = std::min(blocking.kc, k - pc);
+            if (!needed(pc, kc, 0, m, jc, nc)) {
+                continue;
+            }
+            PackPanelB(kc, nc, b, pc, jc, packed_b.data());
+
+            for (Eigen::Index ic = 0; ic < m; ic += blocking.mc) {
+                const Eigen::Index mc = std::min(blocking.mc, m - ic);
+                if (!needed(pc, kc, ic, mc, jc, nc)) {
+                    continue;
+                }
+                PackBlockA(mc, kc, a, ic, pc, packed_a.data());
+
+                for (Eigen::Index jr = 0; jr < nc; jr += kGemmNr) {
+                    const Eigen::Index nr = std::min(kGemmNr, nc - jr);
+
+                    for (Eigen::Index ir = 0; ir < mc; ir += kGemmMr) {
+                        const Eigen::Index mr = std::min(kGemmMr, mc - ir);
+                        if (!needed(pc, kc, ic + ir, mr, jc + jr, nr)) {
+                            continue;
+                        }
+
+                        GemmMicroKernel(kc, packed_a.data() + ir * kc,
+                                        packed_b.data() + jr * kc,
+                                        c + (ic + ir) + (jc + jr) * ldc, ldc,
+                                        mr, nr);
+                    }
+                }
+            }
+        }
+    }
+} // GemmBlockedMasked
+
+//! Computes C += A * B for any operands PackBlockA and PackPanelB can read.
+/*!
+  \param m the number of rows of A and C
+  \param n the number of columns of B and C
+  \param k the number of columns of A and rows of B
+  \param a the left operand
+  \param b the right operand
+  \param c pointer to column-major C
+  \param ldc the leading dimension of C
+  \param blocking the cache block sizes to use
+ */
+template <typename OperandA, typename OperandB>
+void GemmBlockedOperands(Eigen::Index m, Eigen::Index n, Eigen::Index k,
+                         const OperandA &a, const OperandB &b,
+                         double *c, Eigen::Index ldc,
+                         const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    GemmBlockedMasked(m, n, k, a, b, c, ldc, blocking, GemmAllBlocks());
+} // GemmBlockedOperands
+
+//! Computes C += A * B on raw column-major storage.
+/*!
+  \param m the number of rows of A and C
+  \param n the number of columns of B and C
+  \param k the number of columns of A and rows of B
+  \param a pointer to A
+  \param lda the leading dimension of A
+  \param b pointer to B
+  \param ldb the leading dimension of B
+  \param c pointer to C
+  \param ldc the leading dimension of C
+  \param blocking the cache block sizes to use
+ */
+void GemmBlocked(Eigen::Index m, Eigen::Index n, Eigen::Index k,
+                 const double *a, Eigen::Index lda,
+                 const double *b, Eigen::Index ldb,
+                 double *c, Eigen::Index ldc,
+                 const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    GemmBlockedOperands(m, n, k, ColMajorOperand(a, lda),
+                        ColMajorOperand(b, ldb), c, ldc, blocking);
+} // GemmBlocked
+
+//! Computes product = input_1 * input_2 with the blocked kernel.
+/*!
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit
+  \param blocking the cache block sizes to use
+ */
+void GemmBlocked(const Eigen::MatrixXd &input_1, const Eigen::MatrixXd &input_2,
+                 Eigen::MatrixXd &product,
+                 const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    assert(input_1.cols() == input_2.rows());
+
+    product.setZero(input_1.rows(), input_2.cols());
+    GemmBlocked(input_1.rows(), input_2.cols(), input_1.cols(),
+                input_1.data(), input_1.outerStride(),
+                input_2.data(), input_2.outerStride(),
+                product.data(), product.outerStride(), blocking);
+} // GemmBlocked
+
+//! Computes product = input_1 * input_2 with operands in any storage order.
+/*!
+  Operands are read in place through their strides: packing copies every
+  block into the kernel's layout anyway, so a row-major operand costs no
+  transpose beforehand.
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit
+  \param blocking the cache block sizes to use
+ */
+template <typename Derived1, typename Derived2>
+void GemmBlocked(const Eigen::PlainObjectBase<Derived1> &input_1,
+                 const Eigen::PlainObjectBase<Derived2> &input_2,
+                 Eigen::MatrixXd &product,
+                 const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    assert(input_1.cols() == input_2.rows());
+
+    product.setZero(input_1.rows(), input_2.cols());
+    GemmBlockedOperands(input_1.rows(), input_2.cols(), input_1.cols(),
+                        StorageOperand(input_1), StorageOperand(input_2),
+                        product.data(), product.outerStride(), blocking);
+} // GemmBlocked
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef GEMM_BACKEND_H_
+#define GEMM_BACKEND_H_
+
+//!  Interchangeable matrix product implementations, chosen by name.
+/*!
+  \file gemm_backend.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Every way this project can compute C = A * B is a GemmBackend: a name and
+  a function taking the operands, the output and a GemmConfig. The built-in
+  backends are a naive loop, the packed blocked kernel, its threaded tiling,
+  Eigen's product, and the exact integer kernel, which falls back to the
+  blocked kernel unless both operands hold only integers. Drivers and the
+  tuner in gemm_tuner.hpp only go through the registry, so a new kernel
+  becomes selectable, and tunable, by registering it once at startup.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./gemm.hpp"
+#include "./integer_mat.hpp"
+#include "./parallel_gemm.hpp"
+
+
+//! How one product is computed.
+struct GemmConfig {
+    //! The registered backend's name.
+    std::string backend = "threaded";
+    //! Cache block sizes, for backends that use them.
+    GemmBlocking blocking = kDefaultGemmBlocking;
+    //! Threads, for backends that use them; 0 for one per hardware thread.
+    unsigned int thread_count = 0;
+};
+
+//! A product implementation selectable by name.
+struct GemmBackend {
+    //! Name used on command lines and in profile files; no spaces.
+    std::string name;
+    //! Sets product = input_1 * input_2, resizing product to fit.
+    std::function<void(const Eigen::MatrixXd &, const Eigen::MatrixXd &,
+                       Eigen::MatrixXd &, const GemmConfig &)> multiply;
+    //! Whether config.blocking changes what multiply does.
+    bool uses_blocking = false;
+    //! Whether config.thread_count changes what multiply does.
+    bool uses_threads = false;
+};
+
+
+//! Computes product = input_1 * input_2 with a plain triple loop.
+/*!
+  The loops run column by column with the row index innermost, so every
+  access is unit stride in Eigen's column-major storage.
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit
+ */
+void GemmNaive(const Eigen::MatrixXd &input_1, const Eigen::MatrixXd &input_2,
+               Eigen::MatrixXd &product) {
+    const Eigen::Index kRows = input_1.rows();
+    const Eigen::Index kDepth = input_1.cols();
+    const Eigen::Index kCols = input_2.cols();
+
+    product.setZero(kRows, kCols);
+    for (Eigen::Index col = 0; col < kCols; col++) {
+        double *out = product.data() + col * kRows;
+        for (Eigen::Index inner = 0; inner < kDepth; inner++) {
+            const double kScale = input_2(inner, col);
+            const double *in = input_1.data() + inner * kRows;
+            for (Eigen::Index row = 0; row < kRows; row++) {
+                out[row] += in[row] * kScale;
+            }
+        }
+    }
+} // GemmNaive
+
+//! Returns the registry, seeded with the built-in backends.
+std::vector<GemmBackend> &GemmBackendRegistry() {
+    static std::vector<GemmBackend> backends{
+        {"naive",
+         [](const Eigen::MatrixXd &input_1, const Eigen::MatrixXd &input_2,
+            Eigen::MatrixXd &product, const GemmConfig &) {
+             GemmNaive(input_1, input_2, product);
+         },
+         false, false},
+        {"blocked",
+         [](const Eigen::MatrixXd &input_1, const Eigen::MatrixXd &input_2,
+            Eigen::MatrixXd &product, const GemmConfig &config) {
+             GemmBlocked(input_1, input_2, product, config.blocking);
+         },
+         true, false},
+        {"threaded",
+         [](const Eigen::MatrixXd &input_1, const Eigen::MatrixXd &input_2,
+            Eigen::MatrixXd &product, const GemmConfig &config) {
+             GemmParallel(input_1, input_2, product, config.thread_count,
+                          config.blocking);
+         },
+         true, true},
+        {"eigen",
+         [](const Eigen::MatrixXd &input_1, const Eigen::MatrixXd &input_2,
+            Eigen::MatrixXd &product, const GemmConfig &) {
+             product.noalias() = input_1 * input_2;
+         },
+         false, false},
+        {"integer",
+         [](const Eigen::MatrixXd &input_1, const Eigen::MatrixXd &input_2,
+            Eigen::MatrixXd &product, const GemmConfig &config) {
+             if (!MultiplyIfInteger(input_1, input_2, product)) {
+                 GemmBlocked(input_1, input_2, product, config.blocking);
+             }
+         },
+         true, false}};
+
+    return backends;
+} // GemmBackendRegistry
+
+//! Returns every registered backend, built-ins first.
+const std::vector<GemmBackend> &GetGemmBackends() {
+    return GemmBackendRegistry();
+} // GetGemmBackends
+
+//! Adds a backend, replacing any registered under the same name.
+/*!
+  Not thread-safe; register before products start.
+  \param backend the backend
+ */
+void RegisterGemmBackend(const GemmBackend &backend) {
+    for (GemmBackend &registered : GemmBackendRegistry()) {
+        if (registered.name == backend.name) {
+            registered = backend;
+            return;
+        }
+    }
+
+    GemmBackendRegistry().push_back(backend);
+} // RegisterGemmBackend
+
+//! Returns the backend called name.
+/*!
+  \param name the backend's name
+  \return The backend
+  \throws std::runtime_error if no backend has that name
+ */
+const GemmBackend &FindGemmBackend(const std::string &name) {
+    std::string known;
+    for (const GemmBackend &backend : GetGemmBackends()) {
+        if (backend.name == name) {
+            return backend;
+        }
+        known += (known.empty() ? "" : ", ") + backend.name;
+    }
+
+    throw std::runtime_error("unknown product backend \"" + name +
+                             "\" (known: " + known + ")");
+} // FindGemmBackend
+
+//! Computes product = input_1 * input_2 as config says.
+/*!
+  \param config the backend and its settings
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit
+ */
+void GemmWithConfig(const GemmConfig &config, const Eigen::MatrixXd &input_1,
+                    const Eigen::MatrixXd &input_2, Eigen::MatrixXd &product) {
+    FindGemmBackend(config.backend).multiply(input_1, input_2, product,
+                                              config);
+} // GemmWithConfig
+
+#endif
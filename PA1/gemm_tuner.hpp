@@ -0,0 +1,449 @@
+#ifndef GEMM_TUNER_H_
+#define GEMM_TUNER_H_
+
+//!  Picks product backends and block sizes per machine and remembers them.
+/*!
+  \file gemm_tuner.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Block sizes that fit one CPU's caches can be well off on another, and the
+  right thread count depends on the core count. TuneGemm times the
+  registered backends on this machine, searching block sizes one dimension
+  at a time and then thread counts, separately for small and large
+  products. The winners go into a GemmProfile, which LoadGemmProfile saves
+  to a small text file and reads back on later runs. A profile records the
+  machine it was tuned on and is tuned again on any other, so one home
+  directory shared across a mixed fleet still works.
+
+  Profile files look like:
+
+      pa1-gemm-profile 1
+      machine Intel(R) Xeon(R) CPU @ 2.20GHz / 8 threads
+      small blocked 96 256 4096 1
+      large threaded 96 384 2048 8
+
+  with each size class followed by its backend, mc, kc, nc and threads.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./gemm.hpp"
+#include "./gemm_backend.hpp"
+#include "./structured_gemm.hpp"
+#include "./thread_pool.hpp"
+
+//! First line of every profile file.
+const char kGemmProfileMagic[] = "pa1-gemm-profile";
+//! Profile format this code reads and writes.
+const int kGemmProfileVersion = 1;
+
+//! Products with fewer multiply-adds than this use the small configuration.
+const double kGemmProfileSmallWork = 64.0 * 64.0 * 64.0;
+
+
+//! The configurations tuned for one machine.
+struct GemmProfile {
+    //! DescribeMachine() of the machine it was tuned on.
+    std::string machine;
+    //! Used below kGemmProfileSmallWork multiply-adds.
+    GemmConfig small;
+    //! Used for everything else.
+    GemmConfig large;
+};
+
+//! Settings for TuneGemm.
+struct GemmTuneOptions {
+    //! Side of the square products timed for the small configuration.
+    Eigen::Index small_side = 32;
+    //! Side of the square products timed for the large configuration.
+    Eigen::Index large_side = 384;
+    //! Timed runs per candidate, after one untimed warm-up; the fastest
+    //! counts.
+    int repeats = 3;
+    //! The most threads tried, 0 for one per hardware thread.
+    unsigned int max_threads = 0;
+};
+
+
+//! Names this machine's CPU model and hardware thread count.
+std::string DescribeMachine() {
+    std::string model = "unknown cpu";
+
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        const std::size_t kColon = line.find(':');
+        if (line.compare(0, 10, "model name") == 0 &&
+                kColon != std::string::npos) {
+            model = line.substr(line.find_first_not_of(" \t", kColon + 1));
+            break;
+        }
+    }
+
+    return model + " / " + std::to_string(ResolveThreadCount(0)) +
+           " threads";
+} // DescribeMachine
+
+//! Returns where profiles are kept when no path is given.
+/*!
+  \return $XDG_CACHE_HOME/pa1/gemm_profile.txt, else
+          $HOME/.cache/pa1/gemm_profile.txt, else gemm_profile.txt in the
+          working directory
+ */
+std::string DefaultGemmProfilePath() {
+    const char *cache_home = std::getenv("XDG_CACHE_HOME");
+    if (cache_home != nullptr && cache_home[0] != '\0') {
+        return std::string(cache_home) + "/pa1/gemm_profile.txt";
+    }
+
+    const char *home = std::getenv("HOME");
+    if (home != nullptr && home[0] != '\0') {
+        return std::string(home) + "/.cache/pa1/gemm_profile.txt";
+    }
+
+    return "gemm_profile.txt";
+} // DefaultGemmProfilePath
+
+//! Returns the configuration profile holds for an m x k times k x n product.
+const GemmConfig &SelectGemmConfig(const GemmProfile &profile, Eigen::Index m,
+                                   Eigen::Index n, Eigen::Index k) {
+    const double kWork = static_cast<double>(m) * static_cast<double>(n) *
+                         static_cast<double>(k);
+
+    return kWork < kGemmProfileSmallWork ? profile.small : profile.large;
+} // SelectGemmConfig
+
+//! Computes product = input_1 * input_2 as profile says for their shape.
+/*!
+  Products past the small size class first try MultiplyIfStructured, with
+  the profile's block sizes and threads, so Gram, triangular and diagonal
+  products skip their redundant work whichever backend is chosen. Small
+  products skip the check, which they could not repay.
+  \param profile the tuned configurations
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit
+  \param thread_limit the most threads to use, 0 for no limit; jobs that
+                      already run side by side pass 1
+ */
+void GemmTuned(const GemmProfile &profile, const Eigen::MatrixXd &input_1,
+               const Eigen::MatrixXd &input_2, Eigen::MatrixXd &product,
+               unsigned int thread_limit = 0) {
+    GemmConfig config = SelectGemmConfig(profile, input_1.rows(),
+                                         input_2.cols(), input_1.cols());
+    if (thread_limit != 0 &&
+            (config.thread_count == 0 || config.thread_count > thread_limit)) {
+        config.thread_count = thread_limit;
+    }
+
+    const double kWork = static_cast<double>(input_1.rows()) *
+                         static_cast<double>(input_2.cols()) *
+                         static_cast<double>(input_1.cols());
+    if (kWork >= kGemmProfileSmallWork &&
+            MultiplyIfStructured(input_1, input_2, product,
+                                 config.thread_count, config.blocking)) {
+        return;
+    }
+
+    GemmWithConfig(config, input_1, input_2, product);
+} // GemmTuned
+
+//! Formats one size class as a profile line, such as "small naive ...".
+std::string FormatGemmConfigLine(const std::string &size_class,
+                                 const GemmConfig &config) {
+    return size_class + " " + config.backend + " " +
+           std::to_string(config.blocking.mc) + " " +
+           std::to_string(config.blocking.kc) + " " +
+           std::to_string(config.blocking.nc) + " " +
+           std::to_string(config.thread_count);
+} // FormatGemmConfigLine
+
+//! Parses the rest of a profile line after its size class.
+/*!
+  \param fields the backend, mc, kc, nc and threads
+  \param config receives the configuration
+  \return False if a field is missing or out of range, or the backend is
+          not registered
+ */
+bool ParseGemmConfigFields(std::istringstream &fields, GemmConfig &config) {
+    GemmConfig parsed;
+    std::string extra;
+    if (!(fields >> parsed.backend >> parsed.blocking.mc >> parsed.blocking.kc
+                 >> parsed.blocking.nc >> parsed.thread_count) ||
+            (fields >> extra)) {
+        return false;
+    }
+
+    if (parsed.blocking.mc <= 0 || parsed.blocking.mc % kGemmMr != 0 ||
+            parsed.blocking.kc <= 0 ||
+            parsed.blocking.nc <= 0 || parsed.blocking.nc % kGemmNr != 0) {
+        return false;
+    }
+    for (const GemmBackend &backend : GetGemmBackends()) {
+        if (backend.name == parsed.backend) {
+            config = parsed;
+            return true;
+        }
+    }
+
+    return false;
+} // ParseGemmConfigFields
+
+//! Reads a profile file.
+/*!
+  \param path the file
+  \param profile receives the profile
+  \return False if the file is missing, malformed, names an unknown
+          backend, or was tuned on another machine
+ */
+bool ReadGemmProfile(const std::string &path, GemmProfile &profile) {
+    std::ifstream profile_file(path);
+    std::string line;
+
+    if (!std::getline(profile_file, line) ||
+            line != std::string(kGemmProfileMagic) + " " +
+                    std::to_string(kGemmProfileVersion)) {
+        return false;
+    }
+
+    GemmProfile parsed;
+    bool has_small = false;
+    bool has_large = false;
+    while (std::getline(profile_file, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+
+        if (key == "machine") {
+            parsed.machine = line.substr(std::min(line.size(),
+                                                  key.size() + 1));
+        } else if (key == "small") {
+            has_small = ParseGemmConfigFields(fields, parsed.small);
+            if (!has_small) {
+                return false;
+            }
+        } else if (key == "large") {
+            has_large = ParseGemmConfigFields(fields, parsed.large);
+            if (!has_large) {
+                return false;
+            }
+        } else if (!key.empty()) {
+            return false;
+        }
+    }
+
+    if (!has_small || !has_large || parsed.machine != DescribeMachine()) {
+        return false;
+    }
+
+    profile = parsed;
+    return true;
+} // ReadGemmProfile
+
+//! Writes a profile file, creating its directory if needed.
+/*!
+  \param profile the profile
+  \param path the file
+  \throws std::runtime_error if the file cannot be written
+ */
+void WriteGemmProfile(const GemmProfile &profile, const std::string &path) {
+    // create each missing directory on the way; existing ones fail harmlessly
+    for (std::size_t slash = path.find('/', 1); slash != std::string::npos;
+            slash = path.find('/', slash + 1)) {
+        mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+
+    std::ofstream profile_file(path);
+    profile_file << kGemmProfileMagic << " " << kGemmProfileVersion << "\n"
+                 << "machine " << profile.machine << "\n"
+                 << FormatGemmConfigLine("small", profile.small) << "\n"
+                 << FormatGemmConfigLine("large", profile.large) << "\n";
+
+    profile_file.close();
+    if (!profile_file) {
+        throw std::runtime_error(path + ": cannot write profile");
+    }
+} // WriteGemmProfile
+
+//! Returns the fastest time, in seconds, config takes on a product.
+/*!
+  \param config the configuration to time
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product scratch output, reused across runs
+  \param repeats timed runs after the warm-up
+ */
+double TimeGemmConfig(const GemmConfig &config,
+                      const Eigen::MatrixXd &input_1,
+                      const Eigen::MatrixXd &input_2,
+                      Eigen::MatrixXd &product, int repeats) {
+    typedef std::chrono::steady_clock Clock;
+
+    GemmWithConfig(config, input_1, input_2, product);
+
+    double best = 0.0;
+    for (int repeat = 0; repeat < std::max(repeats, 1); repeat++) {
+        const Clock::time_point kStart = Clock::now();
+        GemmWithConfig(config, input_1, input_2, product);
+        const double kSeconds =
+            std::chrono::duration<double>(Clock::now() - kStart).count();
+
+        if (repeat == 0 || kSeconds < best) {
+            best = kSeconds;
+        }
+    }
+
+    return best;
+} // TimeGemmConfig
+
+//! Finds the fastest configuration for side x side products.
+/*!
+  Block sizes are searched once, on the first registered backend that uses
+  them and no threads, one dimension at a time. Every backend then runs
+  with the winning blocks, across thread counts if it uses threads.
+  \param side the side of the square operands timed
+  \param max_threads the most threads tried
+  \param repeats timed runs per candidate
+  \return The fastest configuration
+ */
+GemmConfig TuneGemmSize(Eigen::Index side, unsigned int max_threads,
+                        int repeats) {
+    const Eigen::MatrixXd kInput1 = Eigen::MatrixXd::Random(side, side);
+    const Eigen::MatrixXd kInput2 = Eigen::MatrixXd::Random(side, side);
+    Eigen::MatrixXd product;
+
+    GemmBlocking blocking = kDefaultGemmBlocking;
+    for (const GemmBackend &backend : GetGemmBackends()) {
+        if (!backend.uses_blocking || backend.uses_threads) {
+            continue;
+        }
+
+        GemmConfig config;
+        config.backend = backend.name;
+        config.thread_count = 1;
+        config.blocking = blocking;
+        double best = TimeGemmConfig(config, kInput1, kInput2, product,
+                                     repeats);
+
+        // one dimension at a time, each keeping the best of those before it
+        const std::vector<std::vector<Eigen::Index>> kCandidates{
+            {48, 96, 144, 192}, {128, 192, 256, 384}, {512, 1024, 2048, 4096}};
+        for (std::size_t dim = 0; dim < kCandidates.size(); dim++) {
+            for (Eigen::Index candidate : kCandidates[dim]) {
+                GemmBlocking trial = blocking;
+                Eigen::Index &size = dim == 0 ? trial.mc :
+                                     dim == 1 ? trial.kc : trial.nc;
+                if (size == candidate) {
+                    continue;
+                }
+                size = candidate;
+
+                config.blocking = trial;
+                const double kSeconds = TimeGemmConfig(config, kInput1,
+                                                       kInput2, product,
+                                                       repeats);
+                if (kSeconds < best) {
+                    best = kSeconds;
+                    blocking = trial;
+                }
+            }
+        }
+        break;
+    }
+
+    // 1, 2, 4, ... and max_threads itself
+    std::vector<unsigned int> thread_counts;
+    for (unsigned int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    GemmConfig best_config;
+    double best = 0.0;
+    bool has_best = false;
+    for (const GemmBackend &backend : GetGemmBackends()) {
+        for (unsigned int threads : thread_counts) {
+            if (!backend.uses_threads && threads != 1) {
+                continue;
+            }
+
+            GemmConfig config;
+            config.backend = backend.name;
+            config.blocking = blocking;
+            config.thread_count = threads;
+            const double kSeconds = TimeGemmConfig(config, kInput1, kInput2,
+                                                   product, repeats);
+            if (!has_best || kSeconds < best) {
+                best = kSeconds;
+                best_config = config;
+                has_best = true;
+            }
+        }
+    }
+
+    return best_config;
+} // TuneGemmSize
+
+//! Times the registered backends on this machine and returns the winners.
+/*!
+  \param options the sizes timed, repeats and thread ceiling
+  \return A profile for this machine
+ */
+GemmProfile TuneGemm(const GemmTuneOptions &options = {}) {
+    const unsigned int kMaxThreads = ResolveThreadCount(options.max_threads);
+
+    GemmProfile profile;
+    profile.machine = DescribeMachine();
+    // small products never have enough work to share out
+    profile.small = TuneGemmSize(options.small_side, 1, options.repeats);
+    profile.large = TuneGemmSize(options.large_side, kMaxThreads,
+                                 options.repeats);
+
+    return profile;
+} // TuneGemm
+
+//! Returns the profile saved at path, tuning and saving one if needed.
+/*!
+  \param path the profile file
+  \param retune tune and overwrite even if a usable profile exists
+  \param options the tuning settings, if tuning runs
+  \param tuned set to whether tuning ran, if not null
+  \return This machine's profile
+ */
+GemmProfile LoadGemmProfile(const std::string &path, bool retune = false,
+                            const GemmTuneOptions &options = {},
+                            bool *tuned = nullptr) {
+    GemmProfile profile;
+    const bool kLoaded = !retune && ReadGemmProfile(path, profile);
+    if (tuned != nullptr) {
+        *tuned = !kLoaded;
+    }
+    if (kLoaded) {
+        return profile;
+    }
+
+    profile = TuneGemm(options);
+    try {
+        WriteGemmProfile(profile, path);
+    } catch (const std::runtime_error &) {
+        // an unsaved profile only means tuning again next run
+    }
+
+    return profile;
+} // LoadGemmProfile
+
+#endif
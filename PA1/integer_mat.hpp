@@ -0,0 +1,512 @@
+#ifndef INTEGER_MAT_H_
+#define INTEGER_MAT_H_
+
+//!  Exact sums and products of integer-valued matrices.
+/*!
+  \file integer_mat.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Matrices such as part_one's counters hold only integers, yet they are
+  stored and multiplied as doubles. ToIntegerMat finds such matrices and
+  keeps them as int32 when every element fits, else int64, halving the
+  memory traffic of the narrow case and making every result exact.
+
+  Overflow is ruled out before any arithmetic rather than checked per
+  element: each IntegerMat carries a bound on its magnitudes, and a sum or
+  product whose result bound would not fit the accumulator is refused, so
+  the caller falls back to double. A result that fits int32 is accumulated
+  in int32, which doubles the lanes per instruction over int64. The kernels
+  are written once with GCC vector types and compiled for SSE2, AVX2 and
+  AVX-512; the best one the CPU supports is picked on first use, as in
+  mat_sum.hpp.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define INTEGER_MAT_X86 1
+#endif
+
+//! Column-major int32 matrix.
+typedef Eigen::Matrix<std::int32_t, Eigen::Dynamic, Eigen::Dynamic>
+    MatrixXi32;
+//! Column-major int64 matrix.
+typedef Eigen::Matrix<std::int64_t, Eigen::Dynamic, Eigen::Dynamic>
+    MatrixXi64;
+
+//! Largest magnitude below which doubles hold every integer exactly.
+const std::int64_t kMaxExactInteger = std::int64_t(1) << 53;
+//! Largest magnitude stored or accumulated in int32.
+const std::int64_t kMaxNarrowInteger =
+    std::numeric_limits<std::int32_t>::max();
+//! Largest magnitude accumulated in int64.
+const std::int64_t kMaxWideInteger = std::numeric_limits<std::int64_t>::max();
+
+//! Rows of A the product kernel walks per block (with kIntegerBlockDepth,
+//! 256 KiB of int32 that stay in L2).
+const Eigen::Index kIntegerBlockRows = 512;
+//! Columns of A the product kernel walks per block.
+const Eigen::Index kIntegerBlockDepth = 128;
+
+
+//! Class holding an integer-valued matrix as int32 or int64.
+class IntegerMat {
+  public:
+    //! Holds an empty int32 matrix.
+    IntegerMat() = default;
+
+    //! Holds an int32 matrix whose magnitudes are at most max_abs.
+    IntegerMat(MatrixXi32 narrow, std::int64_t max_abs)
+        : narrow_(std::move(narrow)), max_abs_(max_abs) {} // constructor
+
+    //! Holds an int64 matrix whose magnitudes are at most max_abs.
+    IntegerMat(MatrixXi64 wide, std::int64_t max_abs)
+        : is_narrow_(false), wide_(std::move(wide)),
+          max_abs_(max_abs) {} // constructor
+
+    //! Returns whether the matrix is held as int32.
+    bool IsNarrow() const {
+        return is_narrow_;
+    } // IsNarrow
+
+    //! Returns the number of rows.
+    Eigen::Index GetRows() const {
+        return is_narrow_ ? narrow_.rows() : wide_.rows();
+    } // GetRows
+
+    //! Returns the number of columns.
+    Eigen::Index GetCols() const {
+        return is_narrow_ ? narrow_.cols() : wide_.cols();
+    } // GetCols
+
+    //! Returns a bound on the magnitude of every element.
+    std::int64_t GetMaxAbs() const {
+        return max_abs_;
+    } // GetMaxAbs
+
+    //! Returns the int32 matrix; only valid when IsNarrow().
+    const MatrixXi32 &GetNarrow() const {
+        return narrow_;
+    } // GetNarrow
+
+    //! Returns the int64 matrix; only valid when !IsNarrow().
+    const MatrixXi64 &GetWide() const {
+        return wide_;
+    } // GetWide
+
+    //! Returns an int64 copy, whichever form is held.
+    MatrixXi64 ToWide() const {
+        return is_narrow_ ? MatrixXi64(narrow_.cast<std::int64_t>()) : wide_;
+    } // ToWide
+
+    //! Returns the matrix as doubles; exact below kMaxExactInteger.
+    Eigen::MatrixXd ToDouble() const {
+        return is_narrow_ ? Eigen::MatrixXd(narrow_.cast<double>())
+                          : Eigen::MatrixXd(wide_.cast<double>());
+    } // ToDouble
+
+  private:
+    bool is_narrow_ = true;
+    MatrixXi32 narrow_;
+    MatrixXi64 wide_;
+    std::int64_t max_abs_ = 0;
+};
+
+//! Signature shared by the int32 sum kernels: out[i] = in_1[i] + in_2[i].
+typedef void (*IntegerSumKernel32)(const std::int32_t *in_1,
+                                   const std::int32_t *in_2,
+                                   std::int32_t *out, std::size_t size);
+//! Signature shared by the int64 sum kernels: out[i] = in_1[i] + in_2[i].
+typedef void (*IntegerSumKernel64)(const std::int64_t *in_1,
+                                   const std::int64_t *in_2,
+                                   std::int64_t *out, std::size_t size);
+//! Signature shared by the int32 product kernels: out[i] += in[i] * scale.
+typedef void (*IntegerAxpyKernel32)(const std::int32_t *in,
+                                    std::int32_t scale, std::int32_t *out,
+                                    std::size_t size);
+//! Signature shared by the int64 product kernels: out[i] += in[i] * scale.
+typedef void (*IntegerAxpyKernel64)(const std::int64_t *in,
+                                    std::int64_t scale, std::int64_t *out,
+                                    std::size_t size);
+
+//! The kernels picked for the running CPU.
+struct IntegerKernels {
+    IntegerSumKernel32 sum_32;
+    IntegerSumKernel64 sum_64;
+    IntegerAxpyKernel32 axpy_32;
+    IntegerAxpyKernel64 axpy_64;
+};
+
+
+//! Finds whether mat holds only integers and, if so, converts it.
+/*!
+  \param mat the matrix
+  \param integer receives the matrix as int32 if every element fits, else
+                 as int64
+  \return False, leaving integer alone, if an element is not an integer or
+          its magnitude exceeds kMaxExactInteger
+ */
+bool ToIntegerMat(const Eigen::MatrixXd &mat, IntegerMat &integer) {
+    const double *data = mat.data();
+    const std::size_t kSize = static_cast<std::size_t>(mat.size());
+
+    double max_abs = 0.0;
+    for (std::size_t index = 0; index < kSize; index++) {
+        const double kMagnitude = std::fabs(data[index]);
+        // also rejects NaN, and keeps the cast below defined
+        if (!(kMagnitude <= static_cast<double>(kMaxExactInteger)) ||
+                kMagnitude != std::floor(kMagnitude)) {
+            return false;
+        }
+        max_abs = std::max(max_abs, kMagnitude);
+    }
+
+    const std::int64_t kMaxAbs = static_cast<std::int64_t>(max_abs);
+    if (kMaxAbs <= kMaxNarrowInteger) {
+        integer = IntegerMat(MatrixXi32(mat.cast<std::int32_t>()), kMaxAbs);
+    } else {
+        integer = IntegerMat(MatrixXi64(mat.cast<std::int64_t>()), kMaxAbs);
+    }
+
+    return true;
+} // ToIntegerMat
+
+//! Sum body shared by every instruction set; Bytes is the vector width.
+template <typename Int, int Bytes>
+__attribute__((always_inline)) inline
+void SumIntegerBody(const Int *in_1, const Int *in_2, Int *out,
+                    std::size_t size) {
+    typedef Int Vector __attribute__((vector_size(Bytes)));
+    const std::size_t kLanes = Bytes / sizeof(Int);
+
+    std::size_t index = 0;
+    for (; index + kLanes <= size; index += kLanes) {
+        Vector lhs;
+        Vector rhs;
+        std::memcpy(&lhs, in_1 + index, Bytes);
+        std::memcpy(&rhs, in_2 + index, Bytes);
+        lhs += rhs;
+        std::memcpy(out + index, &lhs, Bytes);
+    }
+    for (; index < size; index++) {
+        out[index] = in_1[index] + in_2[index];
+    }
+} // SumIntegerBody
+
+//! Product body shared by every instruction set; Bytes is the vector width.
+template <typename Int, int Bytes>
+__attribute__((always_inline)) inline
+void AxpyIntegerBody(const Int *in, Int scale, Int *out, std::size_t size) {
+    typedef Int Vector __attribute__((vector_size(Bytes)));
+    const std::size_t kLanes = Bytes / sizeof(Int);
+
+    std::size_t index = 0;
+    for (; index + kLanes <= size; index += kLanes) {
+        Vector term;
+        Vector sum;
+        std::memcpy(&term, in + index, Bytes);
+        std::memcpy(&sum, out + index, Bytes);
+        sum += term * scale;
+        std::memcpy(out + index, &sum, Bytes);
+    }
+    for (; index < size; index++) {
+        out[index] += in[index] * scale;
+    }
+} // AxpyIntegerBody
+
+//! Portable int32 sum kernel, 16-byte vectors.
+void SumInt32Generic(const std::int32_t *in_1, const std::int32_t *in_2,
+                     std::int32_t *out, std::size_t size) {
+    SumIntegerBody<std::int32_t, 16>(in_1, in_2, out, size);
+} // SumInt32Generic
+
+//! Portable int64 sum kernel, 16-byte vectors.
+void SumInt64Generic(const std::int64_t *in_1, const std::int64_t *in_2,
+                     std::int64_t *out, std::size_t size) {
+    SumIntegerBody<std::int64_t, 16>(in_1, in_2, out, size);
+} // SumInt64Generic
+
+//! Portable int32 product kernel, 16-byte vectors.
+void AxpyInt32Generic(const std::int32_t *in, std::int32_t scale,
+                      std::int32_t *out, std::size_t size) {
+    AxpyIntegerBody<std::int32_t, 16>(in, scale, out, size);
+} // AxpyInt32Generic
+
+//! Portable int64 product kernel, 16-byte vectors.
+void AxpyInt64Generic(const std::int64_t *in, std::int64_t scale,
+                      std::int64_t *out, std::size_t size) {
+    AxpyIntegerBody<std::int64_t, 16>(in, scale, out, size);
+} // AxpyInt64Generic
+
+#ifdef INTEGER_MAT_X86
+//! AVX2 int32 sum kernel, eight lanes per instruction.
+__attribute__((target("avx2")))
+void SumInt32Avx2(const std::int32_t *in_1, const std::int32_t *in_2,
+                  std::int32_t *out, std::size_t size) {
+    SumIntegerBody<std::int32_t, 32>(in_1, in_2, out, size);
+} // SumInt32Avx2
+
+//! AVX2 int64 sum kernel, four lanes per instruction.
+__attribute__((target("avx2")))
+void SumInt64Avx2(const std::int64_t *in_1, const std::int64_t *in_2,
+                  std::int64_t *out, std::size_t size) {
+    SumIntegerBody<std::int64_t, 32>(in_1, in_2, out, size);
+} // SumInt64Avx2
+
+//! AVX2 int32 product kernel, eight lanes per instruction.
+__attribute__((target("avx2")))
+void AxpyInt32Avx2(const std::int32_t *in, std::int32_t scale,
+                   std::int32_t *out, std::size_t size) {
+    AxpyIntegerBody<std::int32_t, 32>(in, scale, out, size);
+} // AxpyInt32Avx2
+
+//! AVX2 int64 product kernel; AVX2 has no 64-bit multiply, so each one is
+//! built from 32-bit halves.
+__attribute__((target("avx2")))
+void AxpyInt64Avx2(const std::int64_t *in, std::int64_t scale,
+                   std::int64_t *out, std::size_t size) {
+    AxpyIntegerBody<std::int64_t, 32>(in, scale, out, size);
+} // AxpyInt64Avx2
+
+//! AVX-512 int32 sum kernel, sixteen lanes per instruction.
+__attribute__((target("avx512f")))
+void SumInt32Avx512(const std::int32_t *in_1, const std::int32_t *in_2,
+                    std::int32_t *out, std::size_t size) {
+    SumIntegerBody<std::int32_t, 64>(in_1, in_2, out, size);
+} // SumInt32Avx512
+
+//! AVX-512 int64 sum kernel, eight lanes per instruction.
+__attribute__((target("avx512f")))
+void SumInt64Avx512(const std::int64_t *in_1, const std::int64_t *in_2,
+                    std::int64_t *out, std::size_t size) {
+    SumIntegerBody<std::int64_t, 64>(in_1, in_2, out, size);
+} // SumInt64Avx512
+
+//! AVX-512 int32 product kernel, sixteen lanes per instruction.
+__attribute__((target("avx512f")))
+void AxpyInt32Avx512(const std::int32_t *in, std::int32_t scale,
+                     std::int32_t *out, std::size_t size) {
+    AxpyIntegerBody<std::int32_t, 64>(in, scale, out, size);
+} // AxpyInt32Avx512
+
+//! AVX-512 int64 product kernel, using AVX512DQ's 64-bit multiply.
+__attribute__((target("avx512f,avx512dq")))
+void AxpyInt64Avx512(const std::int64_t *in, std::int64_t scale,
+                     std::int64_t *out, std::size_t size) {
+    AxpyIntegerBody<std::int64_t, 64>(in, scale, out, size);
+} // AxpyInt64Avx512
+#endif
+
+//! Picks the widest kernels the running CPU supports.
+/*!
+  \return The selected kernels
+ */
+IntegerKernels SelectIntegerKernels() {
+    IntegerKernels kernels{SumInt32Generic, SumInt64Generic,
+                           AxpyInt32Generic, AxpyInt64Generic};
+#ifdef INTEGER_MAT_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        kernels = {SumInt32Avx2, SumInt64Avx2, AxpyInt32Avx2, AxpyInt64Avx2};
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels.sum_32 = SumInt32Avx512;
+        kernels.sum_64 = SumInt64Avx512;
+        kernels.axpy_32 = AxpyInt32Avx512;
+    }
+    if (__builtin_cpu_supports("avx512dq")) {
+        kernels.axpy_64 = AxpyInt64Avx512;
+    }
+#endif
+    return kernels;
+} // SelectIntegerKernels
+
+//! Returns the dispatched kernels, resolving them on the first call.
+const IntegerKernels &GetIntegerKernels() {
+    static const IntegerKernels kKernels = SelectIntegerKernels();
+    return kKernels;
+} // GetIntegerKernels
+
+//! Adds two integer matrices of the same shape exactly.
+/*!
+  \param input_1 the first operand
+  \param input_2 the second operand
+  \param sum receives the sum, as int32 when its bound fits
+  \return False, leaving sum alone, if the sum could overflow int64
+ */
+bool SumIntegerMats(const IntegerMat &input_1, const IntegerMat &input_2,
+                    IntegerMat &sum) {
+    // magnitudes are at most kMaxWideInteger, so this cannot wrap
+    const std::uint64_t kBound =
+        static_cast<std::uint64_t>(input_1.GetMaxAbs()) +
+        static_cast<std::uint64_t>(input_2.GetMaxAbs());
+    if (kBound > static_cast<std::uint64_t>(kMaxWideInteger)) {
+        return false;
+    }
+    const std::int64_t kMaxAbs = static_cast<std::int64_t>(kBound);
+    const std::size_t kSize =
+        static_cast<std::size_t>(input_1.GetRows() * input_1.GetCols());
+
+    if (input_1.IsNarrow() && input_2.IsNarrow() &&
+            kMaxAbs <= kMaxNarrowInteger) {
+        MatrixXi32 result(input_1.GetRows(), input_1.GetCols());
+        GetIntegerKernels().sum_32(input_1.GetNarrow().data(),
+                                   input_2.GetNarrow().data(), result.data(),
+                                   kSize);
+        sum = IntegerMat(std::move(result), kMaxAbs);
+        return true;
+    }
+
+    // widen only the operands that need it
+    MatrixXi64 widened_1;
+    MatrixXi64 widened_2;
+    if (input_1.IsNarrow()) {
+        widened_1 = input_1.ToWide();
+    }
+    if (input_2.IsNarrow()) {
+        widened_2 = input_2.ToWide();
+    }
+
+    MatrixXi64 result(input_1.GetRows(), input_1.GetCols());
+    GetIntegerKernels().sum_64(
+        input_1.IsNarrow() ? widened_1.data() : input_1.GetWide().data(),
+        input_2.IsNarrow() ? widened_2.data() : input_2.GetWide().data(),
+        result.data(), kSize);
+    sum = IntegerMat(std::move(result), kMaxAbs);
+    return true;
+} // SumIntegerMats
+
+//! Computes out += a * b over column-major storage, a block of A at a time.
+/*!
+  \param m the number of rows of A and out
+  \param n the number of columns of B and out
+  \param k the number of columns of A and rows of B
+  \param a A, with leading dimension m
+  \param b B, with leading dimension k
+  \param out the output, zeroed by the caller, with leading dimension m
+  \param axpy the kernel adding a scaled column segment
+ */
+template <typename Int, typename BInt>
+void MultiplyIntegerBlocked(Eigen::Index m, Eigen::Index n, Eigen::Index k,
+                            const Int *a, const BInt *b, Int *out,
+                            void (*axpy)(const Int *, Int, Int *,
+                                         std::size_t)) {
+    for (Eigen::Index pc = 0; pc < k; pc += kIntegerBlockDepth) {
+        const Eigen::Index kc = std::min(kIntegerBlockDepth, k - pc);
+
+        for (Eigen::Index ic = 0; ic < m; ic += kIntegerBlockRows) {
+            const Eigen::Index mc = std::min(kIntegerBlockRows, m - ic);
+
+            for (Eigen::Index col = 0; col < n; col++) {
+                Int *out_segment = out + ic + col * m;
+                for (Eigen::Index inner = pc; inner < pc + kc; inner++) {
+                    const Int kScale = static_cast<Int>(b[inner + col * k]);
+                    if (kScale != 0) {
+                        axpy(a + ic + inner * m, kScale, out_segment,
+                             static_cast<std::size_t>(mc));
+                    }
+                }
+            }
+        }
+    }
+} // MultiplyIntegerBlocked
+
+//! Multiplies two integer matrices whose inner dimensions agree exactly.
+/*!
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product receives the product, accumulated in int32 when its bound
+                 fits
+  \return False, leaving product alone, if the product could overflow int64
+ */
+bool MultiplyIntegerMats(const IntegerMat &input_1, const IntegerMat &input_2,
+                         IntegerMat &product) {
+    const Eigen::Index kRows = input_1.GetRows();
+    const Eigen::Index kDepth = input_1.GetCols();
+    const Eigen::Index kCols = input_2.GetCols();
+
+    // every element is a sum of kDepth terms of at most max_1 * max_2; each
+    // factor is below 2^63, so checking the term bound first keeps both
+    // products inside 128 bits
+    const unsigned __int128 kTermBound =
+        static_cast<unsigned __int128>(input_1.GetMaxAbs()) *
+        static_cast<std::uint64_t>(input_2.GetMaxAbs());
+    const unsigned __int128 kBound =
+        kTermBound * static_cast<std::uint64_t>(kDepth);
+    if (kTermBound > static_cast<unsigned __int128>(kMaxWideInteger) ||
+            kBound > static_cast<unsigned __int128>(kMaxWideInteger)) {
+        return false;
+    }
+    const std::int64_t kMaxAbs = static_cast<std::int64_t>(kBound);
+
+    if (input_1.IsNarrow() && input_2.IsNarrow() &&
+            kMaxAbs <= kMaxNarrowInteger) {
+        MatrixXi32 result = MatrixXi32::Zero(kRows, kCols);
+        MultiplyIntegerBlocked(kRows, kCols, kDepth,
+                               input_1.GetNarrow().data(),
+                               input_2.GetNarrow().data(), result.data(),
+                               GetIntegerKernels().axpy_32);
+        product = IntegerMat(std::move(result), kMaxAbs);
+        return true;
+    }
+
+    MatrixXi64 widened_1;
+    if (input_1.IsNarrow()) {
+        widened_1 = input_1.ToWide();
+    }
+    const std::int64_t *a =
+        input_1.IsNarrow() ? widened_1.data() : input_1.GetWide().data();
+
+    // B is only read one scale at a time, so it need not be widened
+    MatrixXi64 result = MatrixXi64::Zero(kRows, kCols);
+    if (input_2.IsNarrow()) {
+        MultiplyIntegerBlocked(kRows, kCols, kDepth, a,
+                               input_2.GetNarrow().data(), result.data(),
+                               GetIntegerKernels().axpy_64);
+    } else {
+        MultiplyIntegerBlocked(kRows, kCols, kDepth, a,
+                               input_2.GetWide().data(), result.data(),
+                               GetIntegerKernels().axpy_64);
+    }
+    product = IntegerMat(std::move(result), kMaxAbs);
+    return true;
+} // MultiplyIntegerMats
+
+//! Multiplies two double matrices exactly if both hold only integers.
+/*!
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product receives the product as doubles, which are exact when it
+                 stays below kMaxExactInteger
+  \return False, leaving product alone, if an operand is not integer-valued
+          or the product could overflow int64; compute it in double then
+ */
+bool MultiplyIfInteger(const Eigen::MatrixXd &input_1,
+                       const Eigen::MatrixXd &input_2,
+                       Eigen::MatrixXd &product) {
+    IntegerMat integer_1;
+    IntegerMat integer_2;
+    IntegerMat integer_product;
+    if (!ToIntegerMat(input_1, integer_1) ||
+            !ToIntegerMat(input_2, integer_2) ||
+            !MultiplyIntegerMats(integer_1, integer_2, integer_product)) {
+        return false;
+    }
+
+    product = integer_product.ToDouble();
+    return true;
+} // MultiplyIfInteger
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef MAT_ARENA_H_
+#define MAT_ARENA_H_
+
+//!  A pool that recycles matrix buffers across a list of jobs.
+/*!
+  \file mat_arena.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Results of a job list tend to share a handful of shapes. Each finished
+  result handed back to the arena keeps its heap buffer, and the next job
+  asking for the same number of elements gets that buffer back, already
+  faulted in, instead of a fresh allocation. Eigen only reallocates on
+  resize when the element count changes, so a buffer serves every shape
+  with its size.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+//! Bytes of idle buffers an arena keeps when no limit is given.
+const std::size_t kDefaultMatArenaBytes = std::size_t(256) << 20;
+
+
+//! Class that hands out matrices and takes them back for reuse; thread-safe.
+class MatArena {
+  public:
+    //! Creates an empty arena.
+    /*!
+      \param max_idle_bytes the most bytes of returned buffers to keep;
+                            buffers past it are freed
+     */
+    explicit MatArena(std::size_t max_idle_bytes = kDefaultMatArenaBytes)
+        : max_idle_bytes_(max_idle_bytes) {} // constructor
+
+    MatArena(const MatArena &) = delete;
+    MatArena &operator=(const MatArena &) = delete;
+
+    //! Returns a rows x cols matrix with unspecified contents.
+    /*!
+      \param rows the number of rows
+      \param cols the number of columns
+      \return A recycled matrix if one of the same size is idle, else a new
+              one
+     */
+    Eigen::MatrixXd Acquire(Eigen::Index rows, Eigen::Index cols) {
+        Eigen::MatrixXd mat;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto idle = idle_.find(rows * cols);
+            if (idle != idle_.end() && !idle->second.empty()) {
+                mat.swap(idle->second.back());
+                idle->second.pop_back();
+                idle_bytes_ -= GetBytes(mat);
+                hits_++;
+            } else {
+                misses_++;
+            }
+        }
+
+        mat.resize(rows, cols);
+        return mat;
+    } // Acquire
+
+    //! Takes back a matrix that is no longer needed.
+    /*!
+      \param mat the matrix; left empty
+     */
+    void Release(Eigen::MatrixXd &&mat) {
+        Eigen::MatrixXd recycled;
+        recycled.swap(mat);
+        if (recycled.size() == 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_bytes_ + GetBytes(recycled) > max_idle_bytes_) {
+            return;
+        }
+
+        idle_bytes_ += GetBytes(recycled);
+        idle_[recycled.size()].push_back(std::move(recycled));
+    } // Release
+
+    //! Returns how many Acquire calls reused a buffer.
+    std::size_t GetHits() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    } // GetHits
+
+    //! Returns how many Acquire calls had to allocate.
+    std::size_t GetMisses() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return misses_;
+    } // GetMisses
+
+  private:
+    //! Returns the bytes of mat's buffer.
+    static std::size_t GetBytes(const Eigen::MatrixXd &mat) {
+        return static_cast<std::size_t>(mat.size()) * sizeof(double);
+    } // GetBytes
+
+    std::size_t max_idle_bytes_;
+    std::size_t idle_bytes_ = 0;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+    std::map<Eigen::Index, std::vector<Eigen::MatrixXd>> idle_;
+    mutable std::mutex mutex_;
+};
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef MAT_CHAIN_H_
+#define MAT_CHAIN_H_
+
+//!  Products of whole chains of matrices in the cheapest order.
+/*!
+  \file mat_chain.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  A chain A_0 A_1 ... A_{n-1} gives the same product under every
+  parenthesization, but the work can differ by orders of magnitude when the
+  shapes vary. PlanMatChain finds the cheapest order with the classic
+  O(n^3) dynamic program over the chain's dimensions, and MultiplyMatChain
+  carries the plan out with the custom product kernel.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./parallel_gemm.hpp"
+#include "./thread_pool.hpp"
+
+
+//! The cheapest parenthesization of a matrix chain.
+struct MatChainPlan {
+    //! The n + 1 dimensions; matrix i is dims[i] x dims[i + 1].
+    std::vector<Eigen::Index> dims;
+    //! splits[i * n + j] is the last matrix of the left factor of A_i..A_j.
+    std::vector<std::size_t> splits;
+    //! Floating-point operations of the chosen order, 2 per multiply-add.
+    double optimal_flops = 0.0;
+    //! Floating-point operations of plain left-to-right evaluation.
+    double left_to_right_flops = 0.0;
+
+    //! Returns the number of matrices in the chain.
+    std::size_t GetLength() const {
+        return dims.size() - 1;
+    } // GetLength
+
+    //! Returns where A_first..A_last is split into two factors.
+    std::size_t GetSplit(std::size_t first, std::size_t last) const {
+        return splits[first * GetLength() + last];
+    } // GetSplit
+};
+
+
+//! Returns the floating-point operations of an m x k by k x n product.
+double CountProductFlops(Eigen::Index m, Eigen::Index k, Eigen::Index n) {
+    return 2.0 * static_cast<double>(m) * static_cast<double>(k) *
+           static_cast<double>(n);
+} // CountProductFlops
+
+//! Finds the cheapest parenthesization of a chain of matrix shapes.
+/*!
+  \param dims the n + 1 dimensions of an n-matrix chain, n >= 1
+  \return The plan, with the cost of the plan and of left-to-right order
+ */
+MatChainPlan PlanMatChain(const std::vector<Eigen::Index> &dims) {
+    if (dims.size() < 2) {
+        throw std::runtime_error("a matrix chain needs at least one matrix");
+    }
+
+    MatChainPlan plan;
+    plan.dims = dims;
+    const std::size_t n = plan.GetLength();
+    plan.splits.assign(n * n, 0);
+
+    // cost[i * n + j] is the cheapest way to form A_i..A_j
+    std::vector<double> cost(n * n, 0.0);
+    for (std::size_t length = 2; length <= n; length++) {
+        for (std::size_t first = 0; first + length <= n; first++) {
+            const std::size_t last = first + length - 1;
+            double &best = cost[first * n + last];
+            best = std::numeric_limits<double>::infinity();
+
+            for (std::size_t split = first; split < last; split++) {
+                const double candidate =
+                    cost[first * n + split] + cost[(split + 1) * n + last] +
+                    CountProductFlops(dims[first], dims[split + 1],
+                                      dims[last + 1]);
+                if (candidate < best) {
+                    best = candidate;
+                    plan.splits[first * n + last] = split;
+                }
+            }
+        }
+    }
+
+    plan.optimal_flops = cost[n - 1];
+    for (std::size_t index = 1; index < n; index++) {
+        plan.left_to_right_flops +=
+            CountProductFlops(dims[0], dims[index], dims[index + 1]);
+    }
+
+    return plan;
+} // PlanMatChain
+
+//! Checks that a chain of matrices can be multiplied and plans it.
+/*!
+  \param chain the matrices, in order
+  \return The plan
+ */
+MatChainPlan PlanMatChain(const std::vector<const Eigen::MatrixXd *> &chain) {
+    if (chain.empty()) {
+        throw std::runtime_error("a matrix chain needs at least one matrix");
+    }
+
+    std::vector<Eigen::Index> dims{chain[0]->rows()};
+    for (std::size_t index = 0; index < chain.size(); index++) {
+        if (chain[index]->rows() != dims.back()) {
+            throw std::runtime_error(
+                "matrices " + std::to_string(index) + " and " +
+                std::to_string(index + 1) +
+                " have incompatible dimensions for multiplication");
+        }
+        dims.push_back(chain[index]->cols());
+    }
+
+    return PlanMatChain(dims);
+} // PlanMatChain
+
+//! Writes a plan as nested parentheses, such as "((A1 A2) A3)".
+/*!
+  \param plan the plan
+  \param names the name of each matrix; "A1", "A2", ... when empty
+  \return The parenthesized chain
+ */
+std::string FormatMatChainPlan(const MatChainPlan &plan,
+                               const std::vector<std::string> &names = {}) {
+    std::string text;
+
+    auto format = [&](auto &self, std::size_t first, std::size_t last) -> void {
+        if (first == last) {
+            text += names.empty() ? "A" + std::to_string(first + 1)
+                                  : names[first];
+            return;
+        }
+
+        const std::size_t split = plan.GetSplit(first, last);
+        text += '(';
+        self(self, first, split);
+        text += ' ';
+        self(self, split + 1, last);
+        text += ')';
+    };
+    format(format, 0, plan.GetLength() - 1);
+
+    return text;
+} // FormatMatChainPlan
+
+//! Multiplies A_first..A_last into result following the plan.
+void MultiplyMatChainRange(const std::vector<const Eigen::MatrixXd *> &chain,
+                           const MatChainPlan &plan, std::size_t first,
+                           std::size_t last, ThreadPool &pool,
+                           Eigen::MatrixXd &result) {
+    const std::size_t split = plan.GetSplit(first, last);
+
+    // single matrices are used in place; only real subproducts get storage
+    Eigen::MatrixXd left_product;
+    Eigen::MatrixXd right_product;
+    if (split != first) {
+        MultiplyMatChainRange(chain, plan, first, split, pool, left_product);
+    }
+    if (split + 1 != last) {
+        MultiplyMatChainRange(chain, plan, split + 1, last, pool,
+                              right_product);
+    }
+
+    GemmParallel(pool, split == first ? *chain[first] : left_product,
+                 split + 1 == last ? *chain[last] : right_product, result);
+} // MultiplyMatChainRange
+
+//! Multiplies a chain of matrices in the cheapest order.
+/*!
+  \param chain the matrices, in order
+  \param thread_count threads per product, 0 for one per hardware thread
+  \param plan_out receives the plan that was used, if not null
+  \return The product of the whole chain
+ */
+Eigen::MatrixXd MultiplyMatChain(
+        const std::vector<const Eigen::MatrixXd *> &chain,
+        unsigned int thread_count = 0, MatChainPlan *plan_out = nullptr) {
+    const MatChainPlan plan = PlanMatChain(chain);
+    if (plan_out != nullptr) {
+        *plan_out = plan;
+    }
+
+    if (chain.size() == 1) {
+        return *chain[0];
+    }
+
+    ThreadPool pool(thread_count);
+    Eigen::MatrixXd product;
+    MultiplyMatChainRange(chain, plan, 0, chain.size() - 1, pool, product);
+
+    return product;
+} // MultiplyMatChain
+
+#endif
@@ -0,0 +1,64 @@
+// Jacob Hartt
+// CS2300(T/R)
+// 10/16/2026
+
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <eigen3/Eigen/Dense> // Headers are located at /usr/include/eigen3
+
+#include "../mat_io.hpp"
+
+
+// Prints how to call the program.
+void PrintUsage(const std::string &program_name);
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 4) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    const std::string kMode = argv[1];
+    const std::string kInputPath = argv[2];
+    const std::string kOutputPath = argv[3];
+
+    try {
+        if (kMode == "to-binary") {
+            ConvertTextToBinary(kInputPath, kOutputPath);
+        } else if (kMode == "to-binary-row-major") {
+            // rows contiguous, for consumers that walk the matrix row-wise
+            ConvertTextToBinary(kInputPath, kOutputPath, MatLayout::kRowMajor);
+        } else if (kMode == "to-text") {
+            ConvertBinaryToText(kInputPath, kOutputPath);
+        } else if (kMode == "to-text-aligned") {
+            // the layout Eigen's operator<< prints, rounded to six digits
+            ConvertBinaryToText(kInputPath, kOutputPath,
+                                MatTextFormat::kEigenAligned);
+        } else if (kMode == "to-compressed") {
+            // any readable format in, chunked and compressed out
+            WriteMatFileCompressed(ReadMatFile(kInputPath), kOutputPath);
+        } else if (kMode == "from-compressed") {
+            WriteMatFileBinary(ReadMatFileCompressed(kInputPath),
+                               kOutputPath);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // main
+
+void PrintUsage(const std::string &program_name) {
+    std::cerr << "Usage: " << program_name
+              << " to-binary|to-binary-row-major|to-text|to-text-aligned|"
+              << "to-compressed|from-compressed <input_path> <output_path>"
+              << std::endl;
+} // PrintUsage
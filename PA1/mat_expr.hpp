@@ -0,0 +1,496 @@
+#ifndef MAT_EXPR_H_
+#define MAT_EXPR_H_
+
+//!  Lazy matrix expressions evaluated with fused sums and direct products.
+/*!
+  \file mat_expr.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Adding, subtracting or multiplying MatExpr values only records the
+  operation and checks shapes. EvaluateMatExpr then flattens every chain of sums into
+  one list of signed terms: the plain matrices are added in a single pass over
+  the output, and each product is accumulated straight into the same output
+  by the GEMM kernel. A product operand that is itself a sum of matrices is
+  summed while the kernel packs it, so (A + B) * C never builds A + B.
+
+  The tree is built at run time rather than in the type system, so that
+  ParseMatExpr can build the same trees from text.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./gemm.hpp"
+#include "./parallel_gemm.hpp"
+#include "./thread_pool.hpp"
+
+//! Elements summed per pass of the fused sum, sized to stay in L1.
+const Eigen::Index kMatExprSumBlock = 2048;
+
+
+//! The operation at one node of an expression tree.
+enum class MatExprKind {
+    kMatrix,
+    kSum,
+    kDifference,
+    kProduct
+};
+
+//! One node of an expression tree.
+struct MatExprNode {
+    //! The operation.
+    MatExprKind kind;
+    //! The operand of a kMatrix node, owned by the caller.
+    const Eigen::MatrixXd *matrix = nullptr;
+    //! The left operand of a binary node.
+    std::shared_ptr<const MatExprNode> left;
+    //! The right operand of a binary node.
+    std::shared_ptr<const MatExprNode> right;
+    //! Rows of the node's value.
+    Eigen::Index rows = 0;
+    //! Columns of the node's value.
+    Eigen::Index cols = 0;
+};
+
+//! A matrix or product, with its sign, from a flattened chain of sums.
+struct MatExprTerm {
+    //! A kMatrix or kProduct node.
+    const MatExprNode *node;
+    //! +1 or -1.
+    double sign;
+};
+
+//! Reads the elementwise sum of signed matrices as a GEMM operand.
+struct SumOperand {
+    //! Column-major data of each matrix, all of the same shape.
+    std::vector<const double *> data;
+    //! Sign applied to each matrix.
+    std::vector<double> signs;
+    //! The leading dimension shared by every matrix.
+    Eigen::Index ld;
+
+    //! Returns element (row, col) of the sum.
+    double operator()(Eigen::Index row, Eigen::Index col) const {
+        const Eigen::Index offset = row + col * ld;
+        double value = signs[0] * data[0][offset];
+        for (std::size_t term = 1; term < data.size(); term++) {
+            value += signs[term] * data[term][offset];
+        }
+        return value;
+    } // operator()
+};
+
+
+//! Class that holds an unevaluated matrix expression.
+/*!
+  Matrices are referenced, not copied, so they must outlive the expression.
+ */
+class MatExpr {
+  public:
+    //! Wraps a matrix as the leaf of an expression.
+    MatExpr(const Eigen::MatrixXd &matrix) {  // NOLINT: implicit on purpose
+        std::shared_ptr<MatExprNode> node = std::make_shared<MatExprNode>();
+        node->kind = MatExprKind::kMatrix;
+        node->matrix = &matrix;
+        node->rows = matrix.rows();
+        node->cols = matrix.cols();
+        node_ = node;
+    } // constructor
+
+    //! Returns the number of rows of the value.
+    Eigen::Index GetRows() const {
+        return node_->rows;
+    } // GetRows
+
+    //! Returns the number of columns of the value.
+    Eigen::Index GetCols() const {
+        return node_->cols;
+    } // GetCols
+
+    //! Returns the root of the tree.
+    const MatExprNode &GetNode() const {
+        return *node_;
+    } // GetNode
+
+    //! Records left + right, failing if the shapes differ.
+    friend MatExpr operator+(const MatExpr &left, const MatExpr &right) {
+        return MakeElementwise(MatExprKind::kSum, left, right);
+    } // operator+
+
+    //! Records left - right, failing if the shapes differ.
+    friend MatExpr operator-(const MatExpr &left, const MatExpr &right) {
+        return MakeElementwise(MatExprKind::kDifference, left, right);
+    } // operator-
+
+    //! Records left * right, failing if the inner dimensions differ.
+    friend MatExpr operator*(const MatExpr &left, const MatExpr &right) {
+        if (left.GetCols() != right.GetRows()) {
+            throw std::runtime_error(
+                "matrices have incompatible dimensions for multiplication");
+        }
+
+        return MatExpr(MatExprKind::kProduct, left, right, left.GetRows(),
+                       right.GetCols());
+    } // operator*
+
+  private:
+    MatExpr(MatExprKind kind, const MatExpr &left, const MatExpr &right,
+            Eigen::Index rows, Eigen::Index cols) {
+        std::shared_ptr<MatExprNode> node = std::make_shared<MatExprNode>();
+        node->kind = kind;
+        node->left = left.node_;
+        node->right = right.node_;
+        node->rows = rows;
+        node->cols = cols;
+        node_ = node;
+    } // constructor
+
+    static MatExpr MakeElementwise(MatExprKind kind, const MatExpr &left,
+                                   const MatExpr &right) {
+        if (left.GetRows() != right.GetRows() ||
+                left.GetCols() != right.GetCols()) {
+            throw std::runtime_error("matrices have different dimensions");
+        }
+
+        return MatExpr(kind, left, right, left.GetRows(), left.GetCols());
+    } // MakeElementwise
+
+    std::shared_ptr<const MatExprNode> node_;
+};
+
+//! Flattens a chain of sums and differences into signed terms.
+/*!
+  \param node the root of the chain
+  \param sign the sign the whole chain carries
+  \param terms receives every matrix and product in the chain
+ */
+void FlattenMatExprSum(const MatExprNode &node, double sign,
+                       std::vector<MatExprTerm> &terms) {
+    if (node.kind == MatExprKind::kSum ||
+            node.kind == MatExprKind::kDifference) {
+        FlattenMatExprSum(*node.left, sign, terms);
+        FlattenMatExprSum(*node.right,
+                          node.kind == MatExprKind::kSum ? sign : -sign,
+                          terms);
+    } else {
+        terms.push_back({&node, sign});
+    }
+} // FlattenMatExprSum
+
+void EvaluateMatExprInto(const MatExprNode &node, Eigen::MatrixXd &result,
+                         ThreadPool &pool);
+
+//! Sums signed matrices of one shape into out in a single pass.
+/*!
+  \param terms kMatrix terms, at least one
+  \param out the result, already sized; its old contents are ignored
+ */
+void FusedSumInto(const std::vector<MatExprTerm> &terms, double *out) {
+    const Eigen::Index size = terms[0].node->matrix->size();
+
+    for (Eigen::Index start = 0; start < size; start += kMatExprSumBlock) {
+        const Eigen::Index end = std::min(start + kMatExprSumBlock, size);
+
+        // one block of the output stays in cache while every term passes
+        const double *first = terms[0].node->matrix->data();
+        const double first_sign = terms[0].sign;
+        for (Eigen::Index index = start; index < end; index++) {
+            out[index] = first_sign * first[index];
+        }
+
+        for (std::size_t term = 1; term < terms.size(); term++) {
+            const double *data = terms[term].node->matrix->data();
+            if (terms[term].sign > 0) {
+                for (Eigen::Index index = start; index < end; index++) {
+                    out[index] += data[index];
+                }
+            } else {
+                for (Eigen::Index index = start; index < end; index++) {
+                    out[index] -= data[index];
+                }
+            }
+        }
+    }
+} // FusedSumInto
+
+//! Builds the operand a product reads for one side of the product.
+/*!
+  A sum of plain matrices becomes a SumOperand over them. Anything holding a
+  product is evaluated into scratch first.
+  \param node the side of the product
+  \param sign a sign folded into the operand
+  \param scratch owns any matrix evaluated here
+  \param pool the threads used to evaluate nested products
+  \return The operand
+ */
+SumOperand MakeProductOperand(const MatExprNode &node, double sign,
+                              std::vector<Eigen::MatrixXd> &scratch,
+                              ThreadPool &pool) {
+    std::vector<MatExprTerm> terms;
+    FlattenMatExprSum(node, sign, terms);
+
+    const bool only_matrices = std::all_of(
+        terms.begin(), terms.end(), [](const MatExprTerm &term) {
+            return term.node->kind == MatExprKind::kMatrix;
+        });
+
+    SumOperand operand;
+    if (only_matrices) {
+        for (const MatExprTerm &term : terms) {
+            operand.data.push_back(term.node->matrix->data());
+            operand.signs.push_back(term.sign);
+        }
+        operand.ld = terms[0].node->matrix->outerStride();
+    } else {
+        scratch.emplace_back();
+        EvaluateMatExprInto(node, scratch.back(), pool);
+        operand.data.push_back(scratch.back().data());
+        operand.signs.push_back(sign);
+        operand.ld = scratch.back().outerStride();
+    }
+
+    return operand;
+} // MakeProductOperand
+
+//! Accumulates sign * left * right into result.
+void AccumulateProduct(const MatExprNode &product, double sign,
+                       Eigen::MatrixXd &result, ThreadPool &pool) {
+    std::vector<Eigen::MatrixXd> scratch;
+    scratch.reserve(2);
+    const SumOperand left =
+        MakeProductOperand(*product.left, sign, scratch, pool);
+    const SumOperand right =
+        MakeProductOperand(*product.right, 1.0, scratch, pool);
+
+    const Eigen::Index m = product.rows;
+    const Eigen::Index n = product.cols;
+    const Eigen::Index k = product.left->cols;
+    double *c = result.data();
+    const Eigen::Index ldc = result.outerStride();
+
+    // a lone unsigned matrix skips the per-element sum loop when packing
+    auto plain = [](const SumOperand &operand) {
+        return operand.data.size() == 1 && operand.signs[0] > 0;
+    };
+    auto strided = [](const SumOperand &operand) {
+        return ColMajorOperand(operand.data[0], operand.ld);
+    };
+
+    if (plain(left) && plain(right)) {
+        GemmParallelOperands(pool, m, n, k, strided(left), strided(right), c,
+                             ldc);
+    } else if (plain(left)) {
+        GemmParallelOperands(pool, m, n, k, strided(left), right, c, ldc);
+    } else if (plain(right)) {
+        GemmParallelOperands(pool, m, n, k, left, strided(right), c, ldc);
+    } else {
+        GemmParallelOperands(pool, m, n, k, left, right, c, ldc);
+    }
+} // AccumulateProduct
+
+//! Evaluates an expression tree into result.
+/*!
+  \param node the root of the tree
+  \param result the output, resized to fit
+  \param pool the threads used by products
+ */
+void EvaluateMatExprInto(const MatExprNode &node, Eigen::MatrixXd &result,
+                         ThreadPool &pool) {
+    std::vector<MatExprTerm> terms;
+    FlattenMatExprSum(node, 1.0, terms);
+
+    std::vector<MatExprTerm> matrices;
+    std::vector<MatExprTerm> products;
+    for (const MatExprTerm &term : terms) {
+        if (term.node->kind == MatExprKind::kMatrix) {
+            matrices.push_back(term);
+        } else {
+            products.push_back(term);
+        }
+    }
+
+    result.resize(node.rows, node.cols);
+    if (matrices.empty()) {
+        result.setZero();
+    } else {
+        FusedSumInto(matrices, result.data());
+    }
+
+    for (const MatExprTerm &product : products) {
+        AccumulateProduct(*product.node, product.sign, result, pool);
+    }
+} // EvaluateMatExprInto
+
+//! Evaluates an expression with the custom kernels.
+/*!
+  \param expr the expression
+  \param thread_count threads used by products, 0 for one per hardware thread
+  \return The value of the expression
+ */
+Eigen::MatrixXd EvaluateMatExpr(const MatExpr &expr,
+                                unsigned int thread_count = 0) {
+    ThreadPool pool(thread_count);
+    Eigen::MatrixXd result;
+
+    EvaluateMatExprInto(expr.GetNode(), result, pool);
+
+    return result;
+} // EvaluateMatExpr
+
+//! Class that parses the text syntax of matrix expressions.
+/*!
+  The grammar is the usual one, with * binding tighter than + and -:
+
+      expr   := term (('+' | '-') term)*
+      term   := factor ('*' factor)*
+      factor := NAME | '(' expr ')'
+
+  Names are letters, digits and underscores, not starting with a digit.
+ */
+class MatExprParser {
+  public:
+    //! Prepares to parse text against a table of named matrices.
+    /*!
+      \param text the expression
+      \param matrices the matrices names refer to; they must outlive the
+                      parsed expression
+     */
+    MatExprParser(const std::string &text,
+                  const std::map<std::string, Eigen::MatrixXd> &matrices)
+        : text_(text), matrices_(matrices) {}
+
+    //! Parses the whole text, throwing std::runtime_error on a syntax error,
+    //! an unknown name or mismatched shapes.
+    MatExpr Parse() {
+        MatExpr expr = ParseSum();
+
+        SkipSpaces();
+        if (position_ < text_.size()) {
+            Fail("unexpected '" + std::string(1, text_[position_]) + "'");
+        }
+
+        return expr;
+    } // Parse
+
+  private:
+    MatExpr ParseSum() {
+        MatExpr expr = ParseTerm();
+
+        while (true) {
+            SkipSpaces();
+            if (Accept('+')) {
+                expr = Checked([&] { return expr + ParseTerm(); });
+            } else if (Accept('-')) {
+                expr = Checked([&] { return expr - ParseTerm(); });
+            } else {
+                return expr;
+            }
+        }
+    } // ParseSum
+
+    MatExpr ParseTerm() {
+        MatExpr expr = ParseFactor();
+
+        while (true) {
+            SkipSpaces();
+            if (Accept('*')) {
+                expr = Checked([&] { return expr * ParseFactor(); });
+            } else {
+                return expr;
+            }
+        }
+    } // ParseTerm
+
+    MatExpr ParseFactor() {
+        SkipSpaces();
+        if (Accept('(')) {
+            MatExpr expr = ParseSum();
+            SkipSpaces();
+            if (!Accept(')')) {
+                Fail("expected ')'");
+            }
+            return expr;
+        }
+
+        const std::size_t start = position_;
+        while (position_ < text_.size() &&
+               (std::isalnum(static_cast<unsigned char>(text_[position_])) ||
+                text_[position_] == '_')) {
+            position_++;
+        }
+
+        if (start == position_ ||
+                std::isdigit(static_cast<unsigned char>(text_[start]))) {
+            position_ = start;
+            Fail("expected a matrix name or '('");
+        }
+
+        const std::string name = text_.substr(start, position_ - start);
+        const auto found = matrices_.find(name);
+        if (found == matrices_.end()) {
+            position_ = start;
+            Fail("unknown matrix '" + name + "'");
+        }
+
+        return MatExpr(found->second);
+    } // ParseFactor
+
+    //! Runs an operator, reporting a shape mismatch at the operator.
+    template <typename Operation>
+    MatExpr Checked(Operation operation) {
+        const std::size_t operator_position = position_ - 1;
+        try {
+            return operation();
+        } catch (const std::runtime_error &error) {
+            if (error_raised_) {
+                throw;
+            }
+            position_ = operator_position;
+            Fail(error.what());
+        }
+    } // Checked
+
+    void SkipSpaces() {
+        while (position_ < text_.size() &&
+               std::isspace(static_cast<unsigned char>(text_[position_]))) {
+            position_++;
+        }
+    } // SkipSpaces
+
+    bool Accept(char expected) {
+        if (position_ < text_.size() && text_[position_] == expected) {
+            position_++;
+            return true;
+        }
+        return false;
+    } // Accept
+
+    [[noreturn]] void Fail(const std::string &message) {
+        error_raised_ = true;
+        throw std::runtime_error("expression column " +
+                                 std::to_string(position_ + 1) + ": " +
+                                 message);
+    } // Fail
+
+    const std::string &text_;
+    const std::map<std::string, Eigen::MatrixXd> &matrices_;
+    std::size_t position_ = 0;
+    bool error_raised_ = false;
+};
+
+//! Parses text into an expression over named matrices.
+MatExpr ParseMatExpr(const std::string &text,
+                     const std::map<std::string, Eigen::MatrixXd> &matrices) {
+    return MatExprParser(text, matrices).Parse();
+} // ParseMatExpr
+
+#endif
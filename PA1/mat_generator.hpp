@@ -0,0 +1,421 @@
+#ifndef MAT_GENERATOR_H_
+#define MAT_GENERATOR_H_
+
+//!  Deterministic pattern matrices generated in parallel straight to disk.
+/*!
+  \file mat_generator.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Every element is a pure function of the pattern, the seed and its (row,
+  col) position: random values come from hashing the position with a
+  counter-based mixer instead of advancing a shared generator. Any thread
+  can therefore produce any run of elements, the output does not depend on
+  the thread count, and no more than two bands of the matrix are ever held
+  in memory, so fixtures far larger than RAM can be written.
+
+  Bands are runs of elements in file order, column-major for the binary
+  format and row-major for text. Each band is split across the pool while
+  the previous band is written, so formatting and disk writes overlap.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./mat_stream.hpp"
+#include "./mat_text_writer.hpp"
+#include "./thread_pool.hpp"
+
+//! Elements generated per band; each of the two in-flight bands holds this
+//! many doubles, or their text.
+const std::uint64_t kGeneratorBandElements = 1 << 20;
+
+//! Salt for the hash that picks the nonzeros of a sparse pattern.
+const std::uint64_t kGeneratorMaskSalt = 0x6a09e667f3bcc908ULL;
+//! Salt for the hash that picks element values.
+const std::uint64_t kGeneratorValueSalt = 0xbb67ae8584caa73bULL;
+
+//! How element values are chosen.
+enum class MatPattern {
+    //! start + step * index, counting along rows or down columns.
+    kCounter,
+    //! Uniform in [low, high).
+    kRandom,
+    //! Uniform in [low, high) within bandwidth of the diagonal, else zero.
+    kBanded,
+    //! Uniform in [low, high) with probability density, else zero.
+    kSparse,
+};
+
+//! Everything that determines a generated matrix.
+struct MatGeneratorSpec {
+    //! The value pattern.
+    MatPattern pattern = MatPattern::kCounter;
+    //! Number of rows.
+    Eigen::Index rows = 0;
+    //! Number of columns.
+    Eigen::Index cols = 0;
+    //! Seed of the random patterns.
+    std::uint64_t seed = 0;
+    //! First value of the counter pattern.
+    double start = 1.0;
+    //! Increment of the counter pattern.
+    double step = 1.0;
+    //! Whether the counter counts down columns instead of along rows.
+    bool column_order = false;
+    //! Lower bound of random values.
+    double low = -1.0;
+    //! Upper bound of random values.
+    double high = 1.0;
+    //! Largest |row - col| of a banded pattern's nonzeros.
+    Eigen::Index bandwidth = 0;
+    //! Fraction of a sparse pattern's elements that are nonzero.
+    double density = 0.01;
+};
+
+
+//! Parses a pattern name: counter, random, banded or sparse.
+/*!
+  \param name the pattern name
+  \return The pattern
+ */
+MatPattern ParseMatPattern(const std::string &name) {
+    if (name == "counter") {
+        return MatPattern::kCounter;
+    }
+    if (name == "random") {
+        return MatPattern::kRandom;
+    }
+    if (name == "banded") {
+        return MatPattern::kBanded;
+    }
+    if (name == "sparse") {
+        return MatPattern::kSparse;
+    }
+
+    throw std::runtime_error("unknown pattern \"" + name +
+                             "\"; expected counter, random, banded or sparse");
+} // ParseMatPattern
+
+//! Throws if spec describes no valid matrix.
+void CheckMatGeneratorSpec(const MatGeneratorSpec &spec) {
+    if (spec.rows < 0 || spec.cols < 0) {
+        throw std::runtime_error("matrix dimensions must not be negative");
+    }
+    if (!(spec.low <= spec.high)) {
+        throw std::runtime_error("random range must have low <= high");
+    }
+    if (spec.bandwidth < 0) {
+        throw std::runtime_error("bandwidth must not be negative");
+    }
+    if (!(spec.density >= 0.0 && spec.density <= 1.0)) {
+        throw std::runtime_error("density must be between 0 and 1");
+    }
+} // CheckMatGeneratorSpec
+
+//! Scrambles 64 bits; the finalizer of the SplitMix64 generator.
+std::uint64_t MixBits(std::uint64_t bits) {
+    bits += 0x9e3779b97f4a7c15ULL;
+    bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    bits = (bits ^ (bits >> 27)) * 0x94d049bb133111ebULL;
+    return bits ^ (bits >> 31);
+} // MixBits
+
+//! Returns a uniform double in [0, 1) determined by seed, position and salt.
+double HashToUnit(std::uint64_t seed, std::uint64_t salt, Eigen::Index row,
+                  Eigen::Index col) {
+    std::uint64_t bits = MixBits(seed ^ salt);
+    bits = MixBits(bits + static_cast<std::uint64_t>(row));
+    bits = MixBits(bits + static_cast<std::uint64_t>(col));
+
+    // the top 53 bits fill a double's mantissa exactly
+    return static_cast<double>(bits >> 11) * 0x1.0p-53;
+} // HashToUnit
+
+//! Returns element (row, col) of the matrix spec describes.
+double GenerateMatElement(const MatGeneratorSpec &spec, Eigen::Index row,
+                          Eigen::Index col) {
+    const auto random_value = [&] {
+        return spec.low + (spec.high - spec.low) *
+            HashToUnit(spec.seed, kGeneratorValueSalt, row, col);
+    };
+
+    switch (spec.pattern) {
+        case MatPattern::kCounter: {
+            const Eigen::Index index = spec.column_order
+                ? row + col * spec.rows
+                : row * spec.cols + col;
+            return spec.start + spec.step * static_cast<double>(index);
+        }
+        case MatPattern::kRandom:
+            return random_value();
+        case MatPattern::kBanded:
+            return std::abs(row - col) <= spec.bandwidth ? random_value()
+                                                         : 0.0;
+        case MatPattern::kSparse:
+            return HashToUnit(spec.seed, kGeneratorMaskSalt, row, col) <
+                    spec.density
+                ? random_value()
+                : 0.0;
+    }
+
+    return 0.0;
+} // GenerateMatElement
+
+//! Generates the whole matrix in memory.
+/*!
+  \param spec the matrix to generate
+  \return The matrix
+ */
+Eigen::MatrixXd GenerateMat(const MatGeneratorSpec &spec) {
+    CheckMatGeneratorSpec(spec);
+
+    Eigen::MatrixXd mat(spec.rows, spec.cols);
+    for (Eigen::Index col = 0; col < spec.cols; col++) {
+        for (Eigen::Index row = 0; row < spec.rows; row++) {
+            mat(row, col) = GenerateMatElement(spec, row, col);
+        }
+    }
+
+    return mat;
+} // GenerateMat
+
+//! Waits for a band's fills, then writes it.
+/*!
+  On error every fill still queued, of this band or the next, is allowed to
+  finish before the exception leaves, so none outlives its slot.
+  \param tasks the fills of the band to write
+  \param next_tasks the fills of the band after it
+  \param write consumes a band
+  \param slot the slot tasks fill
+ */
+void FinishMatBand(std::vector<std::future<void>> &tasks,
+                   std::vector<std::future<void>> &next_tasks,
+                   const std::function<void(int)> &write, int slot) {
+    try {
+        for (std::future<void> &task : tasks) {
+            task.get();
+        }
+        if (!tasks.empty()) {
+            write(slot);
+        }
+    } catch (...) {
+        for (std::future<void> &task : tasks) {
+            if (task.valid()) {
+                task.wait();
+            }
+        }
+        for (std::future<void> &task : next_tasks) {
+            task.wait();
+        }
+        throw;
+    }
+} // FinishMatBand
+
+//! Runs element_count elements through two slots, band by band.
+/*!
+  fill(slot, part, first, count) produces elements [first, first + count)
+  into slot; each band is split into one part per pool thread. write(slot)
+  consumes a filled slot and runs on the calling thread while the pool
+  fills the other slot with the next band.
+  \param element_count the number of elements to produce
+  \param pool the threads that fill bands
+  \param fill produces a run of elements; called concurrently
+  \param write consumes a band; called in order
+ */
+void PipelineMatBands(
+        std::uint64_t element_count, ThreadPool &pool,
+        const std::function<void(int, unsigned int, std::uint64_t,
+                                 std::uint64_t)> &fill,
+        const std::function<void(int)> &write) {
+    const unsigned int kParts = pool.GetThreadCount();
+    std::vector<std::future<void>> tasks;
+    int slot = 0;
+
+    for (std::uint64_t band_first = 0; band_first < element_count;
+            band_first += kGeneratorBandElements) {
+        const std::uint64_t band_count =
+            std::min(kGeneratorBandElements, element_count - band_first);
+        const std::uint64_t part_count = (band_count + kParts - 1) / kParts;
+
+        std::vector<std::future<void>> next_tasks;
+        for (unsigned int part = 0; part < kParts; part++) {
+            const std::uint64_t first =
+                std::min(band_first + part * part_count,
+                         band_first + band_count);
+            const std::uint64_t count = std::min(
+                part_count, band_first + band_count - first);
+            next_tasks.push_back(pool.Submit([&fill, slot, part, first,
+                                              count] {
+                fill(slot, part, first, count);
+            }));
+        }
+
+        // write the previous band while this one is being filled
+        FinishMatBand(tasks, next_tasks, write, 1 - slot);
+        tasks.swap(next_tasks);
+        slot = 1 - slot;
+    }
+
+    std::vector<std::future<void>> no_tasks;
+    FinishMatBand(tasks, no_tasks, write, 1 - slot);
+} // PipelineMatBands
+
+//! Returns how many elements a spec'd matrix has.
+std::uint64_t CountMatElements(const MatGeneratorSpec &spec) {
+    return static_cast<std::uint64_t>(spec.rows) *
+           static_cast<std::uint64_t>(spec.cols);
+} // CountMatElements
+
+//! Generates a matrix straight into a binary matrix file.
+/*!
+  \param spec the matrix to generate
+  \param write_file_path the path of the output file
+  \param thread_count threads filling bands, 0 for one per hardware thread
+ */
+void GenerateMatFileBinary(const MatGeneratorSpec &spec,
+                           const std::string &write_file_path,
+                           unsigned int thread_count = 0) {
+    CheckMatGeneratorSpec(spec);
+
+    ThreadPool pool(thread_count);
+    MatBinaryStreamWriter writer(write_file_path, spec.rows, spec.cols);
+    std::vector<std::vector<double>> parts[2];
+    parts[0].resize(pool.GetThreadCount());
+    parts[1].resize(pool.GetThreadCount());
+
+    // binary files are column-major, so index walks down each column
+    const auto fill = [&](int slot, unsigned int part, std::uint64_t first,
+                          std::uint64_t count) {
+        std::vector<double> &out = parts[slot][part];
+        out.resize(count);
+
+        for (std::uint64_t offset = 0; offset < count; offset++) {
+            const std::uint64_t index = first + offset;
+            out[offset] = GenerateMatElement(
+                spec, static_cast<Eigen::Index>(index % spec.rows),
+                static_cast<Eigen::Index>(index / spec.rows));
+        }
+    };
+    const auto write = [&](int slot) {
+        for (const std::vector<double> &part : parts[slot]) {
+            writer.WriteElements(part.data(), part.size());
+        }
+    };
+
+    PipelineMatBands(CountMatElements(spec), pool, fill, write);
+    writer.Close();
+} // GenerateMatFileBinary
+
+//! Finds the kEigenAligned column width of a generated matrix.
+/*!
+  Elements are cheap to regenerate, so this formats every one of them in
+  parallel instead of keeping the matrix around.
+  \param spec the matrix to measure
+  \param pool the threads to measure with
+  \return The width Eigen's operator<< would pad every element to
+ */
+std::size_t FindGeneratedWidth(const MatGeneratorSpec &spec,
+                               ThreadPool &pool) {
+    const std::uint64_t kElementCount = CountMatElements(spec);
+    const std::uint64_t kParts = pool.GetThreadCount();
+    const std::uint64_t kPartCount = (kElementCount + kParts - 1) / kParts;
+    std::vector<std::future<std::size_t>> tasks;
+
+    for (std::uint64_t first = 0; first < kElementCount;
+            first += kPartCount) {
+        const std::uint64_t count = std::min(kPartCount,
+                                             kElementCount - first);
+        tasks.push_back(pool.Submit([&spec, first, count] {
+            char scratch[kMatMaxNumberLength];
+            std::size_t width = 0;
+
+            for (std::uint64_t index = first; index < first + count;
+                    index++) {
+                width = std::max(width, FormatStreamDefault(
+                    GenerateMatElement(
+                        spec, static_cast<Eigen::Index>(index % spec.rows),
+                        static_cast<Eigen::Index>(index / spec.rows)),
+                    scratch));
+            }
+
+            return width;
+        }));
+    }
+
+    std::size_t width = 0;
+    for (std::future<std::size_t> &task : tasks) {
+        width = std::max(width, task.get());
+    }
+
+    return width;
+} // FindGeneratedWidth
+
+//! Generates a matrix straight into a text matrix file.
+/*!
+  \param spec the matrix to generate
+  \param write_file_path the path of the output file
+  \param format the element layout; kEigenAligned generates every element
+                twice, once to find the column width
+  \param thread_count threads formatting bands, 0 for one per hardware
+                      thread
+ */
+void GenerateMatFileText(const MatGeneratorSpec &spec,
+                         const std::string &write_file_path,
+                         MatTextFormat format = MatTextFormat::kCompact,
+                         unsigned int thread_count = 0) {
+    CheckMatGeneratorSpec(spec);
+
+    ThreadPool pool(thread_count);
+    const std::size_t kWidth = format == MatTextFormat::kEigenAligned
+        ? FindGeneratedWidth(spec, pool)
+        : 0;
+
+    MatTextWriter writer(write_file_path);
+    WriteMatTextHeader(spec.rows, spec.cols, writer);
+    std::vector<std::string> parts[2];
+    parts[0].resize(pool.GetThreadCount());
+    parts[1].resize(pool.GetThreadCount());
+
+    // text files are row-major, so index walks along each row
+    const auto fill = [&](int slot, unsigned int part, std::uint64_t first,
+                          std::uint64_t count) {
+        std::string &out = parts[slot][part];
+        out.clear();
+        char element[kMatMaxElementLength];
+
+        for (std::uint64_t index = first; index < first + count; index++) {
+            const Eigen::Index row =
+                static_cast<Eigen::Index>(index / spec.cols);
+            const Eigen::Index col =
+                static_cast<Eigen::Index>(index % spec.cols);
+
+            if (col == 0 && row > 0) {
+                out.push_back('\n');
+            }
+            out.append(element, FormatMatTextElement(
+                GenerateMatElement(spec, row, col), col, kWidth, format,
+                element));
+        }
+    };
+    const auto write = [&](int slot) {
+        for (const std::string &part : parts[slot]) {
+            writer.Append(part.data(), part.size());
+        }
+    };
+
+    // like Eigen, an empty matrix has no body at all
+    PipelineMatBands(CountMatElements(spec), pool, fill, write);
+    writer.Close();
+} // GenerateMatFileText
+
+#endif
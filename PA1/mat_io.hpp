@@ -0,0 +1,1105 @@
+#ifndef MAT_IO_H_
+#define MAT_IO_H_
+
+//!  Reading and writing PA1 matrix files in the text and binary formats.
+/*!
+  \file mat_io.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  The text format is a "rows cols" line, a blank line and then the elements
+  row by row, as written by Eigen's stream operator.
+
+  The binary format is a fixed 64 byte header followed by rows * cols little
+  endian doubles in column-major order, which is exactly Eigen's default
+  storage, or in row-major order when the header's kBinaryMatRowMajorFlag is
+  set. Because the header is 64 bytes the data starts cache line aligned,
+  so a memory mapped file can be handed to Eigen without any copy. Files are
+  read and written in whichever order they are stored in; converting
+  between orders goes through the cache-oblivious kernels in transpose.hpp.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./compressed_mat.hpp"
+#include "./mat_text_writer.hpp"
+#include "./sparse_mat.hpp"
+#include "./transpose.hpp"
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "the binary matrix format is stored little endian");
+
+//! Magic bytes at the start of every binary matrix file.
+const char kBinaryMatMagic[8] = {'P', 'A', '1', 'M', 'A', 'T', '\0', '\0'};
+
+//! The binary format version written for column-major files.
+const std::uint32_t kBinaryMatVersion = 1;
+
+//! The first version with a meaningful flags field. Only files that need a
+//! flag are written with it, so column-major files stay readable by
+//! version 1 readers, which would misread row-major data.
+const std::uint32_t kBinaryMatFlagsVersion = 2;
+
+//! Header flag: the elements are stored row by row.
+const std::uint32_t kBinaryMatRowMajorFlag = 1;
+
+//! Order in which a matrix's elements are stored.
+enum class MatLayout {
+    //! Column by column, Eigen's default.
+    kColMajor,
+    //! Row by row, the order of the text format.
+    kRowMajor
+};
+
+//! Size of the binary header, which is also the alignment of the data.
+const std::uint32_t kBinaryMatHeaderSize = 64;
+
+//! On-disk header of a binary matrix file.
+struct BinaryMatHeader {
+    //! Always kBinaryMatMagic.
+    char magic[8];
+    //! Format version, kBinaryMatVersion or kBinaryMatFlagsVersion.
+    std::uint32_t version;
+    //! Byte offset of the first element, at least sizeof(BinaryMatHeader).
+    std::uint32_t data_offset;
+    //! Number of rows.
+    std::uint64_t rows;
+    //! Number of columns.
+    std::uint64_t cols;
+    //! Size of one element in bytes, always sizeof(double).
+    std::uint32_t element_size;
+    //! kBinaryMatRowMajorFlag or zero; always zero in version 1.
+    std::uint32_t flags;
+    //! Pads the header out to kBinaryMatHeaderSize.
+    std::uint8_t reserved[24];
+};
+
+static_assert(sizeof(BinaryMatHeader) == kBinaryMatHeaderSize,
+              "BinaryMatHeader must match the on-disk header size");
+
+
+//! Checks whether the file at read_file_path starts with the binary magic.
+/*!
+  \param read_file_path the path of the file
+  \return Whether the file is a binary matrix file
+ */
+bool IsBinaryMatFile(const std::string &read_file_path) {
+    std::ifstream read_file(read_file_path, std::ios::binary);
+    char magic[sizeof(kBinaryMatMagic)] = {};
+    read_file.read(magic, sizeof(magic));
+
+    return read_file.gcount() == sizeof(magic) &&
+           std::memcmp(magic, kBinaryMatMagic, sizeof(magic)) == 0;
+} // IsBinaryMatFile
+
+//! Validates a binary header against the size of the file holding it.
+/*!
+  \param header the header read from the file
+  \param file_size the size of the whole file in bytes
+  \param file_path the path of the file, used in error messages
+ */
+void CheckBinaryMatHeader(const BinaryMatHeader &header,
+                          std::uint64_t file_size,
+                          const std::string &file_path) {
+    if (std::memcmp(header.magic, kBinaryMatMagic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error(file_path + ": not a binary matrix file");
+    }
+    if (header.version != kBinaryMatVersion &&
+            header.version != kBinaryMatFlagsVersion) {
+        throw std::runtime_error(file_path + ": unsupported binary version " +
+                                 std::to_string(header.version));
+    }
+    if ((header.version == kBinaryMatVersion && header.flags != 0) ||
+            (header.flags & ~kBinaryMatRowMajorFlag) != 0) {
+        throw std::runtime_error(file_path + ": unknown binary header flags");
+    }
+    if (header.element_size != sizeof(double) ||
+            header.data_offset < sizeof(BinaryMatHeader) ||
+            header.data_offset % alignof(double) != 0) {
+        throw std::runtime_error(file_path + ": malformed binary header");
+    }
+    if (header.cols != 0 && header.rows > UINT64_MAX / header.cols /
+                                          sizeof(double)) {
+        throw std::runtime_error(file_path + ": matrix dimensions overflow");
+    }
+
+    const std::uint64_t data_size = header.rows * header.cols * sizeof(double);
+    if (file_size < header.data_offset ||
+            file_size - header.data_offset < data_size) {
+        throw std::runtime_error(file_path + ": binary file is truncated");
+    }
+} // CheckBinaryMatHeader
+
+//! Returns the storage order a binary header describes.
+MatLayout GetBinaryMatLayout(const BinaryMatHeader &header) {
+    return (header.flags & kBinaryMatRowMajorFlag) != 0 ? MatLayout::kRowMajor
+                                                        : MatLayout::kColMajor;
+} // GetBinaryMatLayout
+
+//! Class holding a read-only memory mapping of a whole file.
+class MappedFile {
+  public:
+    //! Maps the file at read_file_path.
+    /*!
+      \param read_file_path the path of the file
+     */
+    explicit MappedFile(const std::string &read_file_path) {
+        int descriptor = open(read_file_path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error(read_file_path + ": cannot open file");
+        }
+
+        struct stat file_stat;
+        if (fstat(descriptor, &file_stat) != 0) {
+            close(descriptor);
+            throw std::runtime_error(read_file_path + ": cannot stat file");
+        }
+
+        // mmap rejects empty ranges, and an empty file needs no mapping
+        size_ = static_cast<std::size_t>(file_stat.st_size);
+        if (size_ > 0) {
+            void *mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE,
+                                 descriptor, 0);
+            if (mapping == MAP_FAILED) {
+                close(descriptor);
+                throw std::runtime_error(read_file_path + ": mmap failed");
+            }
+
+            data_ = static_cast<const char *>(mapping);
+
+            // files are read front to back by every caller
+            madvise(mapping, size_, MADV_SEQUENTIAL);
+        }
+
+        close(descriptor);
+    } // constructor
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    //! Unmaps the file.
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            munmap(const_cast<char *>(data_), size_);
+        }
+    } // destructor
+
+    //! Returns the first byte of the file, or nullptr when it is empty.
+    const char *GetData() const {
+        return data_;
+    } // GetData
+
+    //! Returns the size of the file in bytes.
+    std::size_t GetSize() const {
+        return size_;
+    } // GetSize
+
+  private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+//! Class giving read-only, zero-copy access to a memory mapped binary file.
+class MappedMatFile {
+  public:
+    //! Maps the binary matrix file at read_file_path.
+    /*!
+      \param read_file_path the path of the binary matrix file
+     */
+    explicit MappedMatFile(const std::string &read_file_path)
+        : file_(read_file_path) {
+        if (file_.GetSize() < sizeof(BinaryMatHeader)) {
+            throw std::runtime_error(read_file_path +
+                                     ": too small for a binary matrix file");
+        }
+
+        std::memcpy(&header_, file_.GetData(), sizeof(header_));
+        CheckBinaryMatHeader(header_, file_.GetSize(), read_file_path);
+    } // constructor
+
+    //! Returns the storage order of the file's elements.
+    MatLayout GetLayout() const {
+        return GetBinaryMatLayout(header_);
+    } // GetLayout
+
+    //! Returns a column-major file's contents without copying.
+    /*!
+      \return A read-only Map that is valid for the lifetime of this object
+      \throws std::runtime_error if the file is stored row-major
+     */
+    Eigen::Map<const Eigen::MatrixXd> GetMatrix() const {
+        if (GetLayout() != MatLayout::kColMajor) {
+            throw std::runtime_error("binary matrix is stored row-major");
+        }
+
+        return Eigen::Map<const Eigen::MatrixXd>(
+            GetData(), static_cast<Eigen::Index>(header_.rows),
+            static_cast<Eigen::Index>(header_.cols));
+    } // GetMatrix
+
+    //! Returns a row-major file's contents without copying.
+    /*!
+      \return A read-only Map that is valid for the lifetime of this object
+      \throws std::runtime_error if the file is stored column-major
+     */
+    Eigen::Map<const MatrixXdRowMajor> GetRowMajorMatrix() const {
+        if (GetLayout() != MatLayout::kRowMajor) {
+            throw std::runtime_error("binary matrix is stored column-major");
+        }
+
+        return Eigen::Map<const MatrixXdRowMajor>(
+            GetData(), static_cast<Eigen::Index>(header_.rows),
+            static_cast<Eigen::Index>(header_.cols));
+    } // GetRowMajorMatrix
+
+    //! Returns the header read from the file.
+    const BinaryMatHeader &GetHeader() const {
+        return header_;
+    } // GetHeader
+
+  private:
+    //! Returns the first element.
+    const double *GetData() const {
+        return reinterpret_cast<const double *>(file_.GetData() +
+                                                header_.data_offset);
+    } // GetData
+
+    MappedFile file_;
+    BinaryMatHeader header_;
+};
+
+//! Builds the header of a binary file for a rows x cols matrix.
+/*!
+  \param rows the number of rows
+  \param cols the number of columns
+  \param layout the order the elements will be written in
+  \return A header for the oldest format version that can describe it
+ */
+BinaryMatHeader MakeBinaryMatHeader(Eigen::Index rows, Eigen::Index cols,
+                                    MatLayout layout = MatLayout::kColMajor) {
+    BinaryMatHeader header = {};
+    std::memcpy(header.magic, kBinaryMatMagic, sizeof(header.magic));
+    if (layout == MatLayout::kRowMajor) {
+        header.version = kBinaryMatFlagsVersion;
+        header.flags = kBinaryMatRowMajorFlag;
+    } else {
+        header.version = kBinaryMatVersion;
+    }
+    header.data_offset = kBinaryMatHeaderSize;
+    header.rows = static_cast<std::uint64_t>(rows);
+    header.cols = static_cast<std::uint64_t>(cols);
+    header.element_size = sizeof(double);
+
+    return header;
+} // MakeBinaryMatHeader
+
+//! Writes a header and the elements that follow it to write_file_path.
+/*!
+  \param header the header, describing the elements' shape and order
+  \param data the elements in the header's order
+  \param write_file_path the path of the output file
+ */
+void WriteBinaryMatData(const BinaryMatHeader &header, const double *data,
+                        const std::string &write_file_path) {
+    std::ofstream mat_file(write_file_path, std::ios::binary);
+    if (!mat_file) {
+        throw std::runtime_error(write_file_path + ": cannot open for writing");
+    }
+
+    mat_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    mat_file.write(reinterpret_cast<const char *>(data),
+                   static_cast<std::streamsize>(header.rows * header.cols *
+                                                sizeof(double)));
+
+    if (!mat_file) {
+        throw std::runtime_error(write_file_path + ": write failed");
+    }
+} // WriteBinaryMatData
+
+//! Writes a matrix to write_file_path in the binary format.
+/*!
+  \param mat the matrix to write
+  \param write_file_path the path of the output file
+ */
+void WriteMatFileBinary(const Eigen::MatrixXd &mat,
+                        const std::string &write_file_path) {
+    WriteBinaryMatData(MakeBinaryMatHeader(mat.rows(), mat.cols()),
+                       mat.data(), write_file_path);
+} // WriteMatFileBinary
+
+//! Writes a row-major matrix to write_file_path in the binary format, as
+//! stored, with the header's row-major flag set.
+/*!
+  \param mat the matrix to write
+  \param write_file_path the path of the output file
+ */
+void WriteMatFileBinary(const MatrixXdRowMajor &mat,
+                        const std::string &write_file_path) {
+    WriteBinaryMatData(MakeBinaryMatHeader(mat.rows(), mat.cols(),
+                                           MatLayout::kRowMajor),
+                       mat.data(), write_file_path);
+} // WriteMatFileBinary
+
+//! Error thrown for malformed text matrix files, with a 1-based position.
+class MatParseError : public std::runtime_error {
+  public:
+    //! Builds a "path:line:column: message" error.
+    /*!
+      \param file_path the path of the file being parsed
+      \param line the line of the offending character
+      \param column the column of the offending character
+      \param message what went wrong
+     */
+    MatParseError(const std::string &file_path, std::size_t line,
+                  std::size_t column, const std::string &message)
+        : std::runtime_error(file_path + ":" + std::to_string(line) + ":" +
+                             std::to_string(column) + ": " + message),
+          line_(line), column_(column) {} // constructor
+
+    //! Returns the line of the error.
+    std::size_t GetLine() const {
+        return line_;
+    } // GetLine
+
+    //! Returns the column of the error.
+    std::size_t GetColumn() const {
+        return column_;
+    } // GetColumn
+
+  private:
+    std::size_t line_;
+    std::size_t column_;
+};
+
+//! Class that tokenizes a text matrix held in memory without allocating.
+/*!
+  The cursor can also walk a file through a sliding window: Rebase points it
+  at the next window while line and column counting carries on.
+ */
+class MatTextCursor {
+  public:
+    //! Starts a cursor at the beginning of a buffer.
+    /*!
+      \param begin the first byte of the buffer
+      \param end one past the last byte of the buffer
+      \param file_path the path reported in errors
+      \param end_is_eof whether the buffer ends where the file ends
+     */
+    MatTextCursor(const char *begin, const char *end,
+                  const std::string &file_path, bool end_is_eof = true)
+        : begin_(begin), position_(begin), end_(end), end_is_eof_(end_is_eof),
+          file_path_(file_path) {} // constructor
+
+    //! Moves the cursor onto a new window of the same file.
+    /*!
+      The unread bytes of the old window must be the first bytes of the new
+      one, so the file offset of position_ is unchanged.
+      \param begin the first byte of the new window, at the current position
+      \param end one past the last byte of the new window
+      \param end_is_eof whether the new window ends where the file ends
+     */
+    void Rebase(const char *begin, const char *end, bool end_is_eof) {
+        begin_offset_ += static_cast<std::size_t>(position_ - begin_);
+        begin_ = begin;
+        position_ = begin;
+        end_ = end;
+        end_is_eof_ = end_is_eof;
+    } // Rebase
+
+    //! Tells the cursor that position_ is partway through a file.
+    /*!
+      Used by readers that reopen a file where an earlier cursor stopped, so
+      errors still report the right line and column.
+      \param offset the file offset of position_
+      \param line the line number at that offset
+      \param line_start_offset the file offset where that line starts
+     */
+    void Resume(std::size_t offset, std::size_t line,
+                std::size_t line_start_offset) {
+        begin_offset_ = offset - static_cast<std::size_t>(position_ - begin_);
+        line_ = line;
+        line_start_offset_ = line_start_offset;
+    } // Resume
+
+    //! Returns the file offset of position_.
+    std::size_t GetOffset() const {
+        return begin_offset_ + static_cast<std::size_t>(position_ - begin_);
+    } // GetOffset
+
+    //! Returns the line number of position_, starting at 1.
+    std::size_t GetLine() const {
+        return line_;
+    } // GetLine
+
+    //! Returns the file offset where the current line starts.
+    std::size_t GetLineStartOffset() const {
+        return line_start_offset_;
+    } // GetLineStartOffset
+
+    //! Returns the first unread byte.
+    const char *GetPosition() const {
+        return position_;
+    } // GetPosition
+
+    //! Returns the number of unread bytes in the window.
+    std::size_t GetRemaining() const {
+        return static_cast<std::size_t>(end_ - position_);
+    } // GetRemaining
+
+    //! Skips spaces, tabs and line breaks, counting lines as it goes.
+    void SkipWhitespace() {
+        while (position_ != end_) {
+            if (*position_ == '\n') {
+                line_++;
+                line_start_offset_ = GetOffset() + 1;
+            } else if (*position_ != ' ' && *position_ != '\t' &&
+                           *position_ != '\r') {
+                return;
+            }
+            position_++;
+        }
+    } // SkipWhitespace
+
+    //! Parses the next token as a non-negative integer dimension.
+    /*!
+      \param name what the value is, used in errors
+      \return The parsed dimension
+     */
+    Eigen::Index ParseDimension(const char *name) {
+        SkipWhitespace();
+        long long value = 0;
+        std::from_chars_result result =
+            std::from_chars(position_, end_, value);
+
+        CheckToken(result.ec, result.ptr, name);
+        if (value < 0) {
+            Fail(std::string("negative ") + name);
+        }
+
+        position_ = result.ptr;
+        return static_cast<Eigen::Index>(value);
+    } // ParseDimension
+
+    //! Parses the next token as a double.
+    /*!
+      \return The parsed value
+     */
+    double ParseElement() {
+        SkipWhitespace();
+        double value = 0.0;
+        std::from_chars_result result =
+            std::from_chars(position_, end_, value);
+
+        CheckToken(result.ec, result.ptr, "matrix element");
+
+        position_ = result.ptr;
+        return value;
+    } // ParseElement
+
+    //! Skips whole lines that start with '%', as comments.
+    void SkipCommentLines() {
+        SkipWhitespace();
+        while (position_ != end_ && *position_ == '%') {
+            while (position_ != end_ && *position_ != '\n') {
+                position_++;
+            }
+            SkipWhitespace();
+        }
+    } // SkipCommentLines
+
+    //! Fails unless count more tokens could fit in the rest of the text.
+    /*!
+      Called before allocating for a count read from a header, so a corrupt
+      or hostile header is reported instead of ending in std::bad_alloc.
+      Only checked when the window ends at the end of the file.
+      \param count the number of tokens still expected
+      \param min_bytes the fewest bytes one token and its separator take
+      \param name what the tokens are, used in errors
+     */
+    void ExpectTokensFit(Eigen::Index count, std::size_t min_bytes,
+                         const char *name) {
+        // the last token needs no separator after it
+        if (end_is_eof_ && count > 0 &&
+                static_cast<std::uint64_t>(count) >
+                    (GetRemaining() + 1) / min_bytes) {
+            Fail(std::string("file is too short for its ") + name);
+        }
+    } // ExpectTokensFit
+
+    //! Fails unless the elements of a rows x cols matrix can be counted and
+    //! could fit in the rest of the text.
+    /*!
+      \param rows the number of rows
+      \param cols the number of columns
+     */
+    void ExpectElementsFit(Eigen::Index rows, Eigen::Index cols) {
+        if (cols != 0 &&
+                rows > std::numeric_limits<Eigen::Index>::max() / cols) {
+            Fail("matrix dimensions overflow");
+        }
+
+        // a one-character element and one separator
+        ExpectTokensFit(rows * cols, 2, "matrix elements");
+    } // ExpectElementsFit
+
+    //! Fails unless only whitespace is left.
+    void ExpectEnd() {
+        SkipWhitespace();
+        if (position_ != end_) {
+            Fail("unexpected data after the last element");
+        }
+    } // ExpectEnd
+
+    //! Throws a MatParseError at the current position.
+    [[noreturn]] void Fail(const std::string &message) const {
+        throw MatParseError(file_path_, line_,
+                            GetOffset() - line_start_offset_ + 1, message);
+    } // Fail
+
+  private:
+    //! Checks a from_chars result and that the token ends at whitespace.
+    void CheckToken(std::errc error, const char *token_end, const char *name) {
+        if (position_ == end_) {
+            Fail(std::string("unexpected end of file, expected ") + name);
+        }
+        if (error == std::errc::result_out_of_range) {
+            Fail(std::string(name) + " is out of range");
+        }
+        if (token_end == end_ && !end_is_eof_) {
+            Fail(std::string(name) + " is too long");
+        }
+        if (error != std::errc() ||
+                (token_end != end_ && *token_end != ' ' &&
+                 *token_end != '\t' && *token_end != '\r' &&
+                 *token_end != '\n')) {
+            Fail(std::string("malformed ") + name);
+        }
+    } // CheckToken
+
+    const char *begin_;
+    const char *position_;
+    const char *end_;
+    bool end_is_eof_;
+    std::size_t begin_offset_ = 0;
+    std::size_t line_ = 1;
+    std::size_t line_start_offset_ = 0;
+    const std::string &file_path_;
+};
+
+//! Bytes of text rows parsed at once before being moved into column-major
+//! storage; small enough to stay in L2 while they are transposed.
+const std::size_t kMatParseBandBytes = std::size_t(256) << 10;
+
+//! Parses a text matrix held in memory.
+/*!
+  The text lists elements row by row, so storing each one straight into a
+  column-major matrix would write a whole column apart every time. Bands of
+  rows are parsed contiguously instead and transposed into place.
+  \param begin the first byte of the text
+  \param end one past the last byte of the text
+  \param file_path the path reported in errors
+  \return The parsed matrix
+ */
+Eigen::MatrixXd ParseMatText(const char *begin, const char *end,
+                             const std::string &file_path) {
+    MatTextCursor cursor(begin, end, file_path);
+
+    const Eigen::Index rows = cursor.ParseDimension("row count");
+    const Eigen::Index cols = cursor.ParseDimension("column count");
+    cursor.ExpectElementsFit(rows, cols);
+
+    Eigen::MatrixXd out_mat(rows, cols);
+    const Eigen::Index band_rows = std::max<Eigen::Index>(
+        kTransposeLeaf, static_cast<Eigen::Index>(
+            kMatParseBandBytes /
+            (sizeof(double) * std::max<Eigen::Index>(cols, 1))));
+    std::vector<double> band(
+        static_cast<std::size_t>(std::min(band_rows, rows) * cols));
+
+    for (Eigen::Index row = 0; row < rows; row += band_rows) {
+        const Eigen::Index count = std::min(band_rows, rows - row);
+        for (Eigen::Index index = 0; index < count * cols; index++) {
+            band[index] = cursor.ParseElement();
+        }
+
+        // the band is row-major, which is its transpose in column-major
+        TransposeBlock(band.data(), cols, out_mat.data() + row, rows, cols,
+                       count);
+    }
+
+    cursor.ExpectEnd();
+    return out_mat;
+} // ParseMatText
+
+//! Parses a text matrix held in memory into row-major storage, which takes
+//! the elements in exactly the order they are written.
+/*!
+  \param begin the first byte of the text
+  \param end one past the last byte of the text
+  \param file_path the path reported in errors
+  \return The parsed matrix
+ */
+MatrixXdRowMajor ParseMatTextRowMajor(const char *begin, const char *end,
+                                      const std::string &file_path) {
+    MatTextCursor cursor(begin, end, file_path);
+
+    const Eigen::Index rows = cursor.ParseDimension("row count");
+    const Eigen::Index cols = cursor.ParseDimension("column count");
+    cursor.ExpectElementsFit(rows, cols);
+
+    MatrixXdRowMajor out_mat(rows, cols);
+    double *out = out_mat.data();
+    for (Eigen::Index index = 0; index < out_mat.size(); index++) {
+        out[index] = cursor.ParseElement();
+    }
+
+    cursor.ExpectEnd();
+    return out_mat;
+} // ParseMatTextRowMajor
+
+//! Reads a text matrix file into an Eigen matrix.
+/*!
+  The file is memory mapped and parsed in place with std::from_chars, so no
+  per-element strings are built and the current locale is never consulted.
+  Malformed files raise a MatParseError naming the line and column.
+  \param read_file_path the path of the text matrix file
+  \return The matrix stored in the file
+ */
+Eigen::MatrixXd ReadMatFileText(const std::string &read_file_path) {
+    MappedFile mapped_file(read_file_path);
+    const char *begin = mapped_file.GetData();
+
+    return ParseMatText(begin, begin + mapped_file.GetSize(), read_file_path);
+} // ReadMatFileText
+
+//! First bytes of a sparse text file, in the Matrix Market coordinate format.
+const char kSparseTextBanner[] = "%%MatrixMarket";
+
+//! Magic bytes at the start of every sparse binary matrix file.
+const char kSparseMatMagic[8] = {'P', 'A', '1', 'S', 'P', 'R', 'S', '\0'};
+
+//! The sparse binary format version written by this header.
+const std::uint32_t kSparseMatVersion = 1;
+
+//! On-disk header of a sparse binary matrix file.
+/*!
+  The header is followed by rows + 1 row offsets and non_zeros column
+  indices, all int64, then non_zeros doubles: a CSR matrix as it sits in
+  memory.
+ */
+struct SparseMatHeader {
+    //! Always kSparseMatMagic.
+    char magic[8];
+    //! Format version, kSparseMatVersion for files written here.
+    std::uint32_t version;
+    //! Byte offset of the row offsets, at least sizeof(SparseMatHeader).
+    std::uint32_t data_offset;
+    //! Number of rows.
+    std::uint64_t rows;
+    //! Number of columns.
+    std::uint64_t cols;
+    //! Number of stored nonzeros.
+    std::uint64_t non_zeros;
+    //! Size of one offset or index in bytes, always 8.
+    std::uint32_t index_size;
+    //! Size of one value in bytes, always sizeof(double).
+    std::uint32_t element_size;
+    //! Pads the header out to kBinaryMatHeaderSize.
+    std::uint8_t reserved[16];
+};
+
+static_assert(sizeof(SparseMatHeader) == kBinaryMatHeaderSize,
+              "SparseMatHeader must match the on-disk header size");
+static_assert(sizeof(Eigen::Index) == sizeof(std::int64_t),
+              "sparse files store Eigen::Index offsets as int64");
+
+
+//! Checks whether a file starts with the given bytes.
+bool FileStartsWith(const std::string &read_file_path, const char *prefix,
+                    std::size_t size) {
+    std::ifstream read_file(read_file_path, std::ios::binary);
+    std::vector<char> start(size);
+    read_file.read(start.data(), static_cast<std::streamsize>(size));
+
+    return read_file.gcount() == static_cast<std::streamsize>(size) &&
+           std::memcmp(start.data(), prefix, size) == 0;
+} // FileStartsWith
+
+//! Checks whether a file is a sparse matrix file, text or binary.
+bool IsSparseMatFile(const std::string &read_file_path) {
+    return FileStartsWith(read_file_path, kSparseMatMagic,
+                          sizeof(kSparseMatMagic)) ||
+           FileStartsWith(read_file_path, kSparseTextBanner,
+                          sizeof(kSparseTextBanner) - 1);
+} // IsSparseMatFile
+
+//! Parses a sparse text matrix held in memory.
+/*!
+  Only real (or integer) general coordinate matrices are accepted. Indices
+  are 1-based, entries may come in any order, and repeated entries are
+  summed.
+  \param begin the first byte of the text
+  \param end one past the last byte of the text
+  \param file_path the path reported in errors
+  \return The parsed matrix
+ */
+CsrMatrix ParseSparseMatText(const char *begin, const char *end,
+                             const std::string &file_path) {
+    MatTextCursor cursor(begin, end, file_path);
+
+    std::istringstream banner(std::string(
+        begin, std::find(begin, end, '\n')));
+    std::string word;
+    std::vector<std::string> words;
+    while (banner >> word) {
+        for (char &character : word) {
+            character = static_cast<char>(std::tolower(character));
+        }
+        words.push_back(word);
+    }
+    if (words.size() != 5 || words[0] != "%%matrixmarket" ||
+            words[1] != "matrix" || words[2] != "coordinate" ||
+            (words[3] != "real" && words[3] != "integer") ||
+            words[4] != "general") {
+        cursor.Fail("expected \"%%MatrixMarket matrix coordinate real "
+                    "general\"");
+    }
+
+    cursor.SkipCommentLines();
+    const Eigen::Index rows = cursor.ParseDimension("row count");
+    const Eigen::Index cols = cursor.ParseDimension("column count");
+    const Eigen::Index non_zeros = cursor.ParseDimension("nonzero count");
+
+    std::vector<SparseTriplet> triplets;
+    triplets.reserve(static_cast<std::size_t>(non_zeros));
+    for (Eigen::Index index = 0; index < non_zeros; index++) {
+        const Eigen::Index row = cursor.ParseDimension("row index");
+        if (row < 1 || row > rows) {
+            cursor.Fail("row index out of range");
+        }
+        const Eigen::Index col = cursor.ParseDimension("column index");
+        if (col < 1 || col > cols) {
+            cursor.Fail("column index out of range");
+        }
+
+        triplets.push_back({row - 1, col - 1, cursor.ParseElement()});
+    }
+
+    cursor.ExpectEnd();
+    return TripletsToCsr(rows, cols, triplets);
+} // ParseSparseMatText
+
+//! Reads a sparse binary matrix file.
+/*!
+  \param read_file_path the path of the sparse binary file
+  \return The matrix stored in the file
+ */
+CsrMatrix ReadSparseMatFileBinary(const std::string &read_file_path) {
+    MappedFile mapped_file(read_file_path);
+    SparseMatHeader header;
+    if (mapped_file.GetSize() < sizeof(header)) {
+        throw std::runtime_error(read_file_path +
+                                 ": too small for a sparse matrix file");
+    }
+    std::memcpy(&header, mapped_file.GetData(), sizeof(header));
+
+    if (header.version != kSparseMatVersion) {
+        throw std::runtime_error(read_file_path +
+                                 ": unsupported sparse version " +
+                                 std::to_string(header.version));
+    }
+    if (header.index_size != sizeof(std::int64_t) ||
+            header.element_size != sizeof(double) ||
+            header.data_offset < sizeof(header) ||
+            header.data_offset % alignof(double) != 0 ||
+            header.rows > INT64_MAX / 2 || header.cols > INT64_MAX / 2 ||
+            header.non_zeros > INT64_MAX / 2 / sizeof(double) ||
+            header.rows > INT64_MAX / 2 / sizeof(std::int64_t)) {
+        throw std::runtime_error(read_file_path + ": malformed sparse header");
+    }
+
+    const std::uint64_t data_size =
+        (header.rows + 1) * sizeof(std::int64_t) +
+        header.non_zeros * (sizeof(std::int64_t) + sizeof(double));
+    if (mapped_file.GetSize() - header.data_offset < data_size) {
+        throw std::runtime_error(read_file_path + ": sparse file is truncated");
+    }
+
+    CsrMatrix csr;
+    csr.rows = static_cast<Eigen::Index>(header.rows);
+    csr.cols = static_cast<Eigen::Index>(header.cols);
+    csr.row_offsets.resize(header.rows + 1);
+    csr.col_indices.resize(header.non_zeros);
+    csr.values.resize(header.non_zeros);
+
+    const char *data = mapped_file.GetData() + header.data_offset;
+    const std::size_t offsets_size =
+        csr.row_offsets.size() * sizeof(Eigen::Index);
+    const std::size_t indices_size =
+        csr.col_indices.size() * sizeof(Eigen::Index);
+    std::memcpy(csr.row_offsets.data(), data, offsets_size);
+    std::memcpy(csr.col_indices.data(), data + offsets_size, indices_size);
+    std::memcpy(csr.values.data(), data + offsets_size + indices_size,
+                csr.values.size() * sizeof(double));
+
+    // the kernels index with these, so a corrupt file must not get past here
+    bool valid = csr.row_offsets.front() == 0 &&
+                 csr.row_offsets.back() == csr.GetNonZeros();
+    for (Eigen::Index row = 0; valid && row < csr.rows; row++) {
+        const Eigen::Index first = csr.row_offsets[row];
+        const Eigen::Index last = csr.row_offsets[row + 1];
+        valid = first <= last && last <= csr.GetNonZeros();
+        for (Eigen::Index index = first; valid && index < last; index++) {
+            valid = csr.col_indices[index] >= 0 &&
+                    csr.col_indices[index] < csr.cols &&
+                    (index == first ||
+                     csr.col_indices[index - 1] < csr.col_indices[index]);
+        }
+    }
+    if (!valid) {
+        throw std::runtime_error(read_file_path + ": corrupt sparse indices");
+    }
+
+    return csr;
+} // ReadSparseMatFileBinary
+
+//! Reads a sparse matrix file, text or binary, into CSR form.
+/*!
+  Dense files are read and compressed, so any matrix file is accepted.
+  \param read_file_path the path of the matrix file
+  \return The matrix stored in the file
+ */
+CsrMatrix ReadCsrMatFile(const std::string &read_file_path);
+
+//! Writes a CSR matrix as Matrix Market coordinate text.
+/*!
+  Values are written in the shortest form that reads back exactly.
+  \param csr the matrix to write
+  \param write_file_path the path of the output file
+ */
+void WriteSparseMatFile(const CsrMatrix &csr,
+                        const std::string &write_file_path) {
+    MatTextWriter writer(write_file_path);
+    const std::string kBanner = std::string(kSparseTextBanner) +
+                                " matrix coordinate real general\n";
+    writer.Append(kBanner.data(), kBanner.size());
+
+    writer.AppendInteger(csr.rows);
+    writer.Append(' ');
+    writer.AppendInteger(csr.cols);
+    writer.Append(' ');
+    writer.AppendInteger(csr.GetNonZeros());
+    writer.Append('\n');
+
+    char number[kMatMaxNumberLength];
+    for (Eigen::Index row = 0; row < csr.rows; row++) {
+        for (Eigen::Index index = csr.row_offsets[row];
+                index < csr.row_offsets[row + 1]; index++) {
+            writer.AppendInteger(row + 1);
+            writer.Append(' ');
+            writer.AppendInteger(csr.col_indices[index] + 1);
+            writer.Append(' ');
+            writer.Append(number, FormatShortest(csr.values[index], number));
+            writer.Append('\n');
+        }
+    }
+
+    writer.Close();
+} // WriteSparseMatFile
+
+//! Writes a CSR matrix in the sparse binary format.
+/*!
+  \param csr the matrix to write
+  \param write_file_path the path of the output file
+ */
+void WriteSparseMatFileBinary(const CsrMatrix &csr,
+                              const std::string &write_file_path) {
+    SparseMatHeader header = {};
+    std::memcpy(header.magic, kSparseMatMagic, sizeof(header.magic));
+    header.version = kSparseMatVersion;
+    header.data_offset = kBinaryMatHeaderSize;
+    header.rows = static_cast<std::uint64_t>(csr.rows);
+    header.cols = static_cast<std::uint64_t>(csr.cols);
+    header.non_zeros = static_cast<std::uint64_t>(csr.GetNonZeros());
+    header.index_size = sizeof(std::int64_t);
+    header.element_size = sizeof(double);
+
+    std::ofstream mat_file(write_file_path, std::ios::binary);
+    if (!mat_file) {
+        throw std::runtime_error(write_file_path + ": cannot open for writing");
+    }
+
+    auto write = [&mat_file](const void *data, std::size_t size) {
+        mat_file.write(static_cast<const char *>(data),
+                       static_cast<std::streamsize>(size));
+    };
+    write(&header, sizeof(header));
+    write(csr.row_offsets.data(),
+          csr.row_offsets.size() * sizeof(Eigen::Index));
+    write(csr.col_indices.data(),
+          csr.col_indices.size() * sizeof(Eigen::Index));
+    write(csr.values.data(), csr.values.size() * sizeof(double));
+
+    if (!mat_file) {
+        throw std::runtime_error(write_file_path + ": write failed");
+    }
+} // WriteSparseMatFileBinary
+
+//! Reads the matrix at file_path's data, creates a matrix object with that
+//! data, and returns the matrix object. Binary, compressed and sparse files
+//! are recognized by their first bytes; everything else is parsed as text.
+//! Sparse files are expanded to dense.
+/*!
+  \param read_file_path the path of the matrix file
+  \return The matrix stored in the file
+ */
+Eigen::MatrixXd ReadMatFile(const std::string &read_file_path) {
+    if (IsBinaryMatFile(read_file_path)) {
+        MappedMatFile mapped_file(read_file_path);
+        if (mapped_file.GetLayout() == MatLayout::kColMajor) {
+            return mapped_file.GetMatrix();
+        }
+
+        Eigen::MatrixXd out_mat;
+        ToColMajor(mapped_file.GetRowMajorMatrix(), out_mat);
+        return out_mat;
+    }
+    if (IsCompressedMatFile(read_file_path)) {
+        return ReadMatFileCompressed(read_file_path);
+    }
+    if (IsSparseMatFile(read_file_path)) {
+        return CsrToDense(ReadCsrMatFile(read_file_path));
+    }
+
+    return ReadMatFileText(read_file_path);
+} // ReadMatFile
+
+//! Reads any matrix file into row-major storage.
+/*!
+  Text files and row-major binary files are read in their own order;
+  everything else is read as ReadMatFile would and transposed once.
+  \param read_file_path the path of the matrix file
+  \return The matrix stored in the file
+ */
+MatrixXdRowMajor ReadMatFileRowMajor(const std::string &read_file_path) {
+    MatrixXdRowMajor out_mat;
+
+    if (IsBinaryMatFile(read_file_path)) {
+        MappedMatFile mapped_file(read_file_path);
+        if (mapped_file.GetLayout() == MatLayout::kRowMajor) {
+            return mapped_file.GetRowMajorMatrix();
+        }
+
+        ToRowMajor(mapped_file.GetMatrix(), out_mat);
+        return out_mat;
+    }
+    if (IsCompressedMatFile(read_file_path) ||
+            IsSparseMatFile(read_file_path)) {
+        ToRowMajor(ReadMatFile(read_file_path), out_mat);
+        return out_mat;
+    }
+
+    MappedFile mapped_file(read_file_path);
+    const char *begin = mapped_file.GetData();
+    return ParseMatTextRowMajor(begin, begin + mapped_file.GetSize(),
+                                read_file_path);
+} // ReadMatFileRowMajor
+
+CsrMatrix ReadCsrMatFile(const std::string &read_file_path) {
+    if (FileStartsWith(read_file_path, kSparseMatMagic,
+                       sizeof(kSparseMatMagic))) {
+        return ReadSparseMatFileBinary(read_file_path);
+    }
+    if (FileStartsWith(read_file_path, kSparseTextBanner,
+                       sizeof(kSparseTextBanner) - 1)) {
+        MappedFile mapped_file(read_file_path);
+        const char *begin = mapped_file.GetData();
+
+        return ParseSparseMatText(begin, begin + mapped_file.GetSize(),
+                                  read_file_path);
+    }
+
+    return DenseToCsr(ReadMatFile(read_file_path));
+} // ReadCsrMatFile
+
+//! Writes the contents and dimensions of an Eigen dynamic doubles matrix into
+//! a file at the second input's file path, in the text format.
+/*!
+  The default format is byte-for-byte what streaming the matrix through
+  Eigen's operator<< produces, so existing golden files still diff clean.
+  \param mat the matrix to write
+  \param write_file_path the path of the output file
+  \param format the element layout
+ */
+template <typename Derived>
+void WriteMatFile(const Eigen::DenseBase<Derived> &mat,
+                  const std::string &write_file_path,
+                  MatTextFormat format = MatTextFormat::kEigenAligned) {
+    MatTextWriter writer(write_file_path);
+
+    WriteMatTextHeader(mat.rows(), mat.cols(), writer);
+    WriteMatTextBody(mat, writer, format);
+
+    writer.Close();
+} // WriteMatFile
+
+//! Converts a text matrix file into the binary format.
+/*!
+  \param text_file_path the path of the text input
+  \param binary_file_path the path of the binary output
+  \param layout the storage order of the output; kRowMajor keeps the
+                text's order and needs no transpose
+ */
+void ConvertTextToBinary(const std::string &text_file_path,
+                         const std::string &binary_file_path,
+                         MatLayout layout = MatLayout::kColMajor) {
+    if (layout == MatLayout::kRowMajor) {
+        MappedFile mapped_file(text_file_path);
+        const char *begin = mapped_file.GetData();
+        WriteMatFileBinary(ParseMatTextRowMajor(begin,
+                                                begin + mapped_file.GetSize(),
+                                                text_file_path),
+                           binary_file_path);
+        return;
+    }
+
+    WriteMatFileBinary(ReadMatFileText(text_file_path), binary_file_path);
+} // ConvertTextToBinary
+
+//! Converts a binary matrix file into the text format.
+/*!
+  \param binary_file_path the path of the binary input
+  \param text_file_path the path of the text output
+  \param format the element layout, lossless by default
+ */
+void ConvertBinaryToText(const std::string &binary_file_path,
+                         const std::string &text_file_path,
+                         MatTextFormat format = MatTextFormat::kCompact) {
+    MappedMatFile mapped_file(binary_file_path);
+    if (mapped_file.GetLayout() == MatLayout::kRowMajor) {
+        WriteMatFile(mapped_file.GetRowMajorMatrix(), text_file_path, format);
+    } else {
+        WriteMatFile(mapped_file.GetMatrix(), text_file_path, format);
+    }
+} // ConvertBinaryToText
+
+#endif
@@ -0,0 +1,300 @@
+#ifndef MAT_OPERAND_H_
+#define MAT_OPERAND_H_
+
+//!  Matrices that are held dense, sparse or integer, whichever suits them.
+/*!
+  \file mat_operand.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  ReadMatOperand keeps sparse files sparse, compresses dense files whose
+  density falls below a threshold, and keeps integer-valued dense files as
+  int32 or int64. The sum and product below then pick the kernel for each
+  pairing: CSR with CSR stays sparse, a sparse operand with a dense one
+  gives a dense result, two integer operands use the exact integer kernels
+  (falling back to double if the result could overflow), and two dense
+  operands use the blocked GEMM and SIMD sum kernels.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <string>
+#include <utility>
+
+#include "./integer_mat.hpp"
+#include "./mat_io.hpp"
+#include "./mat_sum.hpp"
+#include "./parallel_gemm.hpp"
+#include "./sparse_mat.hpp"
+
+
+//! Class holding a matrix in dense, CSR or integer form.
+class MatOperand {
+  public:
+    //! Holds an empty dense matrix.
+    MatOperand() = default;
+
+    //! Holds a dense matrix.
+    explicit MatOperand(Eigen::MatrixXd dense)
+        : dense_(std::move(dense)) {} // constructor
+
+    //! Holds a sparse matrix.
+    explicit MatOperand(CsrMatrix sparse)
+        : is_sparse_(true), sparse_(std::move(sparse)) {} // constructor
+
+    //! Holds an integer-valued matrix.
+    explicit MatOperand(IntegerMat integer)
+        : is_integer_(true), integer_(std::move(integer)) {} // constructor
+
+    //! Returns whether the matrix is held in CSR form.
+    bool IsSparse() const {
+        return is_sparse_;
+    } // IsSparse
+
+    //! Returns whether the matrix is held as int32 or int64.
+    bool IsInteger() const {
+        return is_integer_;
+    } // IsInteger
+
+    //! Returns whether the matrix is held as dense doubles.
+    bool IsDense() const {
+        return !is_sparse_ && !is_integer_;
+    } // IsDense
+
+    //! Returns the number of rows.
+    Eigen::Index GetRows() const {
+        return is_sparse_ ? sparse_.rows :
+               is_integer_ ? integer_.GetRows() : dense_.rows();
+    } // GetRows
+
+    //! Returns the number of columns.
+    Eigen::Index GetCols() const {
+        return is_sparse_ ? sparse_.cols :
+               is_integer_ ? integer_.GetCols() : dense_.cols();
+    } // GetCols
+
+    //! Returns the dense matrix; only valid when IsDense().
+    const Eigen::MatrixXd &GetDense() const {
+        return dense_;
+    } // GetDense
+
+    //! Returns the sparse matrix; only valid when IsSparse().
+    const CsrMatrix &GetSparse() const {
+        return sparse_;
+    } // GetSparse
+
+    //! Returns the integer matrix; only valid when IsInteger().
+    const IntegerMat &GetInteger() const {
+        return integer_;
+    } // GetInteger
+
+    //! Returns a dense copy, whichever form is held.
+    Eigen::MatrixXd ToDense() const {
+        return is_sparse_ ? CsrToDense(sparse_) :
+               is_integer_ ? integer_.ToDouble() : dense_;
+    } // ToDense
+
+  private:
+    bool is_sparse_ = false;
+    bool is_integer_ = false;
+    Eigen::MatrixXd dense_;
+    CsrMatrix sparse_;
+    IntegerMat integer_;
+};
+
+//! Reads a matrix file, keeping it sparse or integer when that pays off.
+/*!
+  Sparse files always stay sparse. Dense files are compressed when fewer
+  than density_threshold of their elements are nonzero; pass 0 to keep every
+  dense file dense. Other dense files holding only integers are kept as
+  int32 or int64 unless detect_integers is false.
+  \param read_file_path the path of the matrix file
+  \param density_threshold the density below which a dense file is compressed
+  \param detect_integers whether to look for integer-valued files
+  \return The matrix, in the chosen form
+  \throws std::runtime_error if density_threshold is not between 0 and 1
+ */
+MatOperand ReadMatOperand(const std::string &read_file_path,
+                          double density_threshold = kDefaultSparseDensity,
+                          bool detect_integers = true) {
+    if (!(density_threshold >= 0.0 && density_threshold <= 1.0)) {
+        throw std::runtime_error("density threshold must be between 0 and 1");
+    }
+    if (IsSparseMatFile(read_file_path)) {
+        return MatOperand(ReadCsrMatFile(read_file_path));
+    }
+
+    Eigen::MatrixXd dense = ReadMatFile(read_file_path);
+    if (ComputeDensity(CountNonZeros(dense), dense.rows(), dense.cols()) <
+            density_threshold) {
+        return MatOperand(DenseToCsr(dense));
+    }
+
+    IntegerMat integer;
+    if (detect_integers && ToIntegerMat(dense, integer)) {
+        return MatOperand(std::move(integer));
+    }
+
+    return MatOperand(std::move(dense));
+} // ReadMatOperand
+
+//! Returns an operand as dense doubles, converting only if it is not.
+/*!
+  \param mat the operand
+  \param scratch holds the conversion, if one is needed
+  \return mat's own dense matrix, or scratch
+ */
+const Eigen::MatrixXd &AsDense(const MatOperand &mat,
+                               Eigen::MatrixXd &scratch) {
+    if (mat.IsDense()) {
+        return mat.GetDense();
+    }
+
+    scratch = mat.ToDense();
+    return scratch;
+} // AsDense
+
+//! Adds two operands of the same shape.
+/*!
+  \param input_1 the first operand
+  \param input_2 the second operand
+  \return Sparse if both operands are sparse, integer if both are integer
+          and the sum cannot overflow, dense otherwise
+ */
+MatOperand AddMatOperands(const MatOperand &input_1,
+                          const MatOperand &input_2) {
+    if (input_1.IsSparse() && input_2.IsSparse()) {
+        return MatOperand(AddCsr(input_1.GetSparse(), input_2.GetSparse()));
+    }
+
+    IntegerMat integer_sum;
+    if (input_1.IsInteger() && input_2.IsInteger() &&
+            SumIntegerMats(input_1.GetInteger(), input_2.GetInteger(),
+                           integer_sum)) {
+        return MatOperand(std::move(integer_sum));
+    }
+
+    Eigen::MatrixXd scratch_1;
+    Eigen::MatrixXd scratch_2;
+    if (input_1.IsSparse()) {
+        return MatOperand(AddCsrDense(input_1.GetSparse(),
+                                      AsDense(input_2, scratch_2)));
+    }
+    if (input_2.IsSparse()) {
+        return MatOperand(AddCsrDense(input_2.GetSparse(),
+                                      AsDense(input_1, scratch_1)));
+    }
+
+    Eigen::MatrixXd sum;
+    SumContiguous(AsDense(input_1, scratch_1), AsDense(input_2, scratch_2),
+                  sum);
+    return MatOperand(std::move(sum));
+} // AddMatOperands
+
+//! Multiplies two operands whose inner dimensions agree.
+/*!
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param thread_count threads for a dense product, 0 for one per hardware
+                      thread
+  \return Sparse if both operands are sparse, integer if both are integer
+          and the product cannot overflow, dense otherwise
+ */
+MatOperand MultiplyMatOperands(const MatOperand &input_1,
+                               const MatOperand &input_2,
+                               unsigned int thread_count = 0) {
+    if (input_1.IsSparse() && input_2.IsSparse()) {
+        return MatOperand(MultiplyCsr(input_1.GetSparse(),
+                                      input_2.GetSparse()));
+    }
+
+    IntegerMat integer_product;
+    if (input_1.IsInteger() && input_2.IsInteger() &&
+            MultiplyIntegerMats(input_1.GetInteger(), input_2.GetInteger(),
+                                integer_product)) {
+        return MatOperand(std::move(integer_product));
+    }
+
+    Eigen::MatrixXd scratch_1;
+    Eigen::MatrixXd scratch_2;
+    if (input_1.IsSparse()) {
+        return MatOperand(MultiplyCsrDense(input_1.GetSparse(),
+                                           AsDense(input_2, scratch_2)));
+    }
+    if (input_2.IsSparse()) {
+        return MatOperand(MultiplyDenseCsr(AsDense(input_1, scratch_1),
+                                           input_2.GetSparse()));
+    }
+
+    Eigen::MatrixXd product;
+    GemmParallel(AsDense(input_1, scratch_1), AsDense(input_2, scratch_2),
+                 product, thread_count);
+    return MatOperand(std::move(product));
+} // MultiplyMatOperands
+
+//! Writes the elements of an integer matrix, row by row, without a header.
+/*!
+  Every element is printed in full, single spaced like kCompact, rather
+  than going through doubles and the six significant digits of the default
+  text format.
+  \param mat the matrix to write
+  \param writer the destination
+ */
+template <typename Derived>
+void WriteIntegerMatTextBody(const Eigen::DenseBase<Derived> &mat,
+                             MatTextWriter &writer) {
+    for (Eigen::Index row = 0; row < mat.rows(); row++) {
+        if (row > 0) {
+            writer.Append('\n');
+        }
+
+        for (Eigen::Index col = 0; col < mat.cols(); col++) {
+            if (col > 0) {
+                writer.Append(' ');
+            }
+            writer.AppendInteger(static_cast<long long>(mat(row, col)));
+        }
+    }
+} // WriteIntegerMatTextBody
+
+//! Writes an integer matrix into a text file, every element exactly.
+/*!
+  \param mat the matrix to write
+  \param write_file_path the path of the output file
+ */
+void WriteIntegerMatFile(const IntegerMat &mat,
+                         const std::string &write_file_path) {
+    MatTextWriter writer(write_file_path);
+
+    WriteMatTextHeader(mat.GetRows(), mat.GetCols(), writer);
+    if (mat.GetRows() > 0 && mat.GetCols() > 0) {
+        if (mat.IsNarrow()) {
+            WriteIntegerMatTextBody(mat.GetNarrow(), writer);
+        } else {
+            WriteIntegerMatTextBody(mat.GetWide(), writer);
+        }
+    }
+
+    writer.Close();
+} // WriteIntegerMatFile
+
+//! Writes an operand in its own form: sparse text or dense text.
+/*!
+  Integer operands are written as dense text with WriteIntegerMatFile, so
+  every element is exact however many digits it has.
+  \param mat the matrix to write
+  \param write_file_path the path of the output file
+ */
+void WriteMatOperand(const MatOperand &mat,
+                     const std::string &write_file_path) {
+    if (mat.IsSparse()) {
+        WriteSparseMatFile(mat.GetSparse(), write_file_path);
+    } else if (mat.IsInteger()) {
+        WriteIntegerMatFile(mat.GetInteger(), write_file_path);
+    } else {
+        WriteMatFile(mat.GetDense(), write_file_path);
+    }
+} // WriteMatOperand
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef MAT_PIPELINE_H_
+#define MAT_PIPELINE_H_
+
+//!  A job pipeline that overlaps matrix reads, compute and writes.
+/*!
+  \file mat_pipeline.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  RunMatPipeline works through a list of jobs on the calling thread. While a
+  job computes, MatPrefetcher's reader threads load the inputs of the next
+  few jobs, and a MatFileWriter thread formats and writes the results of
+  earlier ones. Results reach the writer through a BoundedQueue, so a slow
+  disk holds compute back instead of letting results pile up in memory, and
+  every input is released after the last job that uses it. Wall time then
+  tends to the slowest of the three stages rather than their sum. Results
+  of operations with compute_into come from a MatArena and go back to it
+  once written, so steady state allocates nothing.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "./mat_arena.hpp"
+#include "./mat_io.hpp"
+#include "./pairwise_jobs.hpp"
+#include "./thread_pool.hpp"
+
+
+//! One job: apply operation to two of the pipeline's input files.
+struct MatPipelineJob {
+    //! Index of the left input.
+    std::size_t first;
+    //! Index of the right input.
+    std::size_t second;
+    //! The operation and its compatibility test; must outlive the run.
+    const PairwiseOperation *operation;
+    //! Where the result, or the operation's error message, is written.
+    std::string output_path;
+};
+
+//! Settings for RunMatPipeline.
+struct MatPipelineOptions {
+    //! Jobs past the current one whose inputs are read ahead.
+    std::size_t lookahead = 2;
+    //! Threads reading input files.
+    unsigned int reader_count = 2;
+    //! Results that may wait for the writer before compute blocks.
+    std::size_t write_queue_depth = 4;
+};
+
+//! Class passing items between threads through a queue of fixed capacity.
+template <typename T>
+class BoundedQueue {
+  public:
+    //! Creates an empty, open queue.
+    /*!
+      \param capacity the most items held at once, at least 1
+     */
+    explicit BoundedQueue(std::size_t capacity)
+        : capacity_(std::max<std::size_t>(capacity, 1)) {} // constructor
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    //! Adds an item, waiting while the queue is full.
+    /*!
+      \param item the item to add
+      \return False, dropping the item, if the queue was closed
+     */
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] {
+            return closed_ || items_.size() < capacity_;
+        });
+        if (closed_) {
+            return false;
+        }
+
+        items_.push_back(std::move(item));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    } // Push
+
+    //! Removes the oldest item, waiting while the queue is empty and open.
+    /*!
+      \param item receives the item
+      \return False once the queue is closed and drained
+     */
+    bool Pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] {
+            return closed_ || !items_.empty();
+        });
+        if (items_.empty()) {
+            return false;
+        }
+
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    } // Pop
+
+    //! Refuses further pushes; items already queued can still be popped.
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    } // Close
+
+  private:
+    std::size_t capacity_;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    bool closed_ = false;
+};
+
+//! Class that reads matrix files on background threads ahead of use.
+class MatPrefetcher {
+  public:
+    //! Prepares to read paths; nothing is read until asked for.
+    /*!
+      \param paths the files, addressed by index from now on
+      \param reader_count the threads reading files
+     */
+    MatPrefetcher(const std::vector<std::string> &paths,
+                  unsigned int reader_count)
+        : paths_(paths), loads_(paths.size()),
+          readers_(std::max(reader_count, 1u)) {} // constructor
+
+    //! Starts reading file index in the background if it is not loaded.
+    void Prefetch(std::size_t index) {
+        if (!loads_[index].valid()) {
+            loads_[index] = readers_.Submit([this, index] {
+                return ReadMatFile(paths_[index]);
+            }).share();
+        }
+    } // Prefetch
+
+    //! Returns matrix index, waiting for its read and rethrowing its errors.
+    const Eigen::MatrixXd &Get(std::size_t index) {
+        Prefetch(index);
+        return loads_[index].get();
+    } // Get
+
+    //! Frees matrix index; a later Get reads the file again.
+    void Release(std::size_t index) {
+        loads_[index] = std::shared_future<Eigen::MatrixXd>();
+    } // Release
+
+  private:
+    std::vector<std::string> paths_;
+    std::vector<std::shared_future<Eigen::MatrixXd>> loads_;
+    // declared last so queued reads finish before paths_ goes away
+    ThreadPool readers_;
+};
+
+//! Class that writes matrix files from a background thread.
+class MatFileWriter {
+  public:
+    //! Starts the writer thread.
+    /*!
+      \param queue_depth results that may wait before Write blocks
+      \param arena if set, takes back each matrix once it is written
+     */
+    explicit MatFileWriter(std::size_t queue_depth, MatArena *arena = nullptr)
+        : tasks_(queue_depth), arena_(arena),
+          thread_([this] { Run(); }) {} // constructor
+
+    MatFileWriter(const MatFileWriter &) = delete;
+    MatFileWriter &operator=(const MatFileWriter &) = delete;
+
+    //! Finishes queued writes; errors are only reported by Close.
+    ~MatFileWriter() {
+        tasks_.Close();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    } // destructor
+
+    //! Queues mat for writing to write_file_path, waiting if the queue is
+    //! full.
+    void Write(const std::string &write_file_path, Eigen::MatrixXd mat) {
+        tasks_.Push(WriteTask{write_file_path, std::move(mat), ""});
+    } // Write
+
+    //! Queues message for writing to write_file_path in place of a matrix.
+    void WriteMessage(const std::string &write_file_path,
+                      const std::string &message) {
+        tasks_.Push(WriteTask{write_file_path, Eigen::MatrixXd(), message});
+    } // WriteMessage
+
+    //! Finishes queued writes and rethrows the first write error.
+    void Close() {
+        tasks_.Close();
+        thread_.join();
+
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    } // Close
+
+  private:
+    //! One queued file.
+    struct WriteTask {
+        std::string path;
+        Eigen::MatrixXd mat;
+        std::string message;
+    };
+
+    //! Writes queued files until the queue is closed and drained.
+    void Run() {
+        WriteTask task;
+        while (tasks_.Pop(task)) {
+            // after a failure, keep draining so producers never block
+            if (error_) {
+                continue;
+            }
+
+            try {
+                if (task.message.empty()) {
+                    WriteMatFile(task.mat, task.path);
+                } else {
+                    std::ofstream mat_file;
+                    mat_file.open(task.path);
+
+                    mat_file << task.message;
+
+                    mat_file.close();
+                }
+            } catch (...) {
+                error_ = std::current_exception();
+            }
+
+            if (arena_ != nullptr) {
+                arena_->Release(std::move(task.mat));
+            }
+        }
+    } // Run
+
+    BoundedQueue<WriteTask> tasks_;
+    MatArena *arena_;
+    // only touched by the writer thread until Close joins it
+    std::exception_ptr error_;
+    std::thread thread_;
+};
+
+
+//! Runs jobs in order, overlapping their reads, compute and writes.
+/*!
+  \param input_paths the matrix files jobs refer to by index
+  \param jobs the jobs, computed in order on the calling thread
+  \param options the read-ahead distance, reader threads and queue depth
+  \return How many jobs were computed and pruned
+ */
+PairwiseJobReport RunMatPipeline(const std::vector<std::string> &input_paths,
+                                 const std::vector<MatPipelineJob> &jobs,
+                                 const MatPipelineOptions &options = {}) {
+    // the last job using each input, so it can be freed right after
+    std::vector<std::size_t> last_use(input_paths.size(), 0);
+    for (std::size_t job = 0; job < jobs.size(); job++) {
+        if (jobs[job].first >= input_paths.size() ||
+                jobs[job].second >= input_paths.size()) {
+            throw std::runtime_error("job " + std::to_string(job) +
+                                     " refers to a missing input");
+        }
+        last_use[jobs[job].first] = job;
+        last_use[jobs[job].second] = job;
+    }
+
+    PairwiseJobReport report;
+    MatPrefetcher prefetcher(input_paths, options.reader_count);
+    // declared before the writer, which releases into it until it is joined
+    MatArena arena;
+    MatFileWriter writer(options.write_queue_depth, &arena);
+
+    for (std::size_t job = 0; job < jobs.size(); job++) {
+        const std::size_t kAheadEnd =
+            std::min(jobs.size(), job + options.lookahead + 1);
+        for (std::size_t ahead = job; ahead < kAheadEnd; ahead++) {
+            prefetcher.Prefetch(jobs[ahead].first);
+            prefetcher.Prefetch(jobs[ahead].second);
+        }
+
+        const MatPipelineJob &current = jobs[job];
+        const Eigen::MatrixXd &input_1 = prefetcher.Get(current.first);
+        const Eigen::MatrixXd &input_2 = prefetcher.Get(current.second);
+
+        if (current.operation->is_compatible(input_1, input_2)) {
+            report.computed++;
+            writer.Write(current.output_path,
+                         ComputePair(*current.operation, input_1, input_2,
+                                     arena));
+        } else {
+            report.pruned++;
+            if (!current.operation->error_message.empty()) {
+                writer.WriteMessage(current.output_path,
+                                    current.operation->error_message);
+            }
+        }
+
+        if (last_use[current.first] == job) {
+            prefetcher.Release(current.first);
+        }
+        if (last_use[current.second] == job) {
+            prefetcher.Release(current.second);
+        }
+    }
+
+    writer.Close();
+    return report;
+} // RunMatPipeline
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef MAT_STREAM_H_
+#define MAT_STREAM_H_
+
+//!  Sequential readers that pull a matrix file in pieces of bounded size.
+/*!
+  \file mat_stream.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Both readers hold only a fixed window of the file, so matrices far larger
+  than memory can be consumed a band of rows (text) or a run of elements
+  (binary) at a time.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./mat_io.hpp"
+
+//! Size of the window a streaming reader keeps in memory.
+const std::size_t kMatStreamWindowSize = 1 << 20;
+
+//! Bytes that must be buffered ahead of a token unless the file has ended.
+//! Tokens longer than this are reported as too long.
+const std::size_t kMatStreamTokenReserve = 4096;
+
+
+//! Where a MatTextStreamReader stopped, so a later reader can pick up there.
+struct MatTextStreamPosition {
+    //! File offset of the first unread byte.
+    std::uint64_t offset = 0;
+    //! Line number at offset, starting at 1.
+    std::uint64_t line = 1;
+    //! File offset where that line starts.
+    std::uint64_t line_start_offset = 0;
+    //! The matrix's shape, from the header.
+    Eigen::Index rows = 0;
+    Eigen::Index cols = 0;
+    //! Rows already read.
+    Eigen::Index rows_read = 0;
+};
+
+//! Class that reads a text matrix file row by row through a fixed window.
+class MatTextStreamReader {
+  public:
+    //! Opens read_file_path and parses the "rows cols" header.
+    /*!
+      \param read_file_path the path of the text matrix file
+      \param window_size bytes of the file held in memory at once
+     */
+    explicit MatTextStreamReader(const std::string &read_file_path,
+                                 std::size_t window_size =
+                                     kMatStreamWindowSize)
+        : file_(read_file_path, std::ios::binary),
+          file_path_(read_file_path),
+          window_(std::max(window_size, 2 * kMatStreamTokenReserve)),
+          cursor_(window_.data(), window_.data(), file_path_, false) {
+        if (!file_) {
+            throw std::runtime_error(read_file_path + ": cannot open file");
+        }
+
+        Refill();
+        EnsureToken();
+        rows_ = cursor_.ParseDimension("row count");
+        EnsureToken();
+        cols_ = cursor_.ParseDimension("column count");
+    } // constructor
+
+    //! Reopens read_file_path where an earlier reader stopped.
+    /*!
+      Lets a caller walk many files a band at a time without keeping every
+      one open: save GetPosition(), drop the reader, and resume later.
+      \param read_file_path the path of the text matrix file
+      \param position what GetPosition() returned for that file
+      \param window_size bytes of the file held in memory at once
+     */
+    MatTextStreamReader(const std::string &read_file_path,
+                        const MatTextStreamPosition &position,
+                        std::size_t window_size = kMatStreamWindowSize)
+        : file_(read_file_path, std::ios::binary),
+          file_path_(read_file_path),
+          window_(std::max(window_size, 2 * kMatStreamTokenReserve)),
+          cursor_(window_.data(), window_.data(), file_path_, false),
+          rows_(position.rows),
+          cols_(position.cols),
+          rows_read_(position.rows_read) {
+        if (!file_) {
+            throw std::runtime_error(read_file_path + ": cannot open file");
+        }
+
+        file_.seekg(static_cast<std::streamoff>(position.offset));
+        cursor_.Resume(static_cast<std::size_t>(position.offset),
+                       static_cast<std::size_t>(position.line),
+                       static_cast<std::size_t>(position.line_start_offset));
+        Refill();
+    } // constructor
+
+    //! Returns where this reader stopped, for a later reader to resume.
+    MatTextStreamPosition GetPosition() const {
+        MatTextStreamPosition position;
+        position.offset = cursor_.GetOffset();
+        position.line = cursor_.GetLine();
+        position.line_start_offset = cursor_.GetLineStartOffset();
+        position.rows = rows_;
+        position.cols = cols_;
+        position.rows_read = rows_read_;
+        return position;
+    } // GetPosition
+
+    //! Returns the number of rows in the file.
+    Eigen::Index GetRows() const {
+        return rows_;
+    } // GetRows
+
+    //! Returns the number of columns in the file.
+    Eigen::Index GetCols() const {
+        return cols_;
+    } // GetCols
+
+    //! Returns the number of rows not yet read.
+    Eigen::Index GetRowsLeft() const {
+        return rows_ - rows_read_;
+    } // GetRowsLeft
+
+    //! Reads the next count rows into out in row-major order.
+    /*!
+      \param count the number of rows, at most GetRowsLeft()
+      \param out room for count * GetCols() doubles
+     */
+    void ReadRows(Eigen::Index count, double *out) {
+        if (count > GetRowsLeft()) {
+            throw std::runtime_error(file_path_ + ": read past the last row");
+        }
+
+        const Eigen::Index elements = count * cols_;
+        for (Eigen::Index index = 0; index < elements; index++) {
+            EnsureToken();
+            out[index] = cursor_.ParseElement();
+        }
+
+        rows_read_ += count;
+    } // ReadRows
+
+    //! Checks that nothing but whitespace follows the last row.
+    void ExpectEnd() {
+        while (true) {
+            cursor_.SkipWhitespace();
+            if (cursor_.GetRemaining() > 0) {
+                cursor_.ExpectEnd();
+            }
+            if (at_eof_) {
+                return;
+            }
+            Refill();
+        }
+    } // ExpectEnd
+
+  private:
+    //! Makes sure a whole token is buffered after any leading whitespace.
+    void EnsureToken() {
+        while (true) {
+            cursor_.SkipWhitespace();
+            if (at_eof_ || cursor_.GetRemaining() >= kMatStreamTokenReserve) {
+                return;
+            }
+            Refill();
+        }
+    } // EnsureToken
+
+    //! Slides the unread bytes to the front and reads more of the file.
+    void Refill() {
+        const std::size_t remaining = cursor_.GetRemaining();
+        std::memmove(window_.data(), cursor_.GetPosition(), remaining);
+
+        file_.read(window_.data() + remaining,
+                   static_cast<std::streamsize>(window_.size() - remaining));
+        const std::size_t read = static_cast<std::size_t>(file_.gcount());
+
+        if (file_.bad()) {
+            throw std::runtime_error(file_path_ + ": read failed");
+        }
+
+        at_eof_ = file_.eof();
+        cursor_.Rebase(window_.data(), window_.data() + remaining + read,
+                       at_eof_);
+    } // Refill
+
+    std::ifstream file_;
+    std::string file_path_;
+    std::vector<char> window_;
+    MatTextCursor cursor_;
+    bool at_eof_ = false;
+    Eigen::Index rows_ = 0;
+    Eigen::Index cols_ = 0;
+    Eigen::Index rows_read_ = 0;
+};
+
+//! Class that reads a binary matrix file's elements in storage order.
+class MatBinaryStreamReader {
+  public:
+    //! Opens read_file_path and validates its header.
+    /*!
+      \param read_file_path the path of the binary matrix file
+     */
+    explicit MatBinaryStreamReader(const std::string &read_file_path)
+        : file_(read_file_path, std::ios::binary | std::ios::ate),
+          file_path_(read_file_path) {
+        if (!file_) {
+            throw std::runtime_error(read_file_path + ": cannot open file");
+        }
+
+        const std::uint64_t file_size =
+            static_cast<std::uint64_t>(file_.tellg());
+        file_.seekg(0);
+        file_.read(reinterpret_cast<char *>(&header_), sizeof(header_));
+        if (file_.gcount() != sizeof(header_)) {
+            throw std::runtime_error(read_file_path +
+                                     ": too small for a binary matrix file");
+        }
+
+        CheckBinaryMatHeader(header_, file_size, read_file_path);
+        file_.seekg(header_.data_offset);
+    } // constructor
+
+    //! Returns the header read from the file.
+    const BinaryMatHeader &GetHeader() const {
+        return header_;
+    } // GetHeader
+
+    //! Returns the order the file's elements are stored in.
+    MatLayout GetLayout() const {
+        return GetBinaryMatLayout(header_);
+    } // GetLayout
+
+    //! Returns the number of elements not yet read.
+    std::uint64_t GetElementsLeft() const {
+        return header_.rows * header_.cols - elements_read_;
+    } // GetElementsLeft
+
+    //! Moves past the next count elements without reading them.
+    /*!
+      \param count the number of elements, at most GetElementsLeft()
+     */
+    void SkipElements(std::uint64_t count) {
+        if (count > GetElementsLeft()) {
+            throw std::runtime_error(file_path_ +
+                                     ": seek past the last element");
+        }
+
+        file_.seekg(static_cast<std::streamoff>(count * sizeof(double)),
+                    std::ios::cur);
+        elements_read_ += count;
+    } // SkipElements
+
+    //! Reads the next count elements into out.
+    /*!
+      \param count the number of elements, at most GetElementsLeft()
+      \param out room for count doubles
+     */
+    void ReadElements(std::uint64_t count, double *out) {
+        if (count > GetElementsLeft()) {
+            throw std::runtime_error(file_path_ +
+                                     ": read past the last element");
+        }
+
+        file_.read(reinterpret_cast<char *>(out),
+                   static_cast<std::streamsize>(count * sizeof(double)));
+        if (!file_) {
+            throw std::runtime_error(file_path_ + ": read failed");
+        }
+
+        elements_read_ += count;
+    } // ReadElements
+
+  private:
+    std::ifstream file_;
+    std::string file_path_;
+    BinaryMatHeader header_;
+    std::uint64_t elements_read_ = 0;
+};
+
+//! Class that writes a binary matrix file in storage order, piece by piece.
+class MatBinaryStreamWriter {
+  public:
+    //! Creates write_file_path and writes the header for a rows x cols matrix.
+    /*!
+      \param write_file_path the path of the output file
+      \param rows the number of rows
+      \param cols the number of columns
+      \param layout the order the elements will be written in
+     */
+    MatBinaryStreamWriter(const std::string &write_file_path,
+                          Eigen::Index rows, Eigen::Index cols,
+                          MatLayout layout = MatLayout::kColMajor)
+        : file_(write_file_path, std::ios::binary),
+          file_path_(write_file_path) {
+        if (!file_) {
+            throw std::runtime_error(write_file_path +
+                                     ": cannot open for writing");
+        }
+
+        BinaryMatHeader header = MakeBinaryMatHeader(rows, cols, layout);
+        file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    } // constructor
+
+    //! Appends count elements.
+    void WriteElements(const double *elements, std::uint64_t count) {
+        file_.write(reinterpret_cast<const char *>(elements),
+                    static_cast<std::streamsize>(count * sizeof(double)));
+        if (!file_) {
+            throw std::runtime_error(file_path_ + ": write failed");
+        }
+    } // WriteElements
+
+    //! Closes the file, reporting any write error.
+    void Close() {
+        file_.close();
+        if (!file_) {
+            throw std::runtime_error(file_path_ + ": close failed");
+        }
+    } // Close
+
+  private:
+    std::ofstream file_;
+    std::string file_path_;
+};
+
+#endif
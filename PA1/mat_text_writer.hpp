@@ -0,0 +1,310 @@
+#ifndef MAT_TEXT_WRITER_H_
+#define MAT_TEXT_WRITER_H_
+
+//!  Buffered text matrix writer built on std::to_chars.
+/*!
+  \file mat_text_writer.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Eigen's stream operator formats every element twice through the ostream
+  locale machinery, once to measure column widths and once to print. The
+  writer here formats with std::to_chars into one large buffer that is only
+  handed to the kernel when it fills up.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "./transpose.hpp"
+
+//! Bytes buffered before the writer issues a write.
+const std::size_t kMatWriterBufferSize = 1 << 20;
+
+//! Room for any double printed by either format, with margin.
+const std::size_t kMatMaxNumberLength = 32;
+
+//! Room for one formatted element: separator, padding and number.
+const std::size_t kMatMaxElementLength = 1 + 2 * kMatMaxNumberLength;
+
+//! Digits printed by std::ostream by default, and so by Eigen's operator<<.
+const int kStreamDefaultPrecision = 6;
+
+//! How elements are laid out in a text matrix file.
+enum class MatTextFormat {
+    //! Byte-for-byte what Eigen's operator<< prints: six significant digits,
+    //! right aligned to the widest element. Golden files use this format.
+    kEigenAligned,
+    //! Shortest round-trip representation, single spaces, no padding. Reads
+    //! back to the identical doubles and needs only one formatting pass.
+    kCompact,
+};
+
+
+//! Formats a double like a default std::ostream would.
+/*!
+  \param value the number to format
+  \param out a buffer of at least kMatMaxNumberLength bytes
+  \return The number of characters written
+ */
+std::size_t FormatStreamDefault(double value, char *out) {
+    std::to_chars_result result =
+        std::to_chars(out, out + kMatMaxNumberLength, value,
+                      std::chars_format::general, kStreamDefaultPrecision);
+    return static_cast<std::size_t>(result.ptr - out);
+} // FormatStreamDefault
+
+//! Formats a double with the fewest digits that read back exactly.
+/*!
+  \param value the number to format
+  \param out a buffer of at least kMatMaxNumberLength bytes
+  \return The number of characters written
+ */
+std::size_t FormatShortest(double value, char *out) {
+    std::to_chars_result result =
+        std::to_chars(out, out + kMatMaxNumberLength, value);
+    return static_cast<std::size_t>(result.ptr - out);
+} // FormatShortest
+
+//! Class that collects output in a large buffer and writes it in big chunks.
+class MatTextWriter {
+  public:
+    //! Opens write_file_path for writing, truncating it.
+    /*!
+      \param write_file_path the path of the output file
+     */
+    explicit MatTextWriter(const std::string &write_file_path)
+        : file_(write_file_path, std::ios::binary),
+          file_path_(write_file_path) {
+        if (!file_) {
+            throw std::runtime_error(write_file_path +
+                                     ": cannot open for writing");
+        }
+
+        buffer_.resize(kMatWriterBufferSize);
+    } // constructor
+
+    //! Flushes whatever is still buffered.
+    ~MatTextWriter() {
+        // errors cannot be reported from here; Close() reports them
+        if (file_.is_open()) {
+            file_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+        }
+    } // destructor
+
+    //! Makes room for at least size bytes and returns where to put them.
+    /*!
+      The caller must follow up with Commit once the bytes are written.
+      \param size the number of bytes about to be written, at most
+                  kMatWriterBufferSize
+      \return A pointer into the buffer
+     */
+    char *Reserve(std::size_t size) {
+        if (buffer_.size() - used_ < size) {
+            Flush();
+        }
+        return buffer_.data() + used_;
+    } // Reserve
+
+    //! Marks size bytes from the last Reserve as written.
+    void Commit(std::size_t size) {
+        used_ += size;
+    } // Commit
+
+    //! Appends raw characters.
+    void Append(const char *text, std::size_t size) {
+        while (size > 0) {
+            const std::size_t chunk = std::min(size, buffer_.size());
+            std::copy(text, text + chunk, Reserve(chunk));
+            Commit(chunk);
+            text += chunk;
+            size -= chunk;
+        }
+    } // Append
+
+    //! Appends a single character.
+    void Append(char character) {
+        *Reserve(1) = character;
+        Commit(1);
+    } // Append
+
+    //! Appends an integer.
+    void AppendInteger(long long value) {
+        char *out = Reserve(kMatMaxNumberLength);
+        std::to_chars_result result =
+            std::to_chars(out, out + kMatMaxNumberLength, value);
+        Commit(static_cast<std::size_t>(result.ptr - out));
+    } // AppendInteger
+
+    //! Hands the buffered bytes to the file.
+    void Flush() {
+        file_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+        used_ = 0;
+
+        if (!file_) {
+            throw std::runtime_error(file_path_ + ": write failed");
+        }
+    } // Flush
+
+    //! Flushes and closes the file, reporting any write error.
+    void Close() {
+        Flush();
+        file_.close();
+
+        if (!file_) {
+            throw std::runtime_error(file_path_ + ": close failed");
+        }
+    } // Close
+
+  private:
+    std::ofstream file_;
+    std::string file_path_;
+    std::vector<char> buffer_;
+    std::size_t used_ = 0;
+};
+
+//! Writes the "rows cols" header line followed by a blank line.
+/*!
+  \param rows the number of rows
+  \param cols the number of columns
+  \param writer the destination
+ */
+void WriteMatTextHeader(Eigen::Index rows, Eigen::Index cols,
+                        MatTextWriter &writer) {
+    writer.AppendInteger(rows);
+    writer.Append(' ');
+    writer.AppendInteger(cols);
+    writer.Append("\n\n", 2);
+} // WriteMatTextHeader
+
+//! Finds the widest element of mat as printed by FormatStreamDefault.
+/*!
+  \param mat the matrix to measure
+  \return The width Eigen's operator<< would pad every element to
+ */
+template <typename Derived>
+std::size_t FindStreamDefaultWidth(const Eigen::DenseBase<Derived> &mat) {
+    char scratch[kMatMaxNumberLength];
+    std::size_t width = 0;
+
+    // storage order does not matter for a maximum, so walk it contiguously
+    for (Eigen::Index col = 0; col < mat.cols(); col++) {
+        for (Eigen::Index row = 0; row < mat.rows(); row++) {
+            width = std::max(width, FormatStreamDefault(mat(row, col),
+                                                        scratch));
+        }
+    }
+
+    return width;
+} // FindStreamDefaultWidth
+
+//! Formats one element as it appears in a text row, separator included.
+/*!
+  \param value the element
+  \param col the element's column; every column but the first gets a
+             leading space
+  \param width the column width for kEigenAligned, ignored for kCompact
+  \param format the element layout
+  \param out a buffer of at least kMatMaxElementLength bytes
+  \return The number of characters written
+ */
+std::size_t FormatMatTextElement(double value, Eigen::Index col,
+                                 std::size_t width, MatTextFormat format,
+                                 char *out) {
+    const bool aligned = format == MatTextFormat::kEigenAligned;
+    char number[kMatMaxNumberLength];
+
+    const std::size_t length = aligned ? FormatStreamDefault(value, number)
+                                       : FormatShortest(value, number);
+    const std::size_t padding =
+        aligned && width > length ? width - length : 0;
+    const std::size_t separator = col > 0 ? 1 : 0;
+
+    std::fill(out, out + separator + padding, ' ');
+    std::copy(number, number + length, out + separator + padding);
+    return separator + padding + length;
+} // FormatMatTextElement
+
+//! Writes a run of rows, as a slice of a larger matrix's text body.
+/*!
+  A newline is written before every row except the matrix's first, so a
+  body can be emitted band by band and still match WriteMatTextBody.
+  \param rows the rows to write
+  \param first_row_index the index of rows' first row in the whole matrix
+  \param width the column width for kEigenAligned, ignored for kCompact
+  \param writer the destination
+  \param format the element layout
+ */
+template <typename Derived>
+void WriteMatTextRows(const Eigen::DenseBase<Derived> &rows,
+                      Eigen::Index first_row_index, std::size_t width,
+                      MatTextWriter &writer, MatTextFormat format) {
+    for (Eigen::Index row = 0; row < rows.rows(); row++) {
+        if (first_row_index + row > 0) {
+            writer.Append('\n');
+        }
+
+        for (Eigen::Index col = 0; col < rows.cols(); col++) {
+            char *out = writer.Reserve(kMatMaxElementLength);
+            writer.Commit(FormatMatTextElement(rows(row, col), col, width,
+                                               format, out));
+        }
+    }
+} // WriteMatTextRows
+
+//! Writes the elements of mat, row by row, without a header.
+/*!
+  No newline follows the last row, matching Eigen's operator<<. Text runs
+  across rows, so column-major storage is copied a band of rows at a time
+  into a small row-major buffer with TransposeBlock rather than walked a
+  column's length apart for every element.
+  \param mat the matrix to write
+  \param writer the destination
+  \param format the element layout
+ */
+template <typename Derived>
+void WriteMatTextBody(const Eigen::DenseBase<Derived> &mat,
+                      MatTextWriter &writer, MatTextFormat format) {
+    // Eigen prints nothing at all, not even row breaks, for empty matrices
+    if (mat.size() == 0) {
+        return;
+    }
+
+    const std::size_t width = format == MatTextFormat::kEigenAligned
+        ? FindStreamDefaultWidth(mat)
+        : 0;
+
+    if constexpr (std::is_same<typename Derived::Scalar, double>::value &&
+                  (Derived::Flags & Eigen::DirectAccessBit) != 0 &&
+                  !Derived::IsRowMajor &&
+                  Derived::InnerStrideAtCompileTime == 1) {
+        const Eigen::Index cols = mat.cols();
+        // at most as many bytes as the output buffer, and a leaf's height
+        const Eigen::Index band_rows = std::clamp<Eigen::Index>(
+            static_cast<Eigen::Index>(kMatWriterBufferSize /
+                                      (sizeof(double) * cols)),
+            1, std::min(mat.rows(), kTransposeLeaf));
+        MatrixXdRowMajor band(band_rows, cols);
+
+        for (Eigen::Index row = 0; row < mat.rows(); row += band_rows) {
+            const Eigen::Index count = std::min(band_rows, mat.rows() - row);
+            TransposeBlock(mat.derived().data() + row,
+                           mat.derived().outerStride(), band.data(), cols,
+                           count, cols);
+            WriteMatTextRows(band.topRows(count), row, width, writer, format);
+        }
+    } else {
+        WriteMatTextRows(mat, 0, width, writer, format);
+    }
+} // WriteMatTextBody
+
+#endif
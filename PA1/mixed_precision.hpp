@@ -0,0 +1,295 @@
+#ifndef MIXED_PRECISION_H_
+#define MIXED_PRECISION_H_
+
+//!  Single-precision storage with double-precision accumulation.
+/*!
+  \file mixed_precision.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Operands are stored as float, which halves the bytes every kernel streams
+  and fits twice as many elements in each vector register. The product
+  packs float slivers for a 16 x 4 float micro-kernel. Each kc-deep slab is
+  summed in float registers and then added into a double accumulator, so
+  float rounding error only builds up over kc terms, never over all of k.
+  The result is rounded to float once, at the end.
+
+  With u_f = 2^-24 and u_d = 2^-53, every element of the mixed product
+  satisfies, to first order,
+
+      |C_mixed - A B| <= (3 u_f + kc u_f + ceil(k / kc) u_d) (|A| |B|)
+
+  where A and B are the double inputs: 2 u_f from rounding them to float,
+  kc u_f from one float slab, the u_d term from adding slabs in double and a
+  last u_f for storing C. A sum is rounded once per input and once on
+  store, so |S_mixed - (A + B)| <= 3 u_f (|A| + |B|). MixedErrorBound and
+  MeasureMixedDeviation let a job check both against real data.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "./gemm.hpp"
+
+//! Rows of C computed by one float micro-kernel call.
+const Eigen::Index kMixedMr = 16;
+//! Columns of C computed by one float micro-kernel call.
+const Eigen::Index kMixedNr = 4;
+//! Floats per vector register; twice the doubles of kGemmVecLen.
+const Eigen::Index kMixedVecLen = 2 * kGemmVecLen;
+
+//! Block sizes for the float kernel: mc a multiple of kMixedMr, and a
+//! shallower kc than the double kernel's to keep the float sums short.
+const GemmBlocking kDefaultMixedBlocking = {192, 128, 4096};
+
+//! Unit roundoff of float.
+const double kFloatUnitRoundoff = std::ldexp(1.0, -24);
+//! Unit roundoff of double.
+const double kDoubleUnitRoundoff = std::ldexp(1.0, -53);
+
+
+//! Read access to a column-major float matrix.
+struct FloatColMajorOperand {
+    //! Pointer to element (0, 0).
+    const float *data;
+    //! The leading dimension.
+    Eigen::Index ld;
+
+    //! Returns element (row, col).
+    float operator()(Eigen::Index row, Eigen::Index col) const {
+        return data[row + col * ld];
+    } // operator()
+};
+
+//! How far a mixed-precision result is from the double result.
+struct MixedDeviationReport {
+    //! Largest absolute elementwise difference.
+    double max_abs_deviation = 0.0;
+    //! Largest difference divided by its element's scale (|A||B| or |A|+|B|).
+    double max_scaled_deviation = 0.0;
+    //! The first-order bound on max_scaled_deviation.
+    double bound = 0.0;
+};
+
+
+//! Returns the first-order bound on |C_mixed - A B| / (|A| |B|).
+/*!
+  \param k the shared dimension of the product
+  \param blocking the block sizes the product runs with
+  \return The bound, elementwise relative to |A| |B|
+ */
+double MixedErrorBound(Eigen::Index k,
+                       const GemmBlocking &blocking = kDefaultMixedBlocking) {
+    const Eigen::Index kc = std::max<Eigen::Index>(
+        std::min(blocking.kc, k), 1);
+    const Eigen::Index slabs = (k + blocking.kc - 1) / blocking.kc;
+
+    return (3.0 + static_cast<double>(kc)) * kFloatUnitRoundoff +
+           static_cast<double>(slabs) * kDoubleUnitRoundoff;
+} // MixedErrorBound
+
+//! Accumulates a kMixedMr x kMixedNr tile of double C from float slivers.
+/*!
+  \param kc the shared depth of the slivers
+  \param a_sliver packed float sliver of A
+  \param b_sliver packed float sliver of B
+  \param c pointer to the top-left element of the tile in C
+  \param ldc the leading dimension of C
+  \param rows the number of valid rows in the tile
+  \param cols the number of valid columns in the tile
+ */
+void MixedMicroKernel(Eigen::Index kc, const float *a_sliver,
+                      const float *b_sliver, double *c, Eigen::Index ldc,
+                      Eigen::Index rows, Eigen::Index cols) {
+    typedef float MixedVec
+        __attribute__((vector_size(kMixedVecLen * sizeof(float))));
+    const Eigen::Index kVecsPerCol = kMixedMr / kMixedVecLen;
+
+    MixedVec accumulator[kMixedNr][kVecsPerCol] = {};
+
+    for (Eigen::Index depth = 0; depth < kc; depth++) {
+        MixedVec a_vecs[kVecsPerCol];
+#pragma GCC unroll 8
+        for (Eigen::Index vec = 0; vec < kVecsPerCol; vec++) {
+            __builtin_memcpy(&a_vecs[vec], a_sliver + kMixedVecLen * vec,
+                             sizeof(MixedVec));
+        }
+
+#pragma GCC unroll 8
+        for (Eigen::Index col = 0; col < kMixedNr; col++) {
+            const float b_value = b_sliver[col];
+
+#pragma GCC unroll 8
+            for (Eigen::Index vec = 0; vec < kVecsPerCol; vec++) {
+                accumulator[col][vec] += a_vecs[vec] * b_value;
+            }
+        }
+
+        a_sliver += kMixedMr;
+        b_sliver += kMixedNr;
+    }
+
+    // the slab's float partial sums join the running total in double
+    for (Eigen::Index col = 0; col < cols; col++) {
+        for (Eigen::Index row = 0; row < rows; row++) {
+            c[row + col * ldc] += static_cast<double>(
+                accumulator[col][row / kMixedVecLen][row % kMixedVecLen]);
+        }
+    }
+} // MixedMicroKernel
+
+//! Computes double C += A * B for float A and B.
+/*!
+  \param m the number of rows of A and C
+  \param n the number of columns of B and C
+  \param k the number of columns of A and rows of B
+  \param a pointer to column-major float A
+  \param lda the leading dimension of A
+  \param b pointer to column-major float B
+  \param ldb the leading dimension of B
+  \param c pointer to column-major double C
+  \param ldc the leading dimension of C
+  \param blocking the cache block sizes to use
+ */
+void GemmMixed(Eigen::Index m, Eigen::Index n, Eigen::Index k,
+               const float *a, Eigen::Index lda,
+               const float *b, Eigen::Index ldb,
+               double *c, Eigen::Index ldc,
+               const GemmBlocking &blocking = kDefaultMixedBlocking) {
+    assert(blocking.mc > 0 && blocking.mc % kMixedMr == 0);
+    assert(blocking.nc > 0 && blocking.nc % kMixedNr == 0);
+    assert(blocking.kc > 0);
+
+    if (m == 0 || n == 0 || k == 0) {
+        return;
+    }
+
+    const Eigen::Index mc_max = std::min(
+        blocking.mc, (m + kMixedMr - 1) / kMixedMr * kMixedMr);
+    const Eigen::Index nc_max = std::min(
+        blocking.nc, (n + kMixedNr - 1) / kMixedNr * kMixedNr);
+    const Eigen::Index kc_max = std::min(blocking.kc, k);
+
+    // kept per thread, so repeated calls skip the allocation and page faults
+    thread_local std::vector<float> packed_a;
+    thread_local std::vector<float> packed_b;
+    if (packed_a.size() < static_cast<std::size_t>(mc_max * kc_max)) {
+        packed_a.resize(mc_max * kc_max);
+    }
+    if (packed_b.size() < static_cast<std::size_t>(kc_max * nc_max)) {
+        packed_b.resize(kc_max * nc_max);
+    }
+    const FloatColMajorOperand a_operand{a, lda};
+    const FloatColMajorOperand b_operand{b, ldb};
+
+    for (Eigen::Index jc = 0; jc < n; jc += blocking.nc) {
+        const Eigen::Index nc = std::min(blocking.nc, n - jc);
+
+        for (Eigen::Index pc = 0; pc < k; pc += blocking.kc) {
+            const Eigen::Index kc = std::min(blocking.kc, k - pc);
+            PackPanelB(kc, nc, b_operand, pc, jc, packed_b.data(), kMixedNr);
+
+            for (Eigen::Index ic = 0; ic < m; ic += blocking.mc) {
+                const Eigen::Index mc = std::min(blocking.mc, m - ic);
+                PackBlockA(mc, kc, a_operand, ic, pc, packed_a.data(),
+                           kMixedMr);
+
+                for (Eigen::Index jr = 0; jr < nc; jr += kMixedNr) {
+                    for (Eigen::Index ir = 0; ir < mc; ir += kMixedMr) {
+                        MixedMicroKernel(kc, packed_a.data() + ir * kc,
+                                         packed_b.data() + jr * kc,
+                                         c + (ic + ir) + (jc + jr) * ldc, ldc,
+                                         std::min(kMixedMr, mc - ir),
+                                         std::min(kMixedNr, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+} // GemmMixed
+
+//! Computes float product = input_1 * input_2 with double accumulation.
+/*!
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit
+  \param blocking the cache block sizes to use
+ */
+void GemmMixed(const Eigen::MatrixXf &input_1, const Eigen::MatrixXf &input_2,
+               Eigen::MatrixXf &product,
+               const GemmBlocking &blocking = kDefaultMixedBlocking) {
+    assert(input_1.cols() == input_2.rows());
+
+    Eigen::MatrixXd accumulator =
+        Eigen::MatrixXd::Zero(input_1.rows(), input_2.cols());
+    GemmMixed(input_1.rows(), input_2.cols(), input_1.cols(),
+              input_1.data(), input_1.outerStride(),
+              input_2.data(), input_2.outerStride(),
+              accumulator.data(), accumulator.outerStride(), blocking);
+
+    product = accumulator.cast<float>();
+} // GemmMixed
+
+//! Computes float sum = input_1 + input_2.
+/*!
+  A single IEEE addition is already correctly rounded, so the float sum
+  needs no compensation: it is the double sum of the float inputs rounded
+  once.
+  \param input_1 the first operand
+  \param input_2 the second operand, of the same shape
+  \param sum the output, resized to fit
+ */
+void SumMixed(const Eigen::MatrixXf &input_1, const Eigen::MatrixXf &input_2,
+              Eigen::MatrixXf &sum) {
+    assert(input_1.rows() == input_2.rows() &&
+           input_1.cols() == input_2.cols());
+
+    sum.resize(input_1.rows(), input_1.cols());
+    const float *data_1 = input_1.data();
+    const float *data_2 = input_2.data();
+    float *out = sum.data();
+
+    for (Eigen::Index index = 0; index < sum.size(); index++) {
+        out[index] = data_1[index] + data_2[index];
+    }
+} // SumMixed
+
+//! Compares a float result with the double result it approximates.
+/*!
+  \param result the mixed-precision result
+  \param reference the double-precision result
+  \param scale the elementwise scale of the bound, |A| |B| or |A| + |B|
+  \param bound the bound on the scaled deviation
+  \return The largest absolute and scaled deviations, and the bound
+ */
+MixedDeviationReport MeasureMixedDeviation(const Eigen::MatrixXf &result,
+                                           const Eigen::MatrixXd &reference,
+                                           const Eigen::MatrixXd &scale,
+                                           double bound) {
+    MixedDeviationReport report;
+    report.bound = bound;
+
+    for (Eigen::Index index = 0; index < reference.size(); index++) {
+        const double deviation = std::abs(
+            static_cast<double>(result.data()[index]) -
+            reference.data()[index]);
+
+        report.max_abs_deviation =
+            std::max(report.max_abs_deviation, deviation);
+        if (scale.data()[index] > 0.0) {
+            report.max_scaled_deviation = std::max(
+                report.max_scaled_deviation,
+                deviation / scale.data()[index]);
+        }
+    }
+
+    return report;
+} // MeasureMixedDeviation
+
+#endif
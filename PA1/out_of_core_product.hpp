@@ -0,0 +1,321 @@
+#ifndef OUT_OF_CORE_PRODUCT_H_
+#define OUT_OF_CORE_PRODUCT_H_
+
+//!  Matrix product of operands that do not fit in memory.
+/*!
+  \file out_of_core_product.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Both operands are converted to tiled files, and the result converted back,
+  within the same memory limit as the product. The output is computed one
+  block of b_r x b_c tiles at a time: the block stays in memory while the
+  matching row of A tiles and column of B tiles stream past it, one tile of
+  depth per step. Square-ish output blocks make every loaded tile feed as
+  many multiply-adds as the memory budget allows. While one step computes, a
+  background thread is already reading the next step's tiles.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./gemm.hpp"
+#include "./mat_text_writer.hpp"
+#include "./thread_pool.hpp"
+#include "./tiled_mat_file.hpp"
+
+//! Memory ceiling used when none is given: 1 GiB.
+const std::size_t kDefaultOutOfCoreMemoryLimit = std::size_t(1) << 30;
+
+//! Settings for WriteMatProductFileOutOfCore.
+struct OutOfCoreProductOptions {
+    //! Upper bound on the bytes of tiles held at once.
+    std::size_t memory_limit = kDefaultOutOfCoreMemoryLimit;
+    //! Edge length of the on-disk tiles.
+    Eigen::Index tile_size = kDefaultTileSize;
+    //! Threads multiplying tiles, 0 for one per hardware thread.
+    unsigned int thread_count = 0;
+    //! Directory for the tiled copies of the operands and the product.
+    std::string scratch_dir = ".";
+    //! Write a binary result instead of text.
+    bool binary_output = false;
+    //! Layout of a text result.
+    MatTextFormat format = MatTextFormat::kCompact;
+};
+
+//! The output block shape, in tiles, chosen for a memory budget.
+struct OutOfCoreBlocking {
+    //! Tile rows per output block.
+    Eigen::Index block_rows;
+    //! Tile columns per output block.
+    Eigen::Index block_cols;
+};
+
+
+//! Picks the largest output block that fits the budget with double buffering.
+/*!
+  A block of b_r x b_c tiles needs b_r * b_c tiles of output plus two sets of
+  b_r A tiles and b_c B tiles (the current step and the one being loaded).
+  \param budget_tiles how many tiles fit in the memory limit
+  \param tile_rows tile rows in the product
+  \param tile_cols tile columns in the product
+  \return The block shape
+ */
+OutOfCoreBlocking ChooseOutOfCoreBlocking(Eigen::Index budget_tiles,
+                                          Eigen::Index tile_rows,
+                                          Eigen::Index tile_cols) {
+    // b^2 + 4b <= budget  =>  b <= sqrt(4 + budget) - 2
+    Eigen::Index side = static_cast<Eigen::Index>(
+        std::floor(std::sqrt(4.0 + budget_tiles) - 2.0));
+    if (side < 1) {
+        throw std::runtime_error("memory limit is too small to hold five "
+                                 "tiles; lower the tile size");
+    }
+
+    OutOfCoreBlocking blocking;
+    blocking.block_rows = std::min(side, tile_rows);
+
+    // a short product leaves room to widen the block instead
+    blocking.block_cols = std::min(
+        tile_cols,
+        (budget_tiles - 2 * blocking.block_rows) / (blocking.block_rows + 2));
+
+    return blocking;
+} // ChooseOutOfCoreBlocking
+
+//! Tiles of A and B needed by one depth step of an output block.
+struct OutOfCoreStepTiles {
+    //! block_rows tiles of A, one after another.
+    std::vector<double> a_tiles;
+    //! block_cols tiles of B, one after another.
+    std::vector<double> b_tiles;
+};
+
+//! One depth step of one output block.
+struct OutOfCoreStep {
+    //! First tile row of the output block.
+    Eigen::Index tile_row;
+    //! First tile column of the output block.
+    Eigen::Index tile_col;
+    //! Tile index along the shared dimension.
+    Eigen::Index depth;
+};
+
+//! Multiplies two tiled files into a third.
+/*!
+  \param tiled_a the left operand
+  \param tiled_b the right operand, with the same tile size
+  \param tiled_c the product, already created with the right shape
+  \param memory_limit upper bound on the bytes of tiles held at once
+  \param pool the threads multiplying tiles
+ */
+void MultiplyTiledFiles(const TiledMatFile &tiled_a,
+                        const TiledMatFile &tiled_b,
+                        const TiledMatFile &tiled_c, std::size_t memory_limit,
+                        ThreadPool &pool) {
+    const Eigen::Index tile_size = tiled_c.GetTileSize();
+    const std::size_t tile_elements =
+        static_cast<std::size_t>(tile_size * tile_size);
+    const Eigen::Index depth_tiles = tiled_a.GetTileCols();
+
+    // Create leaves C zero-filled, which is already the product when the
+    // shared dimension is empty
+    if (tiled_c.GetTileRows() == 0 || tiled_c.GetTileCols() == 0 ||
+            depth_tiles == 0) {
+        return;
+    }
+
+    const OutOfCoreBlocking blocking = ChooseOutOfCoreBlocking(
+        static_cast<Eigen::Index>(memory_limit / tiled_c.GetTileBytes()),
+        tiled_c.GetTileRows(), tiled_c.GetTileCols());
+
+    // flatten the schedule so the prefetch can run across block boundaries
+    std::vector<OutOfCoreStep> steps;
+    for (Eigen::Index tile_col = 0; tile_col < tiled_c.GetTileCols();
+            tile_col += blocking.block_cols) {
+        for (Eigen::Index tile_row = 0; tile_row < tiled_c.GetTileRows();
+                tile_row += blocking.block_rows) {
+            for (Eigen::Index depth = 0; depth < depth_tiles; depth++) {
+                steps.push_back({tile_row, tile_col, depth});
+            }
+        }
+    }
+
+    auto block_rows_at = [&](const OutOfCoreStep &step) {
+        return std::min(blocking.block_rows,
+                        tiled_c.GetTileRows() - step.tile_row);
+    };
+    auto block_cols_at = [&](const OutOfCoreStep &step) {
+        return std::min(blocking.block_cols,
+                        tiled_c.GetTileCols() - step.tile_col);
+    };
+    auto load_step = [&](const OutOfCoreStep &step, OutOfCoreStepTiles &tiles) {
+        for (Eigen::Index index = 0; index < block_rows_at(step); index++) {
+            tiled_a.ReadTile(step.tile_row + index, step.depth,
+                             tiles.a_tiles.data() + index * tile_elements);
+        }
+        for (Eigen::Index index = 0; index < block_cols_at(step); index++) {
+            tiled_b.ReadTile(step.depth, step.tile_col + index,
+                             tiles.b_tiles.data() + index * tile_elements);
+        }
+    };
+
+    OutOfCoreStepTiles current;
+    OutOfCoreStepTiles next;
+    for (OutOfCoreStepTiles *tiles : {&current, &next}) {
+        tiles->a_tiles.resize(blocking.block_rows * tile_elements);
+        tiles->b_tiles.resize(blocking.block_cols * tile_elements);
+    }
+    std::vector<double> c_block(static_cast<std::size_t>(
+        blocking.block_rows * blocking.block_cols) * tile_elements);
+
+    std::future<void> pending = std::async(std::launch::async, load_step,
+                                           std::cref(steps[0]),
+                                           std::ref(next));
+
+    for (std::size_t index = 0; index < steps.size(); index++) {
+        const OutOfCoreStep &step = steps[index];
+        const Eigen::Index block_rows = block_rows_at(step);
+        const Eigen::Index block_cols = block_cols_at(step);
+
+        pending.get();
+        std::swap(current, next);
+        if (index + 1 < steps.size()) {
+            pending = std::async(std::launch::async, load_step,
+                                 std::cref(steps[index + 1]), std::ref(next));
+        }
+
+        if (step.depth == 0) {
+            std::fill(c_block.begin(), c_block.end(), 0.0);
+        }
+
+        // every output tile of the block is an independent task
+        const Eigen::Index depth =
+            tiled_a.GetColsInTile(step.depth);
+        std::vector<std::future<void>> tile_tasks;
+        for (Eigen::Index col = 0; col < block_cols; col++) {
+            for (Eigen::Index row = 0; row < block_rows; row++) {
+                tile_tasks.push_back(pool.Submit([&, row, col, depth] {
+                    GemmBlocked(tiled_c.GetRowsInTile(step.tile_row + row),
+                                tiled_c.GetColsInTile(step.tile_col + col),
+                                depth,
+                                current.a_tiles.data() + row * tile_elements,
+                                tile_size,
+                                current.b_tiles.data() + col * tile_elements,
+                                tile_size,
+                                c_block.data() +
+                                    (row + col * blocking.block_rows) *
+                                    tile_elements,
+                                tile_size);
+                }));
+            }
+        }
+        for (std::future<void> &task : tile_tasks) {
+            task.get();
+        }
+
+        if (step.depth + 1 == depth_tiles) {
+            for (Eigen::Index col = 0; col < block_cols; col++) {
+                for (Eigen::Index row = 0; row < block_rows; row++) {
+                    tiled_c.WriteTile(step.tile_row + row,
+                                      step.tile_col + col,
+                                      c_block.data() +
+                                          (row + col * blocking.block_rows) *
+                                          tile_elements);
+                }
+            }
+        }
+    }
+} // MultiplyTiledFiles
+
+//! Writes the product of two matrix files without loading either one whole.
+/*!
+  Text and binary operands are first copied into tiled scratch files; tiled
+  operands with the requested tile size are used in place. Incompatible
+  shapes write the same error message as the in-memory product.
+  \param input_path_1 the path of the left operand
+  \param input_path_2 the path of the right operand
+  \param output_path the path of the result
+  \param options the memory ceiling, tiling and output settings
+  \throws std::runtime_error if options.tile_size is not positive
+ */
+void WriteMatProductFileOutOfCore(const std::string &input_path_1,
+                                  const std::string &input_path_2,
+                                  const std::string &output_path,
+                                  const OutOfCoreProductOptions &options = {}) {
+    CheckTileSize(options.tile_size);
+
+    const std::string kScratchPrefix = options.scratch_dir + "/" +
+        output_path.substr(output_path.find_last_of('/') + 1);
+    std::vector<std::string> scratch_files;
+
+    auto to_tiled = [&](const std::string &input_path, const char *suffix) {
+        if (IsTiledMatFile(input_path) &&
+                TiledMatFile(input_path, false).GetTileSize() ==
+                    options.tile_size) {
+            return input_path;
+        }
+
+        const std::string kTiledPath = kScratchPrefix + suffix;
+        scratch_files.push_back(kTiledPath);
+        ConvertMatFileToTiled(input_path, kTiledPath, options.tile_size,
+                              options.memory_limit);
+        return kTiledPath;
+    };
+
+    try {
+        const TiledMatFile kTiledA(to_tiled(input_path_1, ".a.tiles"), false);
+        const TiledMatFile kTiledB(to_tiled(input_path_2, ".b.tiles"), false);
+
+        if (kTiledA.GetCols() != kTiledB.GetRows()) {
+            std::ofstream mat_file;
+            mat_file.open(output_path);
+
+            mat_file << "Error: matrices have incompatible dimensions for multiplication";
+
+            mat_file.close();
+        } else {
+            const std::string kTiledCPath = kScratchPrefix + ".c.tiles";
+            scratch_files.push_back(kTiledCPath);
+
+            {
+                const TiledMatFile kTiledC = TiledMatFile::Create(
+                    kTiledCPath, kTiledA.GetRows(), kTiledB.GetCols(),
+                    options.tile_size);
+                ThreadPool pool(options.thread_count);
+
+                MultiplyTiledFiles(kTiledA, kTiledB, kTiledC,
+                                   options.memory_limit, pool);
+            }
+
+            if (options.binary_output) {
+                ConvertTiledToBinary(kTiledCPath, output_path,
+                                     options.memory_limit);
+            } else {
+                ConvertTiledToText(kTiledCPath, output_path, options.format,
+                                   options.memory_limit);
+            }
+        }
+    } catch (...) {
+        for (const std::string &scratch_file : scratch_files) {
+            std::remove(scratch_file.c_str());
+        }
+        throw;
+    }
+
+    for (const std::string &scratch_file : scratch_files) {
+        std::remove(scratch_file.c_str());
+    }
+} // WriteMatProductFileOutOfCore
+
+#endif
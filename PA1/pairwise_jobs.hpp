@@ -0,0 +1,232 @@
+#ifndef PAIRWISE_JOBS_H_
+#define PAIRWISE_JOBS_H_
+
+//!  Runs one operation over every pair of a set of matrices in parallel.
+/*!
+  \file pairwise_jobs.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Inputs are loaded once, in parallel, and then only read. Pairs whose shapes
+  the operation rejects are found before any work is queued; they get their
+  error file written directly and never reach the pool. Every compatible
+  pair is one task that computes its result and writes its own file, so the
+  output names and contents do not depend on the order tasks finish in.
+  Operations that can write into caller-owned storage draw their results
+  from a MatArena, so a long job list reuses a few buffers instead of
+  allocating one per pair.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./mat_arena.hpp"
+#include "./mat_io.hpp"
+#include "./thread_pool.hpp"
+
+
+//! An operation applied to pairs of matrices.
+struct PairwiseOperation {
+    //! Returns whether a pair can be combined at all.
+    std::function<bool(const Eigen::MatrixXd &, const Eigen::MatrixXd &)>
+        is_compatible;
+    //! Combines a compatible pair.
+    std::function<Eigen::MatrixXd(const Eigen::MatrixXd &,
+                                  const Eigen::MatrixXd &)> compute;
+    //! Optional: the rows and columns of a compatible pair's result.
+    std::function<std::pair<Eigen::Index, Eigen::Index>(
+        const Eigen::MatrixXd &, const Eigen::MatrixXd &)> result_shape;
+    //! Optional: combines a compatible pair into out, which arrives sized by
+    //! result_shape with unspecified contents. Used over compute, with
+    //! recycled buffers, when both it and result_shape are set.
+    std::function<void(Eigen::MatrixXd &, const Eigen::MatrixXd &,
+                       const Eigen::MatrixXd &)> compute_into;
+    //! Written instead of a result for an incompatible pair; empty skips
+    //! the file altogether.
+    std::string error_message;
+};
+
+//! Settings for RunPairwiseJobs.
+struct PairwiseJobOptions {
+    //! Threads running jobs, 0 for one per hardware thread.
+    unsigned int thread_count = 0;
+    //! Only visit (first, second) with first <= second, for operations where
+    //! the order of the pair does not matter.
+    bool symmetric = false;
+};
+
+//! What RunPairwiseJobs did.
+struct PairwiseJobReport {
+    //! Pairs computed and written.
+    std::size_t computed = 0;
+    //! Pairs dropped as incompatible.
+    std::size_t pruned = 0;
+};
+
+//! Names the output of a pair, such as "prefix12.txt" for (0, 1).
+/*!
+  Indices are 1-based and zero-padded to the width of the largest, so the
+  names stay unambiguous past nine inputs and match the historical
+  "out12" style below ten.
+  \param prefix the text before the indices
+  \param first the 0-based index of the left matrix
+  \param second the 0-based index of the right matrix
+  \param count the number of matrices
+  \param extension the text after the indices
+  \return The output path
+ */
+std::string MakePairOutputPath(const std::string &prefix, std::size_t first,
+                               std::size_t second, std::size_t count,
+                               const std::string &extension = ".txt") {
+    const std::size_t width = std::to_string(count).size();
+    auto pad = [width](std::size_t index) {
+        const std::string digits = std::to_string(index + 1);
+        return std::string(width - digits.size(), '0') + digits;
+    };
+
+    return prefix + pad(first) + pad(second) + extension;
+} // MakePairOutputPath
+
+//! Combines a compatible pair, drawing the result from arena if it can.
+/*!
+  \param operation the operation
+  \param input_1 the left matrix
+  \param input_2 the right matrix
+  \param arena supplies the result buffer when operation has compute_into
+  \return The result; hand it back to arena once it is no longer needed
+ */
+Eigen::MatrixXd ComputePair(const PairwiseOperation &operation,
+                            const Eigen::MatrixXd &input_1,
+                            const Eigen::MatrixXd &input_2, MatArena &arena) {
+    if (!operation.compute_into || !operation.result_shape) {
+        return operation.compute(input_1, input_2);
+    }
+
+    const std::pair<Eigen::Index, Eigen::Index> kShape =
+        operation.result_shape(input_1, input_2);
+    Eigen::MatrixXd result = arena.Acquire(kShape.first, kShape.second);
+    operation.compute_into(result, input_1, input_2);
+
+    return result;
+} // ComputePair
+
+//! Reads many matrix files in parallel.
+/*!
+  \param paths the files to read
+  \param pool the threads reading them
+  \return The matrices, in the order of paths
+ */
+std::vector<Eigen::MatrixXd> ReadMatFiles(const std::vector<std::string> &paths,
+                                          ThreadPool &pool) {
+    std::vector<Eigen::MatrixXd> matrices(paths.size());
+    std::vector<std::future<void>> reads;
+
+    for (std::size_t index = 0; index < paths.size(); index++) {
+        reads.push_back(pool.Submit([&, index] {
+            matrices[index] = ReadMatFile(paths[index]);
+        }));
+    }
+    // every read finishes before matrices can be unwound, even when one of
+    // them throws
+    for (std::future<void> &read : reads) {
+        read.wait();
+    }
+    for (std::future<void> &read : reads) {
+        read.get();
+    }
+
+    return matrices;
+} // ReadMatFiles
+
+//! Applies an operation to every pair of matrices and writes each result.
+/*!
+  \param matrices the inputs, shared read-only by every job
+  \param operation the operation and its compatibility test
+  \param output_path names the file for (first, second)
+  \param pool the threads running jobs
+  \param symmetric only visit pairs with first <= second
+  \return How many pairs were computed and pruned
+ */
+PairwiseJobReport RunPairwiseJobs(
+        const std::vector<Eigen::MatrixXd> &matrices,
+        const PairwiseOperation &operation,
+        const std::function<std::string(std::size_t, std::size_t)>
+            &output_path,
+        ThreadPool &pool, bool symmetric = false) {
+    PairwiseJobReport report;
+    // at most one live result per thread, so the arena stays small
+    MatArena arena;
+    std::vector<std::future<void>> jobs;
+
+    for (std::size_t first = 0; first < matrices.size(); first++) {
+        for (std::size_t second = symmetric ? first : 0;
+                second < matrices.size(); second++) {
+            const Eigen::MatrixXd &input_1 = matrices[first];
+            const Eigen::MatrixXd &input_2 = matrices[second];
+
+            if (!operation.is_compatible(input_1, input_2)) {
+                report.pruned++;
+                if (!operation.error_message.empty()) {
+                    std::ofstream mat_file;
+                    mat_file.open(output_path(first, second));
+
+                    mat_file << operation.error_message;
+
+                    mat_file.close();
+                }
+                continue;
+            }
+
+            report.computed++;
+            jobs.push_back(pool.Submit([&, first, second] {
+                Eigen::MatrixXd result = ComputePair(
+                    operation, matrices[first], matrices[second], arena);
+                WriteMatFile(result, output_path(first, second));
+                arena.Release(std::move(result));
+            }));
+        }
+    }
+
+    // every job finishes before the arena can be unwound; get() then
+    // rethrows the first failed job's exception
+    for (std::future<void> &job : jobs) {
+        job.wait();
+    }
+    for (std::future<void> &job : jobs) {
+        job.get();
+    }
+
+    return report;
+} // RunPairwiseJobs
+
+//! Reads matrix files and applies an operation to every pair of them.
+/*!
+  \param input_paths the matrix files
+  \param operation the operation and its compatibility test
+  \param output_path names the file for (first, second)
+  \param options the thread count and pair order
+  \return How many pairs were computed and pruned
+ */
+PairwiseJobReport RunPairwiseJobs(
+        const std::vector<std::string> &input_paths,
+        const PairwiseOperation &operation,
+        const std::function<std::string(std::size_t, std::size_t)>
+            &output_path,
+        const PairwiseJobOptions &options = {}) {
+    ThreadPool pool(options.thread_count);
+    const std::vector<Eigen::MatrixXd> kMatrices =
+        ReadMatFiles(input_paths, pool);
+
+    return RunPairwiseJobs(kMatrices, operation, output_path, pool,
+                           options.symmetric);
+} // RunPairwiseJobs
+
+#endif
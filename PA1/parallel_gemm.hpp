@@ -0,0 +1,197 @@
+#ifndef PARALLEL_GEMM_H_
+#define PARALLEL_GEMM_H_
+
+//!  Multithreaded matrix product over 2D tiles of the output.
+/*!
+  \file parallel_gemm.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  The output is cut into a grid of tiles whose shape follows the shape of the
+  product, and every tile is handed to the pool as an independent call to
+  GemmBlocked. Tiles never overlap, so the workers share nothing but the
+  read-only operands.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "./gemm.hpp"
+#include "./thread_pool.hpp"
+
+//! Products with fewer multiply-adds than this run on the calling thread.
+const double kParallelGemmMinWork = 64.0 * 64.0 * 64.0;
+
+//! Tiles queued per worker, so uneven tiles still balance out.
+const Eigen::Index kParallelGemmTilesPerThread = 4;
+
+
+//! Rounds value up to the next multiple of step.
+Eigen::Index RoundUpToMultiple(Eigen::Index value, Eigen::Index step) {
+    return (value + step - 1) / step * step;
+} // RoundUpToMultiple
+
+//! Returns a pool of thread_count workers kept for the rest of the program.
+/*!
+  Pools are started on first use, one per requested count, so repeated
+  products stop paying for thread start-up. Tasks running on the returned
+  pool must not wait on other tasks queued to it.
+  \param thread_count the number of workers, 0 for one per hardware thread
+  \return The shared pool
+ */
+ThreadPool &GetSharedGemmPool(unsigned int thread_count) {
+    static std::mutex mutex;
+    static std::map<unsigned int, std::unique_ptr<ThreadPool>> pools;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<ThreadPool> &pool = pools[thread_count];
+    if (!pool) {
+        pool = std::make_unique<ThreadPool>(thread_count);
+    }
+
+    return *pool;
+} // GetSharedGemmPool
+
+//! Computes C += A * B with a pool of threads for any GEMM operands.
+/*!
+  \param pool the pool to run tiles on
+  \param m the number of rows of A and C
+  \param n the number of columns of B and C
+  \param k the number of columns of A and rows of B
+  \param a the left operand
+  \param b the right operand
+  \param c pointer to C
+  \param ldc the leading dimension of C
+  \param blocking the cache block sizes used inside each tile
+ */
+template <typename OperandA, typename OperandB>
+void GemmParallelOperands(ThreadPool &pool, Eigen::Index m, Eigen::Index n,
+                          Eigen::Index k, const OperandA &a,
+                          const OperandB &b, double *c, Eigen::Index ldc,
+                          const GemmBlocking &blocking =
+                              kDefaultGemmBlocking) {
+    const Eigen::Index threads = pool.GetThreadCount();
+    const double work = static_cast<double>(m) * n * k;
+
+    // tiny products, like the 5x6 files from part_one, are not worth a task
+    if (threads == 1 || work < kParallelGemmMinWork) {
+        GemmBlockedOperands(m, n, k, a, b, c, ldc, blocking);
+        return;
+    }
+
+    // pick a grid whose tiles are roughly as square as the output
+    const Eigen::Index max_grid_rows = (m + kGemmMr - 1) / kGemmMr;
+    const Eigen::Index max_grid_cols = (n + kGemmNr - 1) / kGemmNr;
+    const double target_tiles =
+        static_cast<double>(threads * kParallelGemmTilesPerThread);
+
+    Eigen::Index grid_cols = static_cast<Eigen::Index>(
+        std::lround(std::sqrt(target_tiles * n / m)));
+    grid_cols = std::clamp<Eigen::Index>(grid_cols, 1, max_grid_cols);
+    Eigen::Index grid_rows = static_cast<Eigen::Index>(
+        std::ceil(target_tiles / grid_cols));
+    grid_rows = std::clamp<Eigen::Index>(grid_rows, 1, max_grid_rows);
+
+    const Eigen::Index tile_rows =
+        RoundUpToMultiple((m + grid_rows - 1) / grid_rows, kGemmMr);
+    const Eigen::Index tile_cols =
+        RoundUpToMultiple((n + grid_cols - 1) / grid_cols, kGemmNr);
+
+    std::vector<std::future<void>> tiles;
+    for (Eigen::Index col = 0; col < n; col += tile_cols) {
+        for (Eigen::Index row = 0; row < m; row += tile_rows) {
+            const Eigen::Index rows = std::min(tile_rows, m - row);
+            const Eigen::Index cols = std::min(tile_cols, n - col);
+
+            tiles.push_back(pool.Submit([=, &a, &b] {
+                GemmBlockedOperands(rows, cols, k, OffsetBy(a, row, 0),
+                                    OffsetBy(b, 0, col), c + row + col * ldc,
+                                    ldc, blocking);
+            }));
+        }
+    }
+
+    for (std::future<void> &tile : tiles) {
+        tile.get();
+    }
+} // GemmParallelOperands
+
+//! Computes C += A * B on raw column-major storage with a pool of threads.
+/*!
+  \param pool the pool to run tiles on
+  \param m the number of rows of A and C
+  \param n the number of columns of B and C
+  \param k the number of columns of A and rows of B
+  \param a pointer to A
+  \param lda the leading dimension of A
+  \param b pointer to B
+  \param ldb the leading dimension of B
+  \param c pointer to C
+  \param ldc the leading dimension of C
+  \param blocking the cache block sizes used inside each tile
+ */
+void GemmParallel(ThreadPool &pool, Eigen::Index m, Eigen::Index n,
+                  Eigen::Index k, const double *a, Eigen::Index lda,
+                  const double *b, Eigen::Index ldb,
+                  double *c, Eigen::Index ldc,
+                  const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    GemmParallelOperands(pool, m, n, k, ColMajorOperand(a, lda),
+                         ColMajorOperand(b, ldb), c, ldc, blocking);
+} // GemmParallel
+
+//! Computes product = input_1 * input_2 on a pool of threads.
+/*!
+  \param pool the pool to run tiles on
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit
+  \param blocking the cache block sizes used inside each tile
+ */
+void GemmParallel(ThreadPool &pool, const Eigen::MatrixXd &input_1,
+                  const Eigen::MatrixXd &input_2, Eigen::MatrixXd &product,
+                  const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    assert(input_1.cols() == input_2.rows());
+
+    product.setZero(input_1.rows(), input_2.cols());
+    GemmParallel(pool, input_1.rows(), input_2.cols(), input_1.cols(),
+                 input_1.data(), input_1.outerStride(),
+                 input_2.data(), input_2.outerStride(),
+                 product.data(), product.outerStride(), blocking);
+} // GemmParallel
+
+//! Computes product = input_1 * input_2 on the shared pool for thread_count.
+/*!
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit
+  \param thread_count the number of threads, 0 for one per hardware thread
+  \param blocking the cache block sizes used inside each tile
+ */
+void GemmParallel(const Eigen::MatrixXd &input_1,
+                  const Eigen::MatrixXd &input_2, Eigen::MatrixXd &product,
+                  unsigned int thread_count = 0,
+                  const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    const double work = static_cast<double>(input_1.rows()) *
+                        input_2.cols() * input_1.cols();
+
+    // the work test comes first: tiny products should not even pay for
+    // looking up the hardware thread count
+    if (work < kParallelGemmMinWork || thread_count == 1) {
+        GemmBlocked(input_1, input_2, product, blocking);
+        return;
+    }
+
+    GemmParallel(GetSharedGemmPool(thread_count), input_1, input_2, product,
+                 blocking);
+} // GemmParallel
+
+#endif
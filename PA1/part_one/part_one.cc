@@ -3,20 +3,28 @@
 // 02/06/2023
 
 #include <fstream>
+#include <iostream>
+#include <stdexcept>
 #include <string>
 
 #include <eigen3/Eigen/Dense> // Headers are located at /usr/include/eigen3
 
+#include "../arg_parse.hpp"
+#include "../mat_generator.hpp"
+#include "../mat_io.hpp"
 
-// Writes the dimensions and contents of an Eigen dynamic doubles matrix into
-// a file at the second input's file path. The method is very simple due to
-// the built-in operator overloader of "<<" in the Eigen matrix classes which
-// automatically formats and inserts the contents of a matrix object into
-// a stream.`
-void WriteMatFile(const Eigen::MatrixXd &mat,
-                  const std::string &write_file_path);
 
-int main() {
+// Runs "--generate <pattern> <rows> <cols> <output> [options]", which
+// streams a counter, random, banded or sparse matrix straight to disk.
+// Returns the program's exit code.
+int RunGenerate(int argc, char *argv[]);
+
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--generate") {
+        return RunGenerate(argc, argv);
+    }
+
     // Note to self: std::string does not count string termination characters
     // in its size() function.
     const std::string kFirstName = "Jacob";
@@ -77,14 +85,66 @@ int main() {
     return 0;
 } // main
 
-void WriteMatFile(const Eigen::MatrixXd &mat,
-                  const std::string &write_file_path) {
-    std::ofstream mat_file;
-    mat_file.open(write_file_path);
+int RunGenerate(int argc, char *argv[]) {
+    if (argc < 6) {
+        std::cerr << "Usage: " << argv[0] << " --generate "
+                  << "<counter|random|banded|sparse> <rows> <cols> <output> "
+                  << "[--seed N] [--start X] [--step X] [--column-order] "
+                  << "[--range LOW HIGH] [--bandwidth N] [--density X] "
+                  << "[--binary] [--aligned] [--threads N]" << std::endl;
+        return 1;
+    }
+
+    try {
+        MatGeneratorSpec spec;
+        spec.pattern = ParseMatPattern(argv[2]);
+        spec.rows = ParseNumberArg<Eigen::Index>("rows", argv[3]);
+        spec.cols = ParseNumberArg<Eigen::Index>("cols", argv[4]);
 
-    mat_file << mat.rows() << ' ' << mat.cols() << std::endl;
-    mat_file << std::endl;
-    mat_file << mat;
+        bool binary = false;
+        MatTextFormat format = MatTextFormat::kCompact;
+        unsigned int thread_count = 0;
+        for (int arg = 6; arg < argc; arg++) {
+            const std::string kFlag = argv[arg];
+            const bool kHasValue = arg + 1 < argc;
 
-    mat_file.close();
-} // WriteMatFile
+            if (kFlag == "--seed" && kHasValue) {
+                spec.seed = ParseNumberArg<std::uint64_t>(kFlag, argv[++arg]);
+            } else if (kFlag == "--start" && kHasValue) {
+                spec.start = ParseNumberArg<double>(kFlag, argv[++arg]);
+            } else if (kFlag == "--step" && kHasValue) {
+                spec.step = ParseNumberArg<double>(kFlag, argv[++arg]);
+            } else if (kFlag == "--column-order") {
+                spec.column_order = true;
+            } else if (kFlag == "--range" && arg + 2 < argc) {
+                spec.low = ParseNumberArg<double>(kFlag, argv[++arg]);
+                spec.high = ParseNumberArg<double>(kFlag, argv[++arg]);
+            } else if (kFlag == "--bandwidth" && kHasValue) {
+                spec.bandwidth =
+                    ParseNumberArg<Eigen::Index>(kFlag, argv[++arg]);
+            } else if (kFlag == "--density" && kHasValue) {
+                spec.density = ParseNumberArg<double>(kFlag, argv[++arg]);
+            } else if (kFlag == "--binary") {
+                binary = true;
+            } else if (kFlag == "--aligned") {
+                format = MatTextFormat::kEigenAligned;
+            } else if (kFlag == "--threads" && kHasValue) {
+                thread_count =
+                    ParseNumberArg<unsigned int>(kFlag, argv[++arg]);
+            } else {
+                throw std::runtime_error("unknown option " + kFlag);
+            }
+        }
+
+        if (binary) {
+            GenerateMatFileBinary(spec, argv[5], thread_count);
+        } else {
+            GenerateMatFileText(spec, argv[5], format, thread_count);
+        }
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunGenerate
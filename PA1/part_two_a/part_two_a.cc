@@ -4,28 +4,50 @@
 
 
 #include <fstream>
+#include <iostream>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <eigen3/Eigen/Dense> // Headers are located at /usr/include/eigen3
 
+#include "../arg_parse.hpp"
+#include "../mat_io.hpp"
+#include "../mat_operand.hpp"
+#include "../mat_pipeline.hpp"
+#include "../mat_sum.hpp"
+#include "../mixed_precision.hpp"
+#include "../streaming_reduce.hpp"
+#include "../streaming_sum.hpp"
+
 
 // Adds two matrices in a custom implementation and returns the sum.
 // Assumes input matrices can be added.
 Eigen::MatrixXd MatSumCustom(const Eigen::MatrixXd &input_1,
                              const Eigen::MatrixXd &input_2);
 
+// Adds two matrices like MatSumCustom into sum_mat, reusing its storage when
+// it already holds as many elements. Assumes input matrices can be added.
+void MatSumCustomInto(Eigen::MatrixXd &sum_mat,
+                      const Eigen::MatrixXd &input_1,
+                      const Eigen::MatrixXd &input_2);
+
+// Adds two float matrices and returns the float sum, which is within
+// 3 u_f (|A| + |B|) of the double sum (see mixed_precision.hpp).
+// Assumes input matrices can be added.
+Eigen::MatrixXf MatSumMixed(const Eigen::MatrixXf &input_1,
+                            const Eigen::MatrixXf &input_2);
+
 // Adds two matrices using Eigen and returns the sum.
 // Assumes input matrices can be added.
 Eigen::MatrixXd MatSumEigen(const Eigen::MatrixXd &input_1,
                             const Eigen::MatrixXd &input_2);
 
-// Reads the matrix at file_path’s data, creates a matrix object with that data,
-// and returns the matrix object.
-Eigen::MatrixXd ReadMatFile(const std::string &read_file_path);
-
-// Writes the contents and dimensions of an Eigen dynamic doubles matrix into a file at the second input's file path.
-void WriteMatFile(const Eigen::MatrixXd &mat,
-                  const std::string &write_file_path);
+// Adds two matrices using Eigen into sum_mat, reusing its storage when it
+// already holds as many elements. Assumes input matrices can be added.
+void MatSumEigenInto(Eigen::MatrixXd &sum_mat, const Eigen::MatrixXd &input_1,
+                     const Eigen::MatrixXd &input_2);
 
 // Write the matrix sum of the two input matrices, or an error message,
 // to a file at output_path using MatSumCustom.
@@ -33,104 +55,138 @@ void WriteMatSumFileCustom(const Eigen::MatrixXd &input_1,
                            const Eigen::MatrixXd &input_2,
                            const std::string &output_path);
 
+// Write the matrix sum of two dense or sparse matrices, or an error message,
+// to a file at output_path. Two sparse inputs give a sparse result file.
+void WriteMatSumFileCustom(const MatOperand &input_1,
+                           const MatOperand &input_2,
+                           const std::string &output_path);
+
 // Write the matrix sum of the two input matrices, or an error message,
 // to a file at output_path using MatSumEigen.
 void WriteMatSumFileEigen(const Eigen::MatrixXd &input_1,
                           const Eigen::MatrixXd &input_2,
                           const std::string &output_path);
 
+// Runs "--stream <input_1> <input_2> <output> [--memory-mib N] [--aligned]",
+// which sums two files band by band under a memory ceiling. Returns the
+// program's exit code.
+int RunStreamingSum(int argc, char *argv[]);
 
-int main() {
-    const std::string kMat1Path = "../part_one/jhartt_p1_mat1.txt";
-    const std::string kMat2Path = "../part_one/jhartt_p1_mat2.txt";
-    const std::string kMat3Path = "../part_one/jhartt_p1_mat3.txt";
-    const std::string kMat4Path = "../part_one/jhartt_p1_mat4.txt";
-    const std::string kMat5Path = "../part_one/jhartt_p1_mat5.txt";
-    const Eigen::MatrixXd k1Mat = ReadMatFile(kMat1Path);
-    const Eigen::MatrixXd k2Mat = ReadMatFile(kMat2Path);
-    const Eigen::MatrixXd k3Mat = ReadMatFile(kMat3Path);
-    const Eigen::MatrixXd k4Mat = ReadMatFile(kMat4Path);
-    const Eigen::MatrixXd k5Mat = ReadMatFile(kMat5Path);
-
-    WriteMatSumFileCustom(k1Mat, k1Mat, "jhartt_p2a_out11.txt");
-    WriteMatSumFileEigen(k1Mat, k2Mat, "jhartt_p2a_out12.txt");
-    WriteMatSumFileCustom(k1Mat, k3Mat, "jhartt_p2a_out13.txt");
-    WriteMatSumFileEigen(k1Mat, k4Mat, "jhartt_p2a_out14.txt");
-    WriteMatSumFileCustom(k1Mat, k5Mat, "jhartt_p2a_out15.txt");
-    WriteMatSumFileEigen(k2Mat, k2Mat, "jhartt_p2a_out22.txt");
-    WriteMatSumFileCustom(k2Mat, k3Mat, "jhartt_p2a_out23.txt");
-    WriteMatSumFileEigen(k2Mat, k4Mat, "jhartt_p2a_out24.txt");
-    WriteMatSumFileCustom(k2Mat, k5Mat, "jhartt_p2a_out25.txt");
-    WriteMatSumFileEigen(k3Mat, k3Mat, "jhartt_p2a_out33.txt");
-    WriteMatSumFileCustom(k3Mat, k4Mat, "jhartt_p2a_out34.txt");
-    WriteMatSumFileEigen(k3Mat, k5Mat, "jhartt_p2a_out35.txt");
-    WriteMatSumFileCustom(k4Mat, k4Mat, "jhartt_p2a_out44.txt");
-    WriteMatSumFileEigen(k4Mat, k5Mat, "jhartt_p2a_out45.txt");
-    WriteMatSumFileCustom(k5Mat, k5Mat, "jhartt_p2a_out55.txt");
+// Runs "--reduce <output> <input>... [--list FILE] [--memory-mib N]
+// [--threads N] [--aligned]", which sums any number of files, plus those
+// listed one per line in FILE, in one streaming pass. Returns the program's
+// exit code.
+int RunReduceSum(int argc, char *argv[]);
 
-    return 0;
-} // main
+// Runs "--sparse <input_1> <input_2> <output> [--density X]", which loads
+// inputs sparse when fewer than X of their elements are nonzero, else as
+// integers when they hold only integers, and adds them with the matching
+// sparse, exact integer or dense kernel. Returns the program's exit code.
+int RunSparseSum(int argc, char *argv[]);
 
-Eigen::MatrixXd MatSumCustom(const Eigen::MatrixXd &input_1,
-                             const Eigen::MatrixXd &input_2) {
-    int rows = input_1.rows();
-    int cols = input_2.cols();
-    
-    Eigen::MatrixXd sum_mat(rows, cols);
-
-    for (int row = 0; row < rows; row++) {
-        for (int col = 0; col < cols; col++) {
-            sum_mat(row, col) = input_1(row, col) + input_2(row, col);
-        }
+// Runs "--mixed <input_1> <input_2> <output>", which adds two files with
+// MatSumMixed and prints the largest deviation from the double sum next to
+// its bound. Returns the program's exit code.
+int RunMixedSum(int argc, char *argv[]);
+
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--stream") {
+        return RunStreamingSum(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--reduce") {
+        return RunReduceSum(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--sparse") {
+        return RunSparseSum(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--mixed") {
+        return RunMixedSum(argc, argv);
     }
 
-    return sum_mat;
-} // MatSumCustom
+    const std::vector<std::string> kMatPaths{
+        "../part_one/jhartt_p1_mat1.txt", "../part_one/jhartt_p1_mat2.txt",
+        "../part_one/jhartt_p1_mat3.txt", "../part_one/jhartt_p1_mat4.txt",
+        "../part_one/jhartt_p1_mat5.txt"};
+
+    PairwiseOperation sum_custom;
+    sum_custom.is_compatible = [](const Eigen::MatrixXd &input_1,
+                                  const Eigen::MatrixXd &input_2) {
+        return input_1.rows() == input_2.rows() &&
+               input_1.cols() == input_2.cols();
+    };
+    sum_custom.compute = MatSumCustom;
+    sum_custom.result_shape = [](const Eigen::MatrixXd &input_1,
+                                 const Eigen::MatrixXd &) {
+        return std::make_pair(input_1.rows(), input_1.cols());
+    };
+    sum_custom.compute_into = MatSumCustomInto;
+    sum_custom.error_message = "Error: matrices have different dimensions";
+
+    PairwiseOperation sum_eigen = sum_custom;
+    sum_eigen.compute = MatSumEigen;
+    sum_eigen.compute_into = MatSumEigenInto;
+
+    // Pairs (first, second) with first <= second, alternating between the
+    // custom and Eigen sums. Inputs are read ahead and results written
+    // behind the sum currently being computed.
+    std::vector<MatPipelineJob> jobs;
+    for (std::size_t first = 0; first < kMatPaths.size(); first++) {
+        for (std::size_t second = first; second < kMatPaths.size();
+                second++) {
+            const PairwiseOperation *operation =
+                jobs.size() % 2 == 0 ? &sum_custom : &sum_eigen;
+            jobs.push_back({first, second, operation,
+                            MakePairOutputPath("jhartt_p2a_out", first,
+                                               second, kMatPaths.size())});
+        }
+    }
 
-Eigen::MatrixXd MatSumEigen(const Eigen::MatrixXd &input_1,
-                            const Eigen::MatrixXd &input_2) {
-    return input_1 + input_2;
-} // MatSumEigen
+    try {
+        RunMatPipeline(kMatPaths, jobs);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
 
-Eigen::MatrixXd ReadMatFile(const std::string &read_file_path) {
-    std::ifstream read_file;
-    read_file.open(read_file_path);
+    return 0;
+} // main
 
-    // Makes sure the read_file actually exists, otherwise ends the program
-    assert(read_file.good());
+Eigen::MatrixXd MatSumCustom(const Eigen::MatrixXd &input_1,
+                             const Eigen::MatrixXd &input_2) {
+    Eigen::MatrixXd sum_mat;
 
-    std::string raw_rows;
-    read_file >> raw_rows;
-    int rows = std::stod(raw_rows);
+    MatSumCustomInto(sum_mat, input_1, input_2);
 
-    std::string raw_cols;
-    read_file >> raw_cols;
-    int cols = std::stod(raw_cols);
+    return sum_mat;
+} // MatSumCustom
 
-    Eigen::MatrixXd out_mat(rows, cols);
+void MatSumCustomInto(Eigen::MatrixXd &sum_mat,
+                      const Eigen::MatrixXd &input_1,
+                      const Eigen::MatrixXd &input_2) {
+    // Both inputs share a shape and Eigen's column-major order, so the sum
+    // runs over the raw storage with the widest SIMD kernel available.
+    SumContiguous(input_1, input_2, sum_mat);
+} // MatSumCustomInto
 
-    std::string raw_element = "";
-    for (int row = 0; row < rows; row++) {
-        for (int col = 0; col < cols; col++) {
-            read_file >> raw_element;
-            out_mat(row, col) = stod(raw_element);
-        }
-    }
+Eigen::MatrixXf MatSumMixed(const Eigen::MatrixXf &input_1,
+                            const Eigen::MatrixXf &input_2) {
+    Eigen::MatrixXf sum_mat;
 
-    return out_mat;
-} // ReadMatFile
+    SumMixed(input_1, input_2, sum_mat);
 
-void WriteMatFile(const Eigen::MatrixXd &mat,
-                  const std::string &write_file_path) {
-    std::ofstream mat_file;
-    mat_file.open(write_file_path);
+    return sum_mat;
+} // MatSumMixed
 
-    mat_file << mat.rows() << ' ' << mat.cols() << std::endl;
-    mat_file << std::endl;
-    mat_file << mat;
+Eigen::MatrixXd MatSumEigen(const Eigen::MatrixXd &input_1,
+                            const Eigen::MatrixXd &input_2) {
+    return input_1 + input_2;
+} // MatSumEigen
 
-    mat_file.close();
-} // WriteMatFile
+void MatSumEigenInto(Eigen::MatrixXd &sum_mat, const Eigen::MatrixXd &input_1,
+                     const Eigen::MatrixXd &input_2) {
+    sum_mat = input_1 + input_2;
+} // MatSumEigenInto
 
 void WriteMatSumFileCustom(const Eigen::MatrixXd &input_1,
                            const Eigen::MatrixXd &input_2,
@@ -148,6 +204,22 @@ void WriteMatSumFileCustom(const Eigen::MatrixXd &input_1,
     }
 } // WriteMatSumFileCustom
 
+void WriteMatSumFileCustom(const MatOperand &input_1,
+                           const MatOperand &input_2,
+                           const std::string &output_path) {
+    if (input_1.GetRows() == input_2.GetRows() &&
+            input_1.GetCols() == input_2.GetCols()) {
+        WriteMatOperand(AddMatOperands(input_1, input_2), output_path);
+    } else {
+        std::ofstream mat_file;
+        mat_file.open(output_path);
+
+        mat_file << "Error: matrices have different dimensions";
+
+        mat_file.close();
+    }
+} // WriteMatSumFileCustom
+
 void WriteMatSumFileEigen(const Eigen::MatrixXd &input_1,
                           const Eigen::MatrixXd &input_2,
                           const std::string &output_path) {
@@ -163,3 +235,136 @@ void WriteMatSumFileEigen(const Eigen::MatrixXd &input_1,
         mat_file.close();
     }
 } // WriteMatSumFileEigen
+
+int RunStreamingSum(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " --stream <input_1> <input_2> "
+                  << "<output> [--memory-mib N] [--aligned]" << std::endl;
+        return 1;
+    }
+
+    try {
+        StreamingSumOptions options;
+        for (int arg = 5; arg < argc; arg++) {
+            const std::string kFlag = argv[arg];
+
+            if (kFlag == "--memory-mib" && arg + 1 < argc) {
+                options.memory_limit = ParseMibArg(kFlag, argv[++arg]);
+            } else if (kFlag == "--aligned") {
+                options.format = MatTextFormat::kEigenAligned;
+            }
+        }
+
+        WriteMatSumFileStreaming(argv[2], argv[3], argv[4], options);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunStreamingSum
+
+int RunReduceSum(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --reduce <output> <input>... "
+                  << "[--list FILE] [--memory-mib N] [--threads N] "
+                  << "[--aligned]" << std::endl;
+        return 1;
+    }
+
+    try {
+        StreamingReduceOptions options;
+        std::vector<std::string> input_paths;
+        for (int arg = 3; arg < argc; arg++) {
+            const std::string kFlag = argv[arg];
+            const bool kHasValue = arg + 1 < argc;
+
+            if (kFlag == "--list" && kHasValue) {
+                const std::vector<std::string> kListed =
+                    ReadMatPathList(argv[++arg]);
+                input_paths.insert(input_paths.end(), kListed.begin(),
+                                   kListed.end());
+            } else if (kFlag == "--memory-mib" && kHasValue) {
+                options.memory_limit = ParseMibArg(kFlag, argv[++arg]);
+            } else if (kFlag == "--threads" && kHasValue) {
+                options.thread_count =
+                    ParseNumberArg<unsigned int>(kFlag, argv[++arg]);
+            } else if (kFlag == "--aligned") {
+                options.format = MatTextFormat::kEigenAligned;
+            } else {
+                input_paths.push_back(kFlag);
+            }
+        }
+
+        WriteMatReduceFileStreaming(input_paths, argv[2], options);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunReduceSum
+
+int RunSparseSum(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " --sparse <input_1> <input_2> "
+                  << "<output> [--density X]" << std::endl;
+        return 1;
+    }
+
+    try {
+        double density_threshold = kDefaultSparseDensity;
+        for (int arg = 5; arg < argc; arg++) {
+            if (std::string(argv[arg]) == "--density" && arg + 1 < argc) {
+                density_threshold =
+                    ParseFractionArg(argv[arg], argv[arg + 1]);
+                arg++;
+            }
+        }
+
+        WriteMatSumFileCustom(ReadMatOperand(argv[2], density_threshold),
+                              ReadMatOperand(argv[3], density_threshold),
+                              argv[4]);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunSparseSum
+
+int RunMixedSum(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " --mixed <input_1> <input_2> "
+                  << "<output>" << std::endl;
+        return 1;
+    }
+
+    try {
+        const Eigen::MatrixXd kMat1 = ReadMatFile(argv[2]);
+        const Eigen::MatrixXd kMat2 = ReadMatFile(argv[3]);
+
+        if (kMat1.rows() != kMat2.rows() || kMat1.cols() != kMat2.cols()) {
+            throw std::runtime_error("matrices have different dimensions");
+        }
+
+        const Eigen::MatrixXf kSum =
+            MatSumMixed(kMat1.cast<float>(), kMat2.cast<float>());
+        WriteMatFile(kSum, argv[4]);
+
+        const MixedDeviationReport kDeviation = MeasureMixedDeviation(
+            kSum, MatSumCustom(kMat1, kMat2),
+            MatSumCustom(kMat1.cwiseAbs(), kMat2.cwiseAbs()),
+            3.0 * kFloatUnitRoundoff);
+        std::cout << "Max deviation from double: "
+                  << kDeviation.max_abs_deviation
+                  << "\nMax deviation / (|A|+|B|): "
+                  << kDeviation.max_scaled_deviation << " (bound "
+                  << kDeviation.bound << ")" << std::endl;
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunMixedSum
@@ -4,35 +4,90 @@
 
 
 #include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <eigen3/Eigen/Dense> // Headers are located at /usr/include/eigen3
 
+#include "../arg_parse.hpp"
+#include "../gemm_tuner.hpp"
+#include "../mat_chain.hpp"
+#include "../mat_expr.hpp"
+#include "../mat_io.hpp"
+#include "../mat_operand.hpp"
+#include "../mixed_precision.hpp"
+#include "../out_of_core_product.hpp"
+#include "../pairwise_jobs.hpp"
+#include "../strassen.hpp"
+#include "../structured_gemm.hpp"
+#include "../parallel_gemm.hpp"
+
 
 // Multiplies two matrices in a custom implementation and returns the product.
-// Assumes input matrices can be multiplied.
+// The output is split into tiles across thread_count threads (0 uses every
+// hardware thread). Assumes input matrices can be multiplied.
 Eigen::MatrixXd MatProductCustom(const Eigen::MatrixXd &input_1,
-                                 const Eigen::MatrixXd &input_2);
+                                 const Eigen::MatrixXd &input_2,
+                                 unsigned int thread_count = 0);
+
+// Multiplies two matrices like MatProductCustom into product_mat, reusing its
+// storage when it already holds as many elements. Assumes input matrices can
+// be multiplied and that neither is product_mat.
+void MatProductCustomInto(Eigen::MatrixXd &product_mat,
+                          const Eigen::MatrixXd &input_1,
+                          const Eigen::MatrixXd &input_2,
+                          unsigned int thread_count = 0);
+
+// Multiplies two matrices with Strassen-Winograd recursion down to sides of
+// crossover, then the custom kernel, and returns the product. Trades a little
+// accuracy for fewer multiply-adds on large operands. Assumes input matrices
+// can be multiplied.
+Eigen::MatrixXd MatProductStrassen(const Eigen::MatrixXd &input_1,
+                                   const Eigen::MatrixXd &input_2,
+                                   Eigen::Index crossover =
+                                       kDefaultStrassenCrossover,
+                                   unsigned int thread_count = 0);
+
+// Multiplies two float matrices, accumulating in double, and returns the
+// float product. Its error bound is documented in mixed_precision.hpp.
+// Assumes input matrices can be multiplied.
+Eigen::MatrixXf MatProductMixed(const Eigen::MatrixXf &input_1,
+                                const Eigen::MatrixXf &input_2);
 
 // Multiplies two matrices using Eigen and returns the product.
 // Assumes input matrices can be multiplied.
 Eigen::MatrixXd MatProductEigen(const Eigen::MatrixXd &input_1,
                                 const Eigen::MatrixXd &input_2);
 
-// Reads the matrix at file_path’s data, creates a matrix object with that data,
-// and returns the matrix object.
-Eigen::MatrixXd ReadMatFile(const std::string &read_file_path);
-
-// Writes the contents and dimensions of an Eigen dynamic doubles matrix into a file at the second input's file path.
-void WriteMatFile(const Eigen::MatrixXd &mat,
-                  const std::string &write_file_path);
+// Multiplies two matrices using Eigen into product_mat, reusing its storage
+// when it already holds as many elements. Assumes input matrices can be
+// multiplied and that neither is product_mat.
+void MatProductEigenInto(Eigen::MatrixXd &product_mat,
+                         const Eigen::MatrixXd &input_1,
+                         const Eigen::MatrixXd &input_2);
 
 // Write the matrix product of the two input matrices, or an error message,
-// to a file at output_path using MatProductCustom.
+// to a file at output_path using the backend profile picks for their shape,
+// on at most thread_count threads (0 for no limit).
 void WriteMatProductFileCustom(const Eigen::MatrixXd &input_1,
                                const Eigen::MatrixXd &input_2,
-                               const std::string &output_path);
+                               const std::string &output_path,
+                               const GemmProfile &profile,
+                               unsigned int thread_count = 0);
+
+// Write the matrix product of two dense or sparse matrices, or an error
+// message, to a file at output_path. Two sparse inputs give a sparse result
+// file; two dense inputs are multiplied as profile says.
+void WriteMatProductFileCustom(const MatOperand &input_1,
+                               const MatOperand &input_2,
+                               const std::string &output_path,
+                               const GemmProfile &profile,
+                               unsigned int thread_count = 0);
 
 // Write the matrix prduct of the two input matrices, or an error message,
 // to a file at output_path using MatProductEigen.
@@ -40,115 +95,263 @@ void WriteMatProductFileEigen(const Eigen::MatrixXd &input_1,
                               const Eigen::MatrixXd &input_2,
                               const std::string &output_path);
 
+// Runs "--out-of-core <input_1> <input_2> <output> [--memory-mib N]
+// [--tile N] [--threads N] [--scratch DIR] [--binary] [--aligned]", which
+// multiplies two files through on-disk tiles under a memory ceiling.
+// Returns the program's exit code.
+int RunOutOfCoreProduct(int argc, char *argv[]);
+
+// Runs "--expr <expression> <output> NAME=path... [--threads N]", which
+// evaluates an expression such as "(A + B) * C - D" over the named matrix
+// files without materializing its intermediate sums.
+// Returns the program's exit code.
+int RunExpression(int argc, char *argv[]);
+
+// Runs "--chain <output> <input>... [--threads N]", which multiplies a chain
+// of matrix files in the cheapest order and reports the plan and its savings
+// against left-to-right evaluation.
+// Returns the program's exit code.
+int RunChainProduct(int argc, char *argv[]);
+
+// Runs "--strassen <input_1> <input_2> <output> [--crossover N]
+// [--threads N] [--report]", which multiplies two files with
+// MatProductStrassen and, with --report, prints its error against
+// MatProductEigen.
+// Returns the program's exit code.
+int RunStrassenProduct(int argc, char *argv[]);
+
+// Runs "--sparse <input_1> <input_2> <output> [--density X] [--threads N]
+// [--backend NAME] [--profile PATH] [--retune]", which loads inputs sparse
+// when fewer than X of their elements are nonzero, else as integers when
+// they hold only integers, and multiplies them with the matching sparse or
+// exact integer kernel, or two dense ones with the tuned backend.
+// Returns the program's exit code.
+int RunSparseProduct(int argc, char *argv[]);
+
+// Runs "--mixed <input_1> <input_2> <output>", which multiplies two files
+// with MatProductMixed and prints the largest deviation from the double
+// product next to its bound.
+// Returns the program's exit code.
+int RunMixedProduct(int argc, char *argv[]);
+
+// Runs "--gram <input> <output> [--transpose-first] [--threads N]", which
+// writes the Gram matrix A * A^T of the input, or A^T * A with
+// --transpose-first, computing only one triangle and mirroring it.
+// Returns the program's exit code.
+int RunGramProduct(int argc, char *argv[]);
+
+// Runs "--tune [--profile PATH]", which times the product backends on this
+// machine, saves the winners to PATH (DefaultGemmProfilePath() if not given)
+// and prints them.
+// Returns the program's exit code.
+int RunGemmTune(int argc, char *argv[]);
+
+// Prints a mixed-precision deviation report to standard output.
+void PrintMixedDeviation(const MixedDeviationReport &report);
+
+// Returns the product profile chosen by "--backend NAME", "--profile PATH"
+// and "--retune" in argv from first_arg on: NAME for every size if given,
+// else the profile saved at PATH (DefaultGemmProfilePath() if not given),
+// tuned and saved first when it is missing, stale or --retune is given.
+// Throws std::runtime_error for an unknown backend.
+GemmProfile ResolveGemmProfile(int argc, char *argv[], int first_arg);
+
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--out-of-core") {
+        return RunOutOfCoreProduct(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--expr") {
+        return RunExpression(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--chain") {
+        return RunChainProduct(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--strassen") {
+        return RunStrassenProduct(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--sparse") {
+        return RunSparseProduct(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--mixed") {
+        return RunMixedProduct(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--gram") {
+        return RunGramProduct(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--tune") {
+        return RunGemmTune(argc, argv);
+    }
 
-int main() {
-    const std::string kMat1Path = "../part_one/jhartt_p1_mat1.txt";
-    const std::string kMat2Path = "../part_one/jhartt_p1_mat2.txt";
-    const std::string kMat3Path = "../part_one/jhartt_p1_mat3.txt";
-    const std::string kMat4Path = "../part_one/jhartt_p1_mat4.txt";
-    const std::string kMat5Path = "../part_one/jhartt_p1_mat5.txt";
-    const Eigen::MatrixXd k1Mat = ReadMatFile(kMat1Path);
-    const Eigen::MatrixXd k2Mat = ReadMatFile(kMat2Path);
-    const Eigen::MatrixXd k3Mat = ReadMatFile(kMat3Path);
-    const Eigen::MatrixXd k4Mat = ReadMatFile(kMat4Path);
-    const Eigen::MatrixXd k5Mat = ReadMatFile(kMat5Path);
-    const std::vector<Eigen::MatrixXd> kMatArr{k1Mat, k2Mat, k3Mat,
-                                               k4Mat, k5Mat};
-
-    // The permutations of a set of 5 and a subset of 2 with repetition
-    // is implemented somewhat simply here.
-    for (int first_mat_num = 0; first_mat_num < 5; first_mat_num++) {
-        for (int second_mat_num = 0; second_mat_num < 5; second_mat_num++) {
-            std::string output_path = "jhartt_p2b_out" +
-                                      std::to_string(first_mat_num + 1) +
-                                      std::to_string(second_mat_num + 1) +
-                                      ".txt";
-            
-            // Alternate MatProduct implementations for demonstration purposes.
-            if ((first_mat_num + second_mat_num) % 2 == 0) {
-                WriteMatProductFileCustom(kMatArr[first_mat_num],
-                                          kMatArr[second_mat_num], output_path);
-            } else {
-                WriteMatProductFileEigen(kMatArr[first_mat_num],
-                                         kMatArr[second_mat_num], output_path);
+    // "--threads N" caps the threads running product jobs,
+    // "--precision single" runs them with float storage, and "--backend",
+    // "--profile" and "--retune" choose how double products are computed.
+    unsigned int thread_count = 0;
+    bool single_precision = false;
+    GemmProfile profile;
+    try {
+        for (int arg = 1; arg + 1 < argc; arg++) {
+            if (std::string(argv[arg]) == "--threads") {
+                thread_count =
+                    ParseNumberArg<unsigned int>(argv[arg], argv[arg + 1]);
+            } else if (std::string(argv[arg]) == "--precision") {
+                const std::string kPrecision = argv[arg + 1];
+                if (kPrecision != "single" && kPrecision != "double") {
+                    throw std::runtime_error("--precision: expected single "
+                                             "or double, got \"" +
+                                             kPrecision + "\"");
+                }
+                single_precision = kPrecision == "single";
             }
         }
+
+        profile = ResolveGemmProfile(argc, argv, 1);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    const std::vector<std::string> kMatPaths{
+        "../part_one/jhartt_p1_mat1.txt", "../part_one/jhartt_p1_mat2.txt",
+        "../part_one/jhartt_p1_mat3.txt", "../part_one/jhartt_p1_mat4.txt",
+        "../part_one/jhartt_p1_mat5.txt"};
+
+    // Every ordered pair is one job; pairs that cannot be multiplied only
+    // get their error file. Jobs already run side by side, so each product
+    // stays on its own thread.
+    PairwiseOperation product_operation;
+    product_operation.is_compatible = [](const Eigen::MatrixXd &input_1,
+                                         const Eigen::MatrixXd &input_2) {
+        return input_1.cols() == input_2.rows();
+    };
+    product_operation.compute = [&profile](const Eigen::MatrixXd &input_1,
+                                           const Eigen::MatrixXd &input_2) {
+        Eigen::MatrixXd product_mat;
+        GemmTuned(profile, input_1, input_2, product_mat, 1);
+        return product_mat;
+    };
+    product_operation.result_shape = [](const Eigen::MatrixXd &input_1,
+                                        const Eigen::MatrixXd &input_2) {
+        return std::make_pair(input_1.rows(), input_2.cols());
+    };
+    product_operation.compute_into = [&profile](
+            Eigen::MatrixXd &product_mat, const Eigen::MatrixXd &input_1,
+            const Eigen::MatrixXd &input_2) {
+        GemmTuned(profile, input_1, input_2, product_mat, 1);
+    };
+
+    // Single-precision jobs also compute the double product, to report the
+    // worst deviation seen across every job.
+    std::mutex deviation_mutex;
+    MixedDeviationReport worst_deviation;
+    if (single_precision) {
+        product_operation.compute = [&](const Eigen::MatrixXd &input_1,
+                                        const Eigen::MatrixXd &input_2) {
+            const Eigen::MatrixXf kProduct = MatProductMixed(
+                input_1.cast<float>(), input_2.cast<float>());
+            const MixedDeviationReport kDeviation = MeasureMixedDeviation(
+                kProduct, MatProductCustom(input_1, input_2, 1),
+                MatProductCustom(input_1.cwiseAbs(), input_2.cwiseAbs(), 1),
+                MixedErrorBound(input_1.cols()));
+
+            std::lock_guard<std::mutex> lock(deviation_mutex);
+            worst_deviation.max_abs_deviation = std::max(
+                worst_deviation.max_abs_deviation,
+                kDeviation.max_abs_deviation);
+            worst_deviation.max_scaled_deviation = std::max(
+                worst_deviation.max_scaled_deviation,
+                kDeviation.max_scaled_deviation);
+            worst_deviation.bound = std::max(worst_deviation.bound,
+                                             kDeviation.bound);
+
+            return Eigen::MatrixXd(kProduct.cast<double>());
+        };
+        product_operation.compute_into = nullptr;
+    }
+    product_operation.error_message =
+        "Error: matrices have incompatible dimensions for multiplication";
+
+    PairwiseJobOptions options;
+    options.thread_count = thread_count;
+    try {
+        RunPairwiseJobs(kMatPaths, product_operation,
+                        [&](std::size_t first, std::size_t second) {
+                            return MakePairOutputPath("jhartt_p2b_out", first,
+                                                      second,
+                                                      kMatPaths.size());
+                        },
+                        options);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    if (single_precision) {
+        PrintMixedDeviation(worst_deviation);
     }
 
     return 0;
 } // main
 
 Eigen::MatrixXd MatProductCustom(const Eigen::MatrixXd &input_1,
-                                 const Eigen::MatrixXd &input_2) {
-    Eigen::MatrixXd product_mat(input_1.rows(), input_2.cols());
-
-    for (int row = 0; row < product_mat.rows(); row++) {
-        for (int col = 0; col < product_mat.cols(); col++) {
-            int element_sum = 0;
-
-            for (int inner_index = 0; inner_index < input_1.cols();
-                    inner_index++) {
-                element_sum += input_1(row, inner_index) *
-                               input_2(inner_index, col);
-            }
+                                 const Eigen::MatrixXd &input_2,
+                                 unsigned int thread_count) {
+    Eigen::MatrixXd product_mat;
 
-            product_mat(row, col) = element_sum;
-        }
-    }
+    MatProductCustomInto(product_mat, input_1, input_2, thread_count);
 
     return product_mat;
 } // MatProductCustom
 
-Eigen::MatrixXd MatProductEigen(const Eigen::MatrixXd &input_1,
-                                const Eigen::MatrixXd &input_2) {
-    return input_1 * input_2;
-} // MatProductEigen
-
-Eigen::MatrixXd ReadMatFile(const std::string &read_file_path) {
-    std::ifstream read_file;
-    read_file.open(read_file_path);
+void MatProductCustomInto(Eigen::MatrixXd &product_mat,
+                          const Eigen::MatrixXd &input_1,
+                          const Eigen::MatrixXd &input_2,
+                          unsigned int thread_count) {
+    // The packed, cache-blocked kernel replaces the old row-by-column loop,
+    // which walked input_2 down its columns and summed into an int. Small
+    // products stay on this thread; large ones are tiled across a pool.
+    GemmParallel(input_1, input_2, product_mat, thread_count);
+} // MatProductCustomInto
 
-    // Makes sure the read_file actually exists, otherwise ends the program
-    assert(read_file.good());
+Eigen::MatrixXd MatProductStrassen(const Eigen::MatrixXd &input_1,
+                                   const Eigen::MatrixXd &input_2,
+                                   Eigen::Index crossover,
+                                   unsigned int thread_count) {
+    Eigen::MatrixXd product_mat;
 
-    std::string raw_rows;
-    read_file >> raw_rows;
-    int rows = std::stod(raw_rows);
+    GemmStrassen(input_1, input_2, product_mat, crossover, thread_count);
 
-    std::string raw_cols;
-    read_file >> raw_cols;
-    int cols = std::stod(raw_cols);
-
-    Eigen::MatrixXd out_mat(rows, cols);
+    return product_mat;
+} // MatProductStrassen
 
-    std::string raw_element = "";
-    for (int row = 0; row < rows; row++) {
-        for (int col = 0; col < cols; col++) {
-            read_file >> raw_element;
-            out_mat(row, col) = stod(raw_element);
-        }
-    }
+Eigen::MatrixXf MatProductMixed(const Eigen::MatrixXf &input_1,
+                                const Eigen::MatrixXf &input_2) {
+    Eigen::MatrixXf product_mat;
 
-    return out_mat;
-} // ReadMatFile
+    GemmMixed(input_1, input_2, product_mat);
 
-void WriteMatFile(const Eigen::MatrixXd &mat,
-                  const std::string &write_file_path) {
-    std::ofstream mat_file;
-    mat_file.open(write_file_path);
+    return product_mat;
+} // MatProductMixed
 
-    mat_file << mat.rows() << ' ' << mat.cols() << std::endl;
-    mat_file << std::endl;
-    mat_file << mat;
+Eigen::MatrixXd MatProductEigen(const Eigen::MatrixXd &input_1,
+                                const Eigen::MatrixXd &input_2) {
+    return input_1 * input_2;
+} // MatProductEigen
 
-    mat_file.close();
-} // WriteMatFile
+void MatProductEigenInto(Eigen::MatrixXd &product_mat,
+                         const Eigen::MatrixXd &input_1,
+                         const Eigen::MatrixXd &input_2) {
+    product_mat.noalias() = input_1 * input_2;
+} // MatProductEigenInto
 
 void WriteMatProductFileCustom(const Eigen::MatrixXd &input_1,
                                const Eigen::MatrixXd &input_2,
-                               const std::string &output_path) {
+                               const std::string &output_path,
+                               const GemmProfile &profile,
+                               unsigned int thread_count) {
     if (input_1.cols() == input_2.rows()) {
-        Eigen::MatrixXd product_mat = MatProductCustom(input_1, input_2);
+        Eigen::MatrixXd product_mat;
+        GemmTuned(profile, input_1, input_2, product_mat, thread_count);
         WriteMatFile(product_mat, output_path);
     } else {
         std::ofstream mat_file;
@@ -160,6 +363,27 @@ void WriteMatProductFileCustom(const Eigen::MatrixXd &input_1,
     }
 } // WriteMatProductFileCustom
 
+void WriteMatProductFileCustom(const MatOperand &input_1,
+                               const MatOperand &input_2,
+                               const std::string &output_path,
+                               const GemmProfile &profile,
+                               unsigned int thread_count) {
+    if (input_1.IsDense() && input_2.IsDense()) {
+        WriteMatProductFileCustom(input_1.GetDense(), input_2.GetDense(),
+                                  output_path, profile, thread_count);
+    } else if (input_1.GetCols() == input_2.GetRows()) {
+        WriteMatOperand(MultiplyMatOperands(input_1, input_2, thread_count),
+                        output_path);
+    } else {
+        std::ofstream mat_file;
+        mat_file.open(output_path);
+
+        mat_file << "Error: matrices have incompatible dimensions for multiplication";
+
+        mat_file.close();
+    }
+} // WriteMatProductFileCustom
+
 void WriteMatProductFileEigen(const Eigen::MatrixXd &input_1,
                               const Eigen::MatrixXd &input_2,
                               const std::string &output_path) {
@@ -175,3 +399,353 @@ void WriteMatProductFileEigen(const Eigen::MatrixXd &input_1,
         mat_file.close();
     }
 } // WriteMatProductFileEigen
+
+int RunOutOfCoreProduct(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " --out-of-core <input_1> "
+                  << "<input_2> <output> [--memory-mib N] [--tile N] "
+                  << "[--threads N] [--scratch DIR] [--binary] [--aligned]"
+                  << std::endl;
+        return 1;
+    }
+
+    try {
+        OutOfCoreProductOptions options;
+        for (int arg = 5; arg < argc; arg++) {
+            const std::string kFlag = argv[arg];
+            const bool kHasValue = arg + 1 < argc;
+
+            if (kFlag == "--memory-mib" && kHasValue) {
+                options.memory_limit = ParseMibArg(kFlag, argv[++arg]);
+            } else if (kFlag == "--tile" && kHasValue) {
+                options.tile_size =
+                    ParseNumberArg<Eigen::Index>(kFlag, argv[++arg]);
+            } else if (kFlag == "--threads" && kHasValue) {
+                options.thread_count =
+                    ParseNumberArg<unsigned int>(kFlag, argv[++arg]);
+            } else if (kFlag == "--scratch" && kHasValue) {
+                options.scratch_dir = argv[++arg];
+            } else if (kFlag == "--binary") {
+                options.binary_output = true;
+            } else if (kFlag == "--aligned") {
+                options.format = MatTextFormat::kEigenAligned;
+            }
+        }
+
+        WriteMatProductFileOutOfCore(argv[2], argv[3], argv[4], options);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunOutOfCoreProduct
+
+int RunExpression(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --expr <expression> <output> "
+                  << "NAME=path... [--threads N]" << std::endl;
+        return 1;
+    }
+
+    try {
+        unsigned int thread_count = 0;
+        std::map<std::string, Eigen::MatrixXd> matrices;
+        for (int arg = 4; arg < argc; arg++) {
+            const std::string kArg = argv[arg];
+            const std::size_t kEquals = kArg.find('=');
+
+            if (kArg == "--threads" && arg + 1 < argc) {
+                thread_count = ParseNumberArg<unsigned int>(kArg, argv[++arg]);
+            } else if (kEquals == std::string::npos || kEquals == 0) {
+                throw std::runtime_error("expected NAME=path, got '" + kArg +
+                                         "'");
+            } else {
+                matrices[kArg.substr(0, kEquals)] =
+                    ReadMatFile(kArg.substr(kEquals + 1));
+            }
+        }
+
+        const MatExpr kExpr = ParseMatExpr(argv[2], matrices);
+        WriteMatFile(EvaluateMatExpr(kExpr, thread_count), argv[3]);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunExpression
+
+int RunChainProduct(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --chain <output> <input>... "
+                  << "[--threads N]" << std::endl;
+        return 1;
+    }
+
+    try {
+        unsigned int thread_count = 0;
+        std::vector<std::string> input_paths;
+        for (int arg = 3; arg < argc; arg++) {
+            if (std::string(argv[arg]) == "--threads" && arg + 1 < argc) {
+                thread_count =
+                    ParseNumberArg<unsigned int>(argv[arg], argv[arg + 1]);
+                arg++;
+            } else {
+                input_paths.push_back(argv[arg]);
+            }
+        }
+
+        std::vector<Eigen::MatrixXd> matrices;
+        matrices.reserve(input_paths.size());
+        std::vector<const Eigen::MatrixXd *> chain;
+        for (const std::string &input_path : input_paths) {
+            matrices.push_back(ReadMatFile(input_path));
+            chain.push_back(&matrices.back());
+        }
+
+        MatChainPlan plan;
+        const Eigen::MatrixXd kProduct =
+            MultiplyMatChain(chain, thread_count, &plan);
+        WriteMatFile(kProduct, argv[2]);
+
+        const double kSavings = plan.left_to_right_flops > 0.0
+            ? 100.0 * (1.0 - plan.optimal_flops / plan.left_to_right_flops)
+            : 0.0;
+        std::cout << "Plan: " << FormatMatChainPlan(plan) << "\n"
+                  << "FLOPs: " << plan.optimal_flops << " (left to right: "
+                  << plan.left_to_right_flops << ", saved " << kSavings
+                  << "%)" << std::endl;
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunChainProduct
+
+int RunStrassenProduct(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " --strassen <input_1> "
+                  << "<input_2> <output> [--crossover N] [--threads N] "
+                  << "[--report]" << std::endl;
+        return 1;
+    }
+
+    try {
+        Eigen::Index crossover = kDefaultStrassenCrossover;
+        unsigned int thread_count = 0;
+        bool report = false;
+        for (int arg = 5; arg < argc; arg++) {
+            const std::string kFlag = argv[arg];
+            const bool kHasValue = arg + 1 < argc;
+
+            if (kFlag == "--crossover" && kHasValue) {
+                crossover = ParseNumberArg<Eigen::Index>(kFlag, argv[++arg]);
+            } else if (kFlag == "--threads" && kHasValue) {
+                thread_count =
+                    ParseNumberArg<unsigned int>(kFlag, argv[++arg]);
+            } else if (kFlag == "--report") {
+                report = true;
+            }
+        }
+
+        const Eigen::MatrixXd kMat1 = ReadMatFile(argv[2]);
+        const Eigen::MatrixXd kMat2 = ReadMatFile(argv[3]);
+
+        if (kMat1.cols() != kMat2.rows()) {
+            throw std::runtime_error(
+                "matrices have incompatible dimensions for multiplication");
+        }
+
+        const Eigen::MatrixXd kProduct =
+            MatProductStrassen(kMat1, kMat2, crossover, thread_count);
+        WriteMatFile(kProduct, argv[4]);
+
+        if (report) {
+            const ProductErrorReport kError =
+                CompareProducts(kProduct, MatProductEigen(kMat1, kMat2));
+            std::cout << "Levels: "
+                      << CountStrassenLevels(kMat1.rows(), kMat1.cols(),
+                                             kMat2.cols(), crossover)
+                      << "\nMax abs error: " << kError.max_abs_error
+                      << "\nMax rel error: " << kError.max_rel_error
+                      << "\nFrobenius rel error: "
+                      << kError.frobenius_rel_error << std::endl;
+        }
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunStrassenProduct
+
+int RunSparseProduct(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " --sparse <input_1> <input_2> "
+                  << "<output> [--density X] [--threads N] [--backend NAME] "
+                  << "[--profile PATH] [--retune]" << std::endl;
+        return 1;
+    }
+
+    try {
+        double density_threshold = kDefaultSparseDensity;
+        unsigned int thread_count = 0;
+        for (int arg = 5; arg < argc; arg++) {
+            const std::string kFlag = argv[arg];
+            const bool kHasValue = arg + 1 < argc;
+
+            if (kFlag == "--density" && kHasValue) {
+                density_threshold = ParseFractionArg(kFlag, argv[++arg]);
+            } else if (kFlag == "--threads" && kHasValue) {
+                thread_count =
+                    ParseNumberArg<unsigned int>(kFlag, argv[++arg]);
+            }
+        }
+
+        const GemmProfile kProfile = ResolveGemmProfile(argc, argv, 5);
+        WriteMatProductFileCustom(ReadMatOperand(argv[2], density_threshold),
+                                  ReadMatOperand(argv[3], density_threshold),
+                                  argv[4], kProfile, thread_count);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunSparseProduct
+
+int RunMixedProduct(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " --mixed <input_1> <input_2> "
+                  << "<output>" << std::endl;
+        return 1;
+    }
+
+    try {
+        const Eigen::MatrixXd kMat1 = ReadMatFile(argv[2]);
+        const Eigen::MatrixXd kMat2 = ReadMatFile(argv[3]);
+
+        if (kMat1.cols() != kMat2.rows()) {
+            throw std::runtime_error(
+                "matrices have incompatible dimensions for multiplication");
+        }
+
+        const Eigen::MatrixXf kProduct =
+            MatProductMixed(kMat1.cast<float>(), kMat2.cast<float>());
+        WriteMatFile(kProduct, argv[4]);
+
+        PrintMixedDeviation(MeasureMixedDeviation(
+            kProduct, MatProductCustom(kMat1, kMat2),
+            MatProductCustom(kMat1.cwiseAbs(), kMat2.cwiseAbs()),
+            MixedErrorBound(kMat1.cols())));
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunMixedProduct
+
+int RunGramProduct(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --gram <input> <output> "
+                  << "[--transpose-first] [--threads N]" << std::endl;
+        return 1;
+    }
+
+    try {
+        bool transpose_first = false;
+        unsigned int thread_count = 0;
+        for (int arg = 4; arg < argc; arg++) {
+            const std::string kFlag = argv[arg];
+
+            if (kFlag == "--transpose-first") {
+                transpose_first = true;
+            } else if (kFlag == "--threads" && arg + 1 < argc) {
+                thread_count =
+                    ParseNumberArg<unsigned int>(kFlag, argv[++arg]);
+            }
+        }
+
+        Eigen::MatrixXd gram_mat;
+        GemmGram(ReadMatFile(argv[2]), transpose_first, gram_mat,
+                 thread_count);
+        WriteMatFile(gram_mat, argv[3]);
+    } catch (const std::runtime_error &error) {
+        std::cerr << "Error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+} // RunGramProduct
+
+int RunGemmTune(int argc, char *argv[]) {
+    std::string profile_path = DefaultGemmProfilePath();
+    for (int arg = 2; arg < argc; arg++) {
+        const std::string kFlag = argv[arg];
+        const bool kHasValue = arg + 1 < argc;
+
+        if (kFlag == "--profile" && kHasValue) {
+            profile_path = argv[++arg];
+        }
+    }
+
+    const GemmProfile kProfile = LoadGemmProfile(profile_path, true);
+    std::cout << "Machine: " << kProfile.machine
+              << "\nProfile: " << profile_path
+              << "\n" << FormatGemmConfigLine("small", kProfile.small)
+              << "\n" << FormatGemmConfigLine("large", kProfile.large)
+              << std::endl;
+
+    return 0;
+} // RunGemmTune
+
+void PrintMixedDeviation(const MixedDeviationReport &report) {
+    std::cout << "Max deviation from double: " << report.max_abs_deviation
+              << "\nMax deviation / (|A||B|): "
+              << report.max_scaled_deviation << " (bound " << report.bound
+              << ")" << std::endl;
+} // PrintMixedDeviation
+
+GemmProfile ResolveGemmProfile(int argc, char *argv[], int first_arg) {
+    std::string backend;
+    std::string profile_path = DefaultGemmProfilePath();
+    bool retune = false;
+    for (int arg = first_arg; arg < argc; arg++) {
+        const std::string kFlag = argv[arg];
+        const bool kHasValue = arg + 1 < argc;
+
+        if (kFlag == "--backend" && kHasValue) {
+            backend = argv[++arg];
+        } else if (kFlag == "--profile" && kHasValue) {
+            profile_path = argv[++arg];
+        } else if (kFlag == "--retune") {
+            retune = true;
+        }
+    }
+
+    if (!backend.empty()) {
+        FindGemmBackend(backend);
+
+        GemmProfile forced;
+        forced.machine = DescribeMachine();
+        forced.small.backend = backend;
+        forced.large.backend = backend;
+        return forced;
+    }
+
+    bool tuned = false;
+    const GemmProfile kProfile = LoadGemmProfile(profile_path, retune, {},
+                                                 &tuned);
+    if (tuned) {
+        GemmProfile saved;
+        std::clog << "Tuned products for this machine; "
+                  << (ReadGemmProfile(profile_path, saved) ? "saved to "
+                                                           : "cannot save ")
+                  << profile_path << std::endl;
+    }
+
+    return kProfile;
+} // ResolveGemmProfile
@@ -0,0 +1,371 @@
+#ifndef SPARSE_MAT_H_
+#define SPARSE_MAT_H_
+
+//!  Compressed sparse row matrices and the kernels that work on them.
+/*!
+  \file sparse_mat.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  A CSR matrix keeps only its nonzeros: for every row, the columns and values
+  of its nonzeros in increasing column order, with row_offsets marking where
+  each row starts. Work and memory scale with the nonzeros instead of
+  rows * cols, which is what makes 95%-zero inputs cheap.
+
+  Products use Gustavson's row-by-row algorithm, the sparse sum merges rows,
+  and the mixed products walk whichever operand keeps the dense side's
+  column-major accesses contiguous.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+//! Inputs with fewer nonzeros than this fraction are loaded as sparse.
+const double kDefaultSparseDensity = 0.05;
+
+
+//! A matrix in compressed sparse row form.
+struct CsrMatrix {
+    //! Number of rows.
+    Eigen::Index rows = 0;
+    //! Number of columns.
+    Eigen::Index cols = 0;
+    //! rows + 1 offsets; row r's nonzeros are at
+    //! [row_offsets[r], row_offsets[r + 1]).
+    std::vector<Eigen::Index> row_offsets{0};
+    //! Column of each nonzero, increasing within a row.
+    std::vector<Eigen::Index> col_indices;
+    //! Value of each nonzero.
+    std::vector<double> values;
+
+    //! Returns the number of stored nonzeros.
+    Eigen::Index GetNonZeros() const {
+        return static_cast<Eigen::Index>(values.size());
+    } // GetNonZeros
+};
+
+//! One nonzero given by position, as read from a coordinate file.
+struct SparseTriplet {
+    //! 0-based row.
+    Eigen::Index row;
+    //! 0-based column.
+    Eigen::Index col;
+    //! The value.
+    double value;
+};
+
+
+//! Counts the nonzero elements of a dense matrix.
+template <typename Derived>
+Eigen::Index CountNonZeros(const Eigen::DenseBase<Derived> &mat) {
+    Eigen::Index count = 0;
+
+    for (Eigen::Index col = 0; col < mat.cols(); col++) {
+        for (Eigen::Index row = 0; row < mat.rows(); row++) {
+            count += mat(row, col) != 0.0;
+        }
+    }
+
+    return count;
+} // CountNonZeros
+
+//! Returns the fraction of a matrix's elements that are nonzero.
+/*!
+  \param non_zeros the number of nonzeros
+  \param rows the number of rows
+  \param cols the number of columns
+  \return The density, 1 for an empty matrix so it is never called sparse
+ */
+double ComputeDensity(Eigen::Index non_zeros, Eigen::Index rows,
+                      Eigen::Index cols) {
+    if (rows == 0 || cols == 0) {
+        return 1.0;
+    }
+
+    return static_cast<double>(non_zeros) /
+           (static_cast<double>(rows) * static_cast<double>(cols));
+} // ComputeDensity
+
+//! Compresses a dense matrix, dropping its zeros.
+/*!
+  Both passes walk the dense matrix down its columns, in storage order;
+  visiting columns in order is what keeps each row's columns sorted.
+  \param mat the dense matrix
+  \return The same matrix in CSR form
+ */
+template <typename Derived>
+CsrMatrix DenseToCsr(const Eigen::DenseBase<Derived> &mat) {
+    CsrMatrix csr;
+    csr.rows = mat.rows();
+    csr.cols = mat.cols();
+    csr.row_offsets.assign(static_cast<std::size_t>(csr.rows) + 1, 0);
+
+    for (Eigen::Index col = 0; col < mat.cols(); col++) {
+        for (Eigen::Index row = 0; row < mat.rows(); row++) {
+            csr.row_offsets[row + 1] += mat(row, col) != 0.0;
+        }
+    }
+    for (Eigen::Index row = 0; row < csr.rows; row++) {
+        csr.row_offsets[row + 1] += csr.row_offsets[row];
+    }
+
+    csr.col_indices.resize(static_cast<std::size_t>(csr.row_offsets.back()));
+    csr.values.resize(csr.col_indices.size());
+    std::vector<Eigen::Index> next(csr.row_offsets.begin(),
+                                   csr.row_offsets.end() - 1);
+
+    for (Eigen::Index col = 0; col < mat.cols(); col++) {
+        for (Eigen::Index row = 0; row < mat.rows(); row++) {
+            const double value = mat(row, col);
+            if (value != 0.0) {
+                csr.col_indices[next[row]] = col;
+                csr.values[next[row]] = value;
+                next[row]++;
+            }
+        }
+    }
+
+    return csr;
+} // DenseToCsr
+
+//! Expands a CSR matrix back to a dense one.
+Eigen::MatrixXd CsrToDense(const CsrMatrix &csr) {
+    Eigen::MatrixXd dense = Eigen::MatrixXd::Zero(csr.rows, csr.cols);
+
+    for (Eigen::Index row = 0; row < csr.rows; row++) {
+        for (Eigen::Index index = csr.row_offsets[row];
+                index < csr.row_offsets[row + 1]; index++) {
+            dense(row, csr.col_indices[index]) = csr.values[index];
+        }
+    }
+
+    return dense;
+} // CsrToDense
+
+//! Builds a CSR matrix from nonzeros in any order.
+/*!
+  Repeated positions are summed, as coordinate formats specify, and
+  explicit zeros are dropped.
+  \param rows the number of rows
+  \param cols the number of columns
+  \param triplets the nonzeros, reordered in place
+  \return The CSR matrix
+ */
+CsrMatrix TripletsToCsr(Eigen::Index rows, Eigen::Index cols,
+                        std::vector<SparseTriplet> &triplets) {
+    std::sort(triplets.begin(), triplets.end(),
+              [](const SparseTriplet &left, const SparseTriplet &right) {
+        return left.row != right.row ? left.row < right.row
+                                     : left.col < right.col;
+    });
+
+    CsrMatrix csr;
+    csr.rows = rows;
+    csr.cols = cols;
+    csr.row_offsets.assign(static_cast<std::size_t>(rows) + 1, 0);
+
+    for (std::size_t index = 0; index < triplets.size(); ) {
+        const SparseTriplet &first = triplets[index];
+        double value = 0.0;
+        for (; index < triplets.size() && triplets[index].row == first.row &&
+                   triplets[index].col == first.col; index++) {
+            value += triplets[index].value;
+        }
+
+        if (value != 0.0) {
+            csr.col_indices.push_back(first.col);
+            csr.values.push_back(value);
+            csr.row_offsets[first.row + 1]++;
+        }
+    }
+    for (Eigen::Index row = 0; row < rows; row++) {
+        csr.row_offsets[row + 1] += csr.row_offsets[row];
+    }
+
+    return csr;
+} // TripletsToCsr
+
+//! Computes the sparse product of two CSR matrices.
+/*!
+  Gustavson's algorithm: row r of the product is the sum of the rows of
+  right selected by row r of left, gathered in a dense accumulator that is
+  only ever touched at the columns it has seen.
+  \param left the left operand
+  \param right the right operand, with left.cols rows
+  \return The product in CSR form
+ */
+CsrMatrix MultiplyCsr(const CsrMatrix &left, const CsrMatrix &right) {
+    assert(left.cols == right.rows);
+
+    CsrMatrix product;
+    product.rows = left.rows;
+    product.cols = right.cols;
+    product.row_offsets.assign(static_cast<std::size_t>(left.rows) + 1, 0);
+
+    std::vector<double> accumulator(static_cast<std::size_t>(right.cols), 0.0);
+    std::vector<bool> occupied(accumulator.size(), false);
+    std::vector<Eigen::Index> touched;
+
+    for (Eigen::Index row = 0; row < left.rows; row++) {
+        for (Eigen::Index index = left.row_offsets[row];
+                index < left.row_offsets[row + 1]; index++) {
+            const Eigen::Index inner = left.col_indices[index];
+            const double scale = left.values[index];
+
+            for (Eigen::Index other = right.row_offsets[inner];
+                    other < right.row_offsets[inner + 1]; other++) {
+                const Eigen::Index col = right.col_indices[other];
+                if (!occupied[col]) {
+                    occupied[col] = true;
+                    touched.push_back(col);
+                }
+                accumulator[col] += scale * right.values[other];
+            }
+        }
+
+        std::sort(touched.begin(), touched.end());
+        for (Eigen::Index col : touched) {
+            if (accumulator[col] != 0.0) {
+                product.col_indices.push_back(col);
+                product.values.push_back(accumulator[col]);
+            }
+            accumulator[col] = 0.0;
+            occupied[col] = false;
+        }
+        touched.clear();
+
+        product.row_offsets[row + 1] =
+            static_cast<Eigen::Index>(product.values.size());
+    }
+
+    return product;
+} // MultiplyCsr
+
+//! Computes the dense product of a CSR matrix and a dense matrix.
+/*!
+  Each output column is a set of sparse dot products against one contiguous
+  column of right.
+  \param left the sparse left operand
+  \param right the dense right operand, with left.cols rows
+  \return The dense product
+ */
+Eigen::MatrixXd MultiplyCsrDense(const CsrMatrix &left,
+                                 const Eigen::MatrixXd &right) {
+    assert(left.cols == right.rows());
+
+    Eigen::MatrixXd product(left.rows, right.cols());
+    for (Eigen::Index col = 0; col < right.cols(); col++) {
+        const double *right_col = right.data() + col * right.outerStride();
+
+        for (Eigen::Index row = 0; row < left.rows; row++) {
+            double sum = 0.0;
+            for (Eigen::Index index = left.row_offsets[row];
+                    index < left.row_offsets[row + 1]; index++) {
+                sum += left.values[index] * right_col[left.col_indices[index]];
+            }
+            product(row, col) = sum;
+        }
+    }
+
+    return product;
+} // MultiplyCsrDense
+
+//! Computes the dense product of a dense matrix and a CSR matrix.
+/*!
+  Every nonzero (k, j) of right adds a scaled copy of column k of left into
+  column j of the product, so both dense accesses are whole columns.
+  \param left the dense left operand
+  \param right the sparse right operand, with left.cols() rows
+  \return The dense product
+ */
+Eigen::MatrixXd MultiplyDenseCsr(const Eigen::MatrixXd &left,
+                                 const CsrMatrix &right) {
+    assert(left.cols() == right.rows);
+
+    Eigen::MatrixXd product = Eigen::MatrixXd::Zero(left.rows(), right.cols);
+    for (Eigen::Index inner = 0; inner < right.rows; inner++) {
+        for (Eigen::Index index = right.row_offsets[inner];
+                index < right.row_offsets[inner + 1]; index++) {
+            product.col(right.col_indices[index]) +=
+                right.values[index] * left.col(inner);
+        }
+    }
+
+    return product;
+} // MultiplyDenseCsr
+
+//! Computes the sparse sum of two CSR matrices of the same shape.
+/*!
+  Each output row is a merge of two sorted rows. Entries that cancel to
+  zero are dropped.
+  \param left the first operand
+  \param right the second operand
+  \return The sum in CSR form
+ */
+CsrMatrix AddCsr(const CsrMatrix &left, const CsrMatrix &right) {
+    assert(left.rows == right.rows && left.cols == right.cols);
+
+    CsrMatrix sum;
+    sum.rows = left.rows;
+    sum.cols = left.cols;
+    sum.row_offsets.assign(static_cast<std::size_t>(left.rows) + 1, 0);
+    sum.col_indices.reserve(left.col_indices.size() +
+                            right.col_indices.size());
+    sum.values.reserve(sum.col_indices.capacity());
+
+    auto push = [&sum](Eigen::Index col, double value) {
+        if (value != 0.0) {
+            sum.col_indices.push_back(col);
+            sum.values.push_back(value);
+        }
+    };
+
+    for (Eigen::Index row = 0; row < left.rows; row++) {
+        Eigen::Index index_1 = left.row_offsets[row];
+        Eigen::Index index_2 = right.row_offsets[row];
+        const Eigen::Index end_1 = left.row_offsets[row + 1];
+        const Eigen::Index end_2 = right.row_offsets[row + 1];
+
+        while (index_1 < end_1 || index_2 < end_2) {
+            const Eigen::Index col_1 =
+                index_1 < end_1 ? left.col_indices[index_1] : left.cols;
+            const Eigen::Index col_2 =
+                index_2 < end_2 ? right.col_indices[index_2] : right.cols;
+
+            if (col_1 == col_2) {
+                push(col_1, left.values[index_1++] + right.values[index_2++]);
+            } else if (col_1 < col_2) {
+                push(col_1, left.values[index_1++]);
+            } else {
+                push(col_2, right.values[index_2++]);
+            }
+        }
+
+        sum.row_offsets[row + 1] =
+            static_cast<Eigen::Index>(sum.values.size());
+    }
+
+    return sum;
+} // AddCsr
+
+//! Computes the dense sum of a CSR matrix and a dense matrix.
+Eigen::MatrixXd AddCsrDense(const CsrMatrix &left,
+                            const Eigen::MatrixXd &right) {
+    assert(left.rows == right.rows() && left.cols == right.cols());
+
+    Eigen::MatrixXd sum = right;
+    for (Eigen::Index row = 0; row < left.rows; row++) {
+        for (Eigen::Index index = left.row_offsets[row];
+                index < left.row_offsets[row + 1]; index++) {
+            sum(row, left.col_indices[index]) += left.values[index];
+        }
+    }
+
+    return sum;
+} // AddCsrDense
+
+#endif
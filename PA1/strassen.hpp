@@ -0,0 +1,231 @@
+#ifndef STRASSEN_H_
+#define STRASSEN_H_
+
+//!  Strassen-Winograd matrix product over the blocked classical kernel.
+/*!
+  \file strassen.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Each level of the Winograd form of Strassen's algorithm trades one of the
+  eight half-size products for fifteen half-size additions, so a product that
+  recurses L levels does (7/8)^L of the classical multiply-adds. Operands are
+  zero-padded once, up front, so every level splits evenly; recursion stops
+  when a side reaches the crossover and hands the rest to GemmBlocked.
+
+  The additions cost accuracy: the error bound grows with the number of
+  levels instead of staying at the classical one. CompareProducts measures
+  the loss against a reference so each job can decide if it is acceptable.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "./gemm.hpp"
+#include "./thread_pool.hpp"
+
+//! Sides at or below this go to the classical kernel instead of recursing.
+const Eigen::Index kDefaultStrassenCrossover = 512;
+
+//! A read-only block of a column-major matrix.
+typedef Eigen::Ref<const Eigen::MatrixXd> ConstMatBlock;
+//! A writable block of a column-major matrix.
+typedef Eigen::Ref<Eigen::MatrixXd> MatBlock;
+
+
+//! How far a Strassen-Winograd product differs from a reference product.
+struct ProductErrorReport {
+    //! Largest absolute elementwise difference.
+    double max_abs_error = 0.0;
+    //! max_abs_error divided by the largest reference magnitude.
+    double max_rel_error = 0.0;
+    //! Frobenius norm of the difference over that of the reference.
+    double frobenius_rel_error = 0.0;
+};
+
+//! Counts the levels of recursion a product will use.
+/*!
+  \param m the rows of the product
+  \param k the shared dimension
+  \param n the columns of the product
+  \param crossover the largest side handed to the classical kernel
+  \return The number of times every side is halved
+ */
+int CountStrassenLevels(Eigen::Index m, Eigen::Index k, Eigen::Index n,
+                        Eigen::Index crossover) {
+    const Eigen::Index smallest = std::min({m, k, n});
+    int levels = 0;
+
+    while ((smallest >> levels) > std::max<Eigen::Index>(crossover, 1)) {
+        levels++;
+    }
+
+    return levels;
+} // CountStrassenLevels
+
+//! Multiplies blocks whose sides are divisible by 2^levels.
+/*!
+  \param a the left operand
+  \param b the right operand
+  \param c the product, overwritten
+  \param levels how many more times to halve the operands
+  \param pool runs the seven subproducts of this level, if not null
+ */
+void StrassenWinograd(const ConstMatBlock &a, const ConstMatBlock &b,
+                      MatBlock c, int levels, ThreadPool *pool = nullptr) {
+    if (levels == 0) {
+        c.setZero();
+        GemmBlocked(c.rows(), c.cols(), a.cols(), a.data(), a.outerStride(),
+                    b.data(), b.outerStride(), c.data(), c.outerStride());
+        return;
+    }
+
+    const Eigen::Index m = a.rows() / 2;
+    const Eigen::Index k = a.cols() / 2;
+    const Eigen::Index n = b.cols() / 2;
+
+    const ConstMatBlock a11 = a.topLeftCorner(m, k);
+    const ConstMatBlock a12 = a.topRightCorner(m, k);
+    const ConstMatBlock a21 = a.bottomLeftCorner(m, k);
+    const ConstMatBlock a22 = a.bottomRightCorner(m, k);
+    const ConstMatBlock b11 = b.topLeftCorner(k, n);
+    const ConstMatBlock b12 = b.topRightCorner(k, n);
+    const ConstMatBlock b21 = b.bottomLeftCorner(k, n);
+    const ConstMatBlock b22 = b.bottomRightCorner(k, n);
+
+    const Eigen::MatrixXd s1 = a21 + a22;
+    const Eigen::MatrixXd s2 = s1 - a11;
+    const Eigen::MatrixXd s3 = a11 - a21;
+    const Eigen::MatrixXd s4 = a12 - s2;
+    const Eigen::MatrixXd t1 = b12 - b11;
+    const Eigen::MatrixXd t2 = b22 - t1;
+    const Eigen::MatrixXd t3 = b22 - b12;
+    const Eigen::MatrixXd t4 = t2 - b21;
+
+    std::vector<Eigen::MatrixXd> products(7, Eigen::MatrixXd(m, n));
+    const ConstMatBlock left[7] = {a11, a12, s4, a22, s1, s2, s3};
+    const ConstMatBlock right[7] = {b11, b21, b22, t4, t1, t2, t3};
+
+    if (pool != nullptr) {
+        std::vector<std::future<void>> tasks;
+        for (int index = 0; index < 7; index++) {
+            tasks.push_back(pool->Submit([&, index] {
+                StrassenWinograd(left[index], right[index], products[index],
+                                 levels - 1);
+            }));
+        }
+        for (std::future<void> &task : tasks) {
+            task.get();
+        }
+    } else {
+        for (int index = 0; index < 7; index++) {
+            StrassenWinograd(left[index], right[index], products[index],
+                             levels - 1);
+        }
+    }
+
+    // U2 = M1 + M6, U3 = U2 + M7, U4 = U2 + M5
+    Eigen::MatrixXd &u2 = products[5];
+    u2 += products[0];
+    products[6] += u2;
+    u2 += products[4];
+
+    c.topLeftCorner(m, n) = products[0] + products[1];
+    c.topRightCorner(m, n) = u2 + products[2];
+    c.bottomLeftCorner(m, n) = products[6] - products[3];
+    c.bottomRightCorner(m, n) = products[6] + products[4];
+} // StrassenWinograd
+
+//! Computes product = input_1 * input_2 with Strassen-Winograd recursion.
+/*!
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit
+  \param crossover the largest side handed to the classical kernel
+  \param thread_count threads for the top-level subproducts, 0 for one per
+                      hardware thread
+ */
+void GemmStrassen(const Eigen::MatrixXd &input_1,
+                  const Eigen::MatrixXd &input_2, Eigen::MatrixXd &product,
+                  Eigen::Index crossover = kDefaultStrassenCrossover,
+                  unsigned int thread_count = 0) {
+    const Eigen::Index m = input_1.rows();
+    const Eigen::Index k = input_1.cols();
+    const Eigen::Index n = input_2.cols();
+    const int levels = CountStrassenLevels(m, k, n, crossover);
+
+    if (levels == 0) {
+        GemmBlocked(input_1, input_2, product);
+        return;
+    }
+
+    // pad every side to a multiple of 2^levels so each split is exact
+    const Eigen::Index step = Eigen::Index(1) << levels;
+    const Eigen::Index padded_m = (m + step - 1) / step * step;
+    const Eigen::Index padded_k = (k + step - 1) / step * step;
+    const Eigen::Index padded_n = (n + step - 1) / step * step;
+
+    Eigen::MatrixXd padded_1;
+    Eigen::MatrixXd padded_2;
+    if (padded_m != m || padded_k != k) {
+        padded_1.setZero(padded_m, padded_k);
+        padded_1.topLeftCorner(m, k) = input_1;
+    }
+    if (padded_k != k || padded_n != n) {
+        padded_2.setZero(padded_k, padded_n);
+        padded_2.topLeftCorner(k, n) = input_2;
+    }
+
+    Eigen::MatrixXd padded_product(padded_m, padded_n);
+    std::unique_ptr<ThreadPool> pool;
+    if (ResolveThreadCount(thread_count) > 1) {
+        pool = std::make_unique<ThreadPool>(thread_count);
+    }
+
+    StrassenWinograd(padded_1.size() > 0 ? padded_1 : input_1,
+                     padded_2.size() > 0 ? padded_2 : input_2, padded_product,
+                     levels, pool.get());
+
+    if (padded_m == m && padded_n == n) {
+        product.swap(padded_product);
+    } else {
+        product = padded_product.topLeftCorner(m, n);
+    }
+} // GemmStrassen
+
+//! Measures how far a product is from a reference product.
+/*!
+  \param product the product under test
+  \param reference the product to compare against, of the same shape
+  \return The absolute, relative and Frobenius errors
+ */
+ProductErrorReport CompareProducts(const Eigen::MatrixXd &product,
+                                   const Eigen::MatrixXd &reference) {
+    ProductErrorReport report;
+    if (reference.size() == 0) {
+        return report;
+    }
+
+    report.max_abs_error = (product - reference).cwiseAbs().maxCoeff();
+
+    const double reference_max = reference.cwiseAbs().maxCoeff();
+    if (reference_max > 0.0) {
+        report.max_rel_error = report.max_abs_error / reference_max;
+    }
+
+    const double reference_norm = reference.norm();
+    if (reference_norm > 0.0) {
+        report.frobenius_rel_error =
+            (product - reference).norm() / reference_norm;
+    }
+
+    return report;
+} // CompareProducts
+
+#endif
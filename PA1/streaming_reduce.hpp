@@ -0,0 +1,416 @@
+#ifndef STREAMING_REDUCE_H_
+#define STREAMING_REDUCE_H_
+
+//!  Out-of-core sum of any number of matrix files in a single pass.
+/*!
+  \file streaming_reduce.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  Chaining two-file sums over N inputs writes and rereads N - 1 intermediate
+  files. Here every input is read once, a band at a time, and only the final
+  bands are written. Each input is reopened for every band where the last
+  band stopped, so thousands of inputs cost no more open files or read
+  windows than there are threads.
+
+  Within a band, consecutive runs of kReduceLeafInputs inputs are summed in
+  order by pool threads, and the run totals are merged pairwise in input
+  order, like carries in a binary counter. The tree's shape depends only on
+  the number of inputs, so the result is the same for every thread count,
+  and rounding error grows with the tree's depth instead of with N.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./mat_io.hpp"
+#include "./mat_stream.hpp"
+#include "./mat_sum.hpp"
+#include "./mat_text_writer.hpp"
+#include "./streaming_sum.hpp"
+#include "./thread_pool.hpp"
+
+//! Inputs one thread sums in sequence before the partial joins the tree.
+const std::size_t kReduceLeafInputs = 8;
+
+//! Read window for each text input reopened per band. Bytes past the band
+//! are read again next band, so it is kept small.
+const std::size_t kReduceWindowSize = std::size_t(64) << 10;
+
+//! Settings for WriteMatReduceFileStreaming.
+struct StreamingReduceOptions {
+    //! Upper bound on the bytes of buffers held at once.
+    std::size_t memory_limit = kDefaultStreamingMemoryLimit;
+    //! Threads summing inputs; 0 for one per hardware thread.
+    unsigned int thread_count = 0;
+    //! Layout of text output. kEigenAligned needs the widest element before
+    //! writing, so it reads every input twice.
+    MatTextFormat format = MatTextFormat::kCompact;
+};
+
+
+//! Returns how many band buffers a reduction of leaf_count leaves holds.
+/*!
+  Each thread holds a read buffer and a leaf partial, the merge stack holds
+  at most one partial per bit of leaf_count, and one more holds the total.
+  \param leaf_count the number of leaves
+  \param thread_count the number of threads summing leaves
+  \return The number of buffers
+ */
+std::size_t CountReduceBuffers(std::size_t leaf_count,
+                               unsigned int thread_count) {
+    std::size_t depth = 0;
+    for (std::size_t leaves = leaf_count; leaves > 0; leaves >>= 1) {
+        depth++;
+    }
+
+    return 2 * static_cast<std::size_t>(thread_count) + depth + 1;
+} // CountReduceBuffers
+
+//! Class that sums one band of many inputs at a time with a fixed tree.
+class BandReducer {
+  public:
+    //! Prepares to reduce input_count inputs on pool's threads.
+    /*!
+      \param input_count the number of inputs, at least 1
+      \param pool the threads that sum leaves
+     */
+    BandReducer(std::size_t input_count, ThreadPool &pool)
+        : input_count_(input_count),
+          pool_(pool),
+          reads_(pool.GetThreadCount()),
+          partials_(pool.GetThreadCount()) {} // constructor
+
+    //! Sums one band of every input.
+    /*!
+      \param elements the number of doubles in this band
+      \param read_input called as read_input(input, out) from pool threads to
+                        fill out with this band of the given input
+      \return The summed band, valid until the next call
+     */
+    template <typename ReadInput>
+    const double *Reduce(std::size_t elements, ReadInput read_input) {
+        const std::size_t leaf_count =
+            (input_count_ + kReduceLeafInputs - 1) / kReduceLeafInputs;
+        const std::size_t slots = partials_.size();
+
+        for (std::vector<double> &buffer : reads_) {
+            buffer.resize(std::max(buffer.size(), elements));
+        }
+
+        for (std::size_t wave = 0; wave < leaf_count; wave += slots) {
+            const std::size_t wave_leaves =
+                std::min(slots, leaf_count - wave);
+
+            std::vector<std::future<void>> sums;
+            for (std::size_t slot = 0; slot < wave_leaves; slot++) {
+                if (partials_[slot].size() < elements) {
+                    partials_[slot] = Take(elements);
+                }
+
+                const std::size_t first = (wave + slot) * kReduceLeafInputs;
+                const std::size_t last =
+                    std::min(first + kReduceLeafInputs, input_count_);
+                double *partial = partials_[slot].data();
+                double *read = reads_[slot].data();
+
+                sums.push_back(pool_.Submit([=, &read_input] {
+                    read_input(first, partial);
+                    for (std::size_t input = first + 1; input < last;
+                            input++) {
+                        read_input(input, read);
+                        SumContiguous(partial, read, partial, elements);
+                    }
+                }));
+            }
+
+            // every leaf must finish before an exception leaves this frame,
+            // since the tasks point into this object's buffers
+            for (std::future<void> &sum : sums) {
+                sum.wait();
+            }
+            for (std::size_t slot = 0; slot < wave_leaves; slot++) {
+                sums[slot].get();
+                Push(std::move(partials_[slot]), elements);
+            }
+        }
+
+        // fold what is left on the stack, later (smaller) partials first
+        while (stack_.size() > 1) {
+            Merge(elements);
+        }
+
+        Give(std::move(total_));
+        total_ = std::move(stack_.back().second);
+        stack_.clear();
+        return total_.data();
+    } // Reduce
+
+  private:
+    //! Returns an idle buffer of at least elements doubles.
+    std::vector<double> Take(std::size_t elements) {
+        std::vector<double> buffer;
+        if (!idle_.empty()) {
+            buffer = std::move(idle_.back());
+            idle_.pop_back();
+        }
+
+        buffer.resize(std::max(buffer.size(), elements));
+        return buffer;
+    } // Take
+
+    //! Keeps a buffer for a later Take.
+    void Give(std::vector<double> &&buffer) {
+        if (!buffer.empty()) {
+            idle_.push_back(std::move(buffer));
+        }
+    } // Give
+
+    //! Adds a leaf partial, merging equal-sized subtrees as it goes.
+    void Push(std::vector<double> &&partial, std::size_t elements) {
+        stack_.emplace_back(0, std::move(partial));
+        while (stack_.size() > 1 &&
+                stack_.back().first == stack_[stack_.size() - 2].first) {
+            Merge(elements);
+        }
+    } // Push
+
+    //! Adds the top of the stack into the entry below it.
+    void Merge(std::size_t elements) {
+        std::pair<std::size_t, std::vector<double>> later =
+            std::move(stack_.back());
+        stack_.pop_back();
+
+        std::pair<std::size_t, std::vector<double>> &earlier = stack_.back();
+        SumContiguous(earlier.second.data(), later.second.data(),
+                      earlier.second.data(), elements);
+        earlier.first = std::max(earlier.first, later.first) + 1;
+        Give(std::move(later.second));
+    } // Merge
+
+    std::size_t input_count_;
+    ThreadPool &pool_;
+    std::vector<std::vector<double>> reads_;
+    std::vector<std::vector<double>> partials_;
+    std::vector<std::vector<double>> idle_;
+    std::vector<std::pair<std::size_t, std::vector<double>>> stack_;
+    std::vector<double> total_;
+};
+
+//! Streams the band-by-band sum of many text files to a callback.
+/*!
+  \param input_paths the text operands
+  \param starts each input's position just past its header
+  \param band_rows the most rows summed at once
+  \param pool the threads that sum leaves
+  \param on_band called with each summed band and the index of its first row
+ */
+template <typename BandCallback>
+void ForEachTextReduceBand(const std::vector<std::string> &input_paths,
+                           const std::vector<MatTextStreamPosition> &starts,
+                           Eigen::Index band_rows, ThreadPool &pool,
+                           BandCallback on_band) {
+    const Eigen::Index rows = starts.front().rows;
+    const Eigen::Index cols = starts.front().cols;
+    std::vector<MatTextStreamPosition> positions = starts;
+    BandReducer reducer(input_paths.size(), pool);
+
+    for (Eigen::Index row = 0; row < rows; row += band_rows) {
+        const Eigen::Index count = std::min(band_rows, rows - row);
+        const bool kLastBand = row + count == rows;
+
+        const double *band = reducer.Reduce(
+            static_cast<std::size_t>(count * cols),
+            [&](std::size_t input, double *out) {
+            MatTextStreamReader reader(input_paths[input], positions[input],
+                                       kReduceWindowSize);
+            reader.ReadRows(count, out);
+            if (kLastBand) {
+                reader.ExpectEnd();
+            }
+            positions[input] = reader.GetPosition();
+        });
+
+        // row-major bands of equal shape are still just flat arrays
+        on_band(RowBand(band, count, cols), row);
+    }
+} // ForEachTextReduceBand
+
+//! Sums many text matrix files into a text file, band by band.
+void WriteTextReduceStreaming(const std::vector<std::string> &input_paths,
+                              const std::string &output_path,
+                              const StreamingReduceOptions &options) {
+    std::vector<MatTextStreamPosition> starts;
+    starts.reserve(input_paths.size());
+    for (const std::string &input_path : input_paths) {
+        starts.push_back(
+            MatTextStreamReader(input_path, kReduceWindowSize).GetPosition());
+
+        if (starts.back().rows != starts.front().rows ||
+                starts.back().cols != starts.front().cols) {
+            WriteSumShapeError(output_path);
+            return;
+        }
+    }
+
+    const std::size_t leaf_count =
+        (input_paths.size() + kReduceLeafInputs - 1) / kReduceLeafInputs;
+    const unsigned int thread_count = static_cast<unsigned int>(
+        std::min<std::size_t>(ResolveThreadCount(options.thread_count),
+                              leaf_count));
+
+    const std::size_t budget = SubtractFixedCost(
+        options.memory_limit,
+        thread_count * kReduceWindowSize + kMatWriterBufferSize);
+    const Eigen::Index band_rows =
+        FindBandRows(starts.front().cols,
+                     CountReduceBuffers(leaf_count, thread_count), budget);
+
+    ThreadPool pool(thread_count);
+
+    // Eigen pads every element to the widest one, which is only known once
+    // the whole sum has been seen
+    std::size_t width = 0;
+    if (options.format == MatTextFormat::kEigenAligned) {
+        ForEachTextReduceBand(input_paths, starts, band_rows, pool,
+                              [&width](const RowBand &band, Eigen::Index) {
+            width = std::max(width, FindStreamDefaultWidth(band));
+        });
+    }
+
+    MatTextWriter writer(output_path);
+    WriteMatTextHeader(starts.front().rows, starts.front().cols, writer);
+
+    ForEachTextReduceBand(input_paths, starts, band_rows, pool,
+                          [&](const RowBand &band, Eigen::Index first_row) {
+        WriteMatTextRows(band, first_row, width, writer, options.format);
+    });
+
+    writer.Close();
+} // WriteTextReduceStreaming
+
+//! Sums many binary matrix files into a binary file, chunk by chunk.
+void WriteBinaryReduceStreaming(const std::vector<std::string> &input_paths,
+                                const std::string &output_path,
+                                const StreamingReduceOptions &options) {
+    const BinaryMatHeader kHeader =
+        MatBinaryStreamReader(input_paths.front()).GetHeader();
+    for (const std::string &input_path : input_paths) {
+        const BinaryMatHeader kInputHeader =
+            MatBinaryStreamReader(input_path).GetHeader();
+
+        if (kInputHeader.rows != kHeader.rows ||
+                kInputHeader.cols != kHeader.cols) {
+            WriteSumShapeError(output_path);
+            return;
+        }
+        if (kInputHeader.flags != kHeader.flags) {
+            throw std::runtime_error("streaming reductions need every "
+                                     "operand in the same storage order");
+        }
+    }
+
+    const std::size_t leaf_count =
+        (input_paths.size() + kReduceLeafInputs - 1) / kReduceLeafInputs;
+    const unsigned int thread_count = static_cast<unsigned int>(
+        std::min<std::size_t>(ResolveThreadCount(options.thread_count),
+                              leaf_count));
+
+    // all files share one storage order, so rows do not matter at all
+    const std::uint64_t elements = kHeader.rows * kHeader.cols;
+    const std::uint64_t chunk_elements = std::max<std::size_t>(
+        options.memory_limit / (CountReduceBuffers(leaf_count, thread_count) *
+                                sizeof(double)), 1);
+
+    ThreadPool pool(thread_count);
+    BandReducer reducer(input_paths.size(), pool);
+    MatBinaryStreamWriter writer(output_path,
+                                 static_cast<Eigen::Index>(kHeader.rows),
+                                 static_cast<Eigen::Index>(kHeader.cols),
+                                 GetBinaryMatLayout(kHeader));
+
+    for (std::uint64_t first = 0; first < elements; first += chunk_elements) {
+        const std::uint64_t count =
+            std::min<std::uint64_t>(chunk_elements, elements - first);
+
+        const double *chunk = reducer.Reduce(
+            static_cast<std::size_t>(count),
+            [&](std::size_t input, double *out) {
+            MatBinaryStreamReader reader(input_paths[input]);
+            reader.SkipElements(first);
+            reader.ReadElements(count, out);
+        });
+        writer.WriteElements(chunk, count);
+    }
+
+    writer.Close();
+} // WriteBinaryReduceStreaming
+
+//! Writes the sum of many matrix files without loading any one whole.
+/*!
+  Memory stays within options.memory_limit however many inputs there are:
+  bands shrink as threads are added, not as inputs are. Text inputs produce
+  a text output and binary inputs a binary output. Shape mismatches write
+  the same error message as the two-file sum.
+  \param input_paths the paths of the operands, at least one
+  \param output_path the path of the result
+  \param options the memory ceiling, threads and text layout
+ */
+void WriteMatReduceFileStreaming(const std::vector<std::string> &input_paths,
+                                 const std::string &output_path,
+                                 const StreamingReduceOptions &options = {}) {
+    if (input_paths.empty()) {
+        throw std::runtime_error("a streaming reduction needs at least one "
+                                 "input");
+    }
+
+    const bool binary = IsBinaryMatFile(input_paths.front());
+    for (const std::string &input_path : input_paths) {
+        if (IsBinaryMatFile(input_path) != binary) {
+            throw std::runtime_error("streaming reductions need every "
+                                     "operand in the same format");
+        }
+    }
+
+    if (binary) {
+        WriteBinaryReduceStreaming(input_paths, output_path, options);
+    } else {
+        WriteTextReduceStreaming(input_paths, output_path, options);
+    }
+} // WriteMatReduceFileStreaming
+
+//! Reads a list of matrix file paths, one per line, skipping blank lines.
+/*!
+  \param list_path the path of the list
+  \return The paths in file order
+ */
+std::vector<std::string> ReadMatPathList(const std::string &list_path) {
+    std::ifstream list_file(list_path);
+    if (!list_file) {
+        throw std::runtime_error(list_path + ": cannot open file");
+    }
+
+    std::vector<std::string> paths;
+    std::string line;
+    while (std::getline(list_file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            paths.push_back(line);
+        }
+    }
+
+    return paths;
+} // ReadMatPathList
+
+#endif
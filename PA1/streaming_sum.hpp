@@ -0,0 +1,249 @@
+#ifndef STREAMING_SUM_H_
+#define STREAMING_SUM_H_
+
+//!  Out-of-core matrix sum that never holds more than a fixed budget.
+/*!
+  \file streaming_sum.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  An elementwise sum only ever needs matching pieces of its two operands, so
+  both files are read a band of rows at a time, added with the SIMD sum
+  kernel and written out before the next band is read.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "./mat_io.hpp"
+#include "./mat_stream.hpp"
+#include "./mat_sum.hpp"
+#include "./mat_text_writer.hpp"
+
+//! Memory ceiling used when none is given: 256 MiB.
+const std::size_t kDefaultStreamingMemoryLimit = std::size_t(256) << 20;
+
+//! Settings for WriteMatSumFileStreaming.
+struct StreamingSumOptions {
+    //! Upper bound on the bytes of buffers held at once.
+    std::size_t memory_limit = kDefaultStreamingMemoryLimit;
+    //! Layout of text output. kEigenAligned needs the widest element before
+    //! writing, so it reads both inputs twice.
+    MatTextFormat format = MatTextFormat::kCompact;
+};
+
+//! A band of rows in row-major order, as read from a text file.
+typedef Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
+                                       Eigen::RowMajor>> RowBand;
+
+
+//! Works out how many rows of cols doubles fit in a budget.
+/*!
+  \param cols the number of columns per row
+  \param buffers how many band buffers share the budget
+  \param budget the bytes available for the band buffers
+  \return The number of rows per band, at least 1
+ */
+Eigen::Index FindBandRows(Eigen::Index cols, std::size_t buffers,
+                          std::size_t budget) {
+    const std::size_t row_bytes =
+        static_cast<std::size_t>(std::max<Eigen::Index>(cols, 1)) *
+        sizeof(double) * buffers;
+
+    if (budget < row_bytes) {
+        throw std::runtime_error("memory limit is too small to hold one row "
+                                 "of each operand");
+    }
+
+    return static_cast<Eigen::Index>(budget / row_bytes);
+} // FindBandRows
+
+//! Subtracts fixed costs from a memory limit, failing if nothing is left.
+/*!
+  \param memory_limit the whole budget
+  \param fixed_cost bytes taken by read windows and write buffers
+  \return The bytes left for band buffers
+ */
+std::size_t SubtractFixedCost(std::size_t memory_limit,
+                              std::size_t fixed_cost) {
+    if (memory_limit <= fixed_cost) {
+        throw std::runtime_error("memory limit is smaller than the " +
+                                 std::to_string(fixed_cost) +
+                                 " bytes of I/O buffers");
+    }
+
+    return memory_limit - fixed_cost;
+} // SubtractFixedCost
+
+//! Writes the error message used when the operands' shapes differ.
+void WriteSumShapeError(const std::string &output_path) {
+    std::ofstream mat_file;
+    mat_file.open(output_path);
+
+    mat_file << "Error: matrices have different dimensions";
+
+    mat_file.close();
+} // WriteSumShapeError
+
+//! Streams the band-by-band sum of two text files to a callback.
+/*!
+  \param input_path_1 the first text operand
+  \param input_path_2 the second text operand
+  \param band_rows the most rows summed at once
+  \param on_band called with each summed band and the index of its first row
+ */
+template <typename BandCallback>
+void ForEachTextSumBand(const std::string &input_path_1,
+                        const std::string &input_path_2,
+                        Eigen::Index band_rows, BandCallback on_band) {
+    MatTextStreamReader reader_1(input_path_1);
+    MatTextStreamReader reader_2(input_path_2);
+    const Eigen::Index cols = reader_1.GetCols();
+
+    std::vector<double> band_1(static_cast<std::size_t>(band_rows * cols));
+    std::vector<double> band_2(band_1.size());
+
+    for (Eigen::Index row = 0; row < reader_1.GetRows(); row += band_rows) {
+        const Eigen::Index rows = std::min(band_rows, reader_1.GetRows() - row);
+        reader_1.ReadRows(rows, band_1.data());
+        reader_2.ReadRows(rows, band_2.data());
+
+        // row-major bands of equal shape are still just flat arrays
+        SumContiguous(band_1.data(), band_2.data(), band_1.data(),
+                      static_cast<std::size_t>(rows * cols));
+        on_band(RowBand(band_1.data(), rows, cols), row);
+    }
+
+    reader_1.ExpectEnd();
+    reader_2.ExpectEnd();
+} // ForEachTextSumBand
+
+//! Sums two text matrix files into a text file, band by band.
+void WriteTextSumStreaming(const std::string &input_path_1,
+                           const std::string &input_path_2,
+                           const std::string &output_path,
+                           const StreamingSumOptions &options) {
+    Eigen::Index rows = 0;
+    Eigen::Index cols = 0;
+    {
+        MatTextStreamReader reader_1(input_path_1);
+        MatTextStreamReader reader_2(input_path_2);
+
+        if (reader_1.GetRows() != reader_2.GetRows() ||
+                reader_1.GetCols() != reader_2.GetCols()) {
+            WriteSumShapeError(output_path);
+            return;
+        }
+
+        rows = reader_1.GetRows();
+        cols = reader_1.GetCols();
+    }
+
+    const std::size_t budget = SubtractFixedCost(
+        options.memory_limit, 2 * kMatStreamWindowSize + kMatWriterBufferSize);
+    const Eigen::Index band_rows = FindBandRows(cols, 2, budget);
+
+    // Eigen pads every element to the widest one, which is only known once
+    // the whole sum has been seen
+    std::size_t width = 0;
+    if (options.format == MatTextFormat::kEigenAligned) {
+        ForEachTextSumBand(input_path_1, input_path_2, band_rows,
+                           [&width](const RowBand &band, Eigen::Index) {
+            width = std::max(width, FindStreamDefaultWidth(band));
+        });
+    }
+
+    MatTextWriter writer(output_path);
+    WriteMatTextHeader(rows, cols, writer);
+
+    ForEachTextSumBand(input_path_1, input_path_2, band_rows,
+                       [&](const RowBand &band, Eigen::Index first_row) {
+        WriteMatTextRows(band, first_row, width, writer, options.format);
+    });
+
+    writer.Close();
+} // WriteTextSumStreaming
+
+//! Sums two binary matrix files into a binary file, chunk by chunk.
+void WriteBinarySumStreaming(const std::string &input_path_1,
+                             const std::string &input_path_2,
+                             const std::string &output_path,
+                             const StreamingSumOptions &options) {
+    MatBinaryStreamReader reader_1(input_path_1);
+    MatBinaryStreamReader reader_2(input_path_2);
+    const BinaryMatHeader &header_1 = reader_1.GetHeader();
+    const BinaryMatHeader &header_2 = reader_2.GetHeader();
+
+    if (header_1.rows != header_2.rows || header_1.cols != header_2.cols) {
+        WriteSumShapeError(output_path);
+        return;
+    }
+    if (reader_1.GetLayout() != reader_2.GetLayout()) {
+        throw std::runtime_error("streaming sums need both operands in the "
+                                 "same storage order");
+    }
+
+    // both files share one storage order, so rows do not matter at all
+    const std::uint64_t chunk_elements =
+        std::max<std::size_t>(options.memory_limit / (2 * sizeof(double)), 1);
+    std::vector<double> chunk_1(static_cast<std::size_t>(
+        std::min<std::uint64_t>(chunk_elements, reader_1.GetElementsLeft())));
+    std::vector<double> chunk_2(chunk_1.size());
+
+    MatBinaryStreamWriter writer(output_path,
+                                 static_cast<Eigen::Index>(header_1.rows),
+                                 static_cast<Eigen::Index>(header_1.cols),
+                                 reader_1.GetLayout());
+
+    while (reader_1.GetElementsLeft() > 0) {
+        const std::uint64_t count =
+            std::min<std::uint64_t>(chunk_1.size(), reader_1.GetElementsLeft());
+        reader_1.ReadElements(count, chunk_1.data());
+        reader_2.ReadElements(count, chunk_2.data());
+
+        SumContiguous(chunk_1.data(), chunk_2.data(), chunk_1.data(),
+                      static_cast<std::size_t>(count));
+        writer.WriteElements(chunk_1.data(), count);
+    }
+
+    writer.Close();
+} // WriteBinarySumStreaming
+
+//! Writes the sum of two matrix files without loading either one whole.
+/*!
+  Text inputs produce a text output and binary inputs a binary output. Shape
+  mismatches write the same error message as the in-memory sum.
+  \param input_path_1 the path of the first operand
+  \param input_path_2 the path of the second operand
+  \param output_path the path of the result
+  \param options the memory ceiling and text layout
+ */
+void WriteMatSumFileStreaming(const std::string &input_path_1,
+                              const std::string &input_path_2,
+                              const std::string &output_path,
+                              const StreamingSumOptions &options = {}) {
+    const bool binary_1 = IsBinaryMatFile(input_path_1);
+    const bool binary_2 = IsBinaryMatFile(input_path_2);
+
+    if (binary_1 != binary_2) {
+        throw std::runtime_error("streaming sums need both operands in the "
+                                 "same format");
+    }
+
+    if (binary_1) {
+        WriteBinarySumStreaming(input_path_1, input_path_2, output_path,
+                                options);
+    } else {
+        WriteTextSumStreaming(input_path_1, input_path_2, output_path,
+                              options);
+    }
+} // WriteMatSumFileStreaming
+
+#endif
@@ -0,0 +1,473 @@
+#ifndef STRUCTURED_GEMM_H_
+#define STRUCTURED_GEMM_H_
+
+//!  Products that skip the work an operand's structure makes redundant.
+/*!
+  \file structured_gemm.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  A Gram matrix A * A^T is symmetric, so only the micro-tiles touching its
+  lower triangle are computed and then mirrored: about half the FLOPs of a
+  general product. Triangular operands skip the depth slabs that only meet
+  their zero half, also about half, and diagonal operands reduce to scaling
+  rows or columns. Both run the packed kernel through GemmBlockedMasked, so
+  every element that is computed matches the general product bit for bit.
+  Transposed operands are read in place through a StridedOperand rather than
+  copied first.
+
+  MultiplyIfStructured detects these cases exactly, at O(n^2) cost that
+  usually stops at the first few elements of a dense operand. Like BLAS
+  TRMM, the skipped products are assumed to be zero, which only differs
+  from the general product when the other operand holds an Inf or NaN.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cassert>
+#include <future>
+#include <vector>
+
+#include "./gemm.hpp"
+#include "./parallel_gemm.hpp"
+#include "./thread_pool.hpp"
+
+//! Structure of a square matrix that a product can exploit.
+enum class MatStructure {
+    //! Nothing to exploit.
+    kGeneral,
+    //! Zero off the diagonal.
+    kDiagonal,
+    //! Zero above the diagonal.
+    kLowerTriangular,
+    //! Zero below the diagonal.
+    kUpperTriangular
+};
+
+
+//! Returns whether every element above the diagonal is zero.
+bool IsZeroAboveDiagonal(const Eigen::MatrixXd &mat) {
+    for (Eigen::Index col = 1; col < mat.cols(); col++) {
+        for (Eigen::Index row = 0; row < std::min(col, mat.rows()); row++) {
+            if (mat(row, col) != 0.0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+} // IsZeroAboveDiagonal
+
+//! Returns whether every element below the diagonal is zero.
+bool IsZeroBelowDiagonal(const Eigen::MatrixXd &mat) {
+    for (Eigen::Index col = 0; col < mat.cols(); col++) {
+        for (Eigen::Index row = col + 1; row < mat.rows(); row++) {
+            if (mat(row, col) != 0.0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+} // IsZeroBelowDiagonal
+
+//! Classifies a matrix by where its zeros are.
+/*!
+  \param mat the matrix
+  \return kGeneral unless mat is square and diagonal or triangular
+ */
+MatStructure DetectMatStructure(const Eigen::MatrixXd &mat) {
+    if (mat.rows() != mat.cols()) {
+        return MatStructure::kGeneral;
+    }
+
+    const bool kLower = IsZeroAboveDiagonal(mat);
+    const bool kUpper = IsZeroBelowDiagonal(mat);
+
+    if (kLower && kUpper) {
+        return MatStructure::kDiagonal;
+    }
+    if (kLower) {
+        return MatStructure::kLowerTriangular;
+    }
+    if (kUpper) {
+        return MatStructure::kUpperTriangular;
+    }
+    return MatStructure::kGeneral;
+} // DetectMatStructure
+
+//! Returns whether transpose is exactly the transpose of mat.
+bool IsTransposeOf(const Eigen::MatrixXd &transpose,
+                   const Eigen::MatrixXd &mat) {
+    if (transpose.rows() != mat.cols() || transpose.cols() != mat.rows()) {
+        return false;
+    }
+
+    for (Eigen::Index col = 0; col < transpose.cols(); col++) {
+        for (Eigen::Index row = 0; row < transpose.rows(); row++) {
+            if (transpose(row, col) != mat(col, row)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+} // IsTransposeOf
+
+//! Computes C += A * B under a block mask, on a pool when it pays.
+/*!
+  Each thread takes whole panels of C's rows (split_rows) or columns, so
+  panels never share output. Panels outnumber threads, as in
+  GemmParallelOperands, because masked panels differ in work.
+  \param m the number of rows of A and C
+  \param n the number of columns of B and C
+  \param k the number of columns of A and rows of B
+  \param a the left operand
+  \param b the right operand
+  \param c pointer to column-major C
+  \param ldc the leading dimension of C
+  \param needed the block mask, in whole-product coordinates
+  \param split_rows whether to split C into row panels, else column panels
+  \param work the multiply-adds left after masking
+  \param thread_count the number of threads, 0 for one per hardware thread
+  \param blocking the cache block sizes used inside each panel
+ */
+template <typename OperandA, typename OperandB, typename BlockMask>
+void GemmMaskedParallel(Eigen::Index m, Eigen::Index n, Eigen::Index k,
+                        const OperandA &a, const OperandB &b, double *c,
+                        Eigen::Index ldc, BlockMask needed, bool split_rows,
+                        double work, unsigned int thread_count,
+                        const GemmBlocking &blocking) {
+    thread_count = ResolveThreadCount(thread_count);
+    if (thread_count == 1 || work < kParallelGemmMinWork) {
+        GemmBlockedMasked(m, n, k, a, b, c, ldc, blocking, needed);
+        return;
+    }
+
+    const Eigen::Index kExtent = split_rows ? m : n;
+    const Eigen::Index kStep = split_rows ? kGemmMr : kGemmNr;
+    const Eigen::Index kPanelCount =
+        static_cast<Eigen::Index>(thread_count) * kParallelGemmTilesPerThread;
+    const Eigen::Index kPanelSize = RoundUpToMultiple(
+        (kExtent + kPanelCount - 1) / kPanelCount, kStep);
+
+    ThreadPool pool(thread_count);
+    std::vector<std::future<void>> panels;
+    for (Eigen::Index first = 0; first < kExtent; first += kPanelSize) {
+        const Eigen::Index size = std::min(kPanelSize, kExtent - first);
+
+        panels.push_back(pool.Submit([=, &a, &b, &needed] {
+            if (split_rows) {
+                GemmBlockedMasked(size, n, k, OffsetBy(a, first, 0), b,
+                                  c + first, ldc, blocking,
+                                  [&](Eigen::Index pc, Eigen::Index kc,
+                                      Eigen::Index row, Eigen::Index rows,
+                                      Eigen::Index col, Eigen::Index cols) {
+                    return needed(pc, kc, first + row, rows, col, cols);
+                });
+            } else {
+                GemmBlockedMasked(m, size, k, a, OffsetBy(b, 0, first),
+                                  c + first * ldc, ldc, blocking,
+                                  [&](Eigen::Index pc, Eigen::Index kc,
+                                      Eigen::Index row, Eigen::Index rows,
+                                      Eigen::Index col, Eigen::Index cols) {
+                    return needed(pc, kc, row, rows, first + col, cols);
+                });
+            }
+        }));
+    }
+
+    for (std::future<void> &panel : panels) {
+        panel.get();
+    }
+} // GemmMaskedParallel
+
+//! Copies the lower triangle of a square matrix over its upper triangle.
+void MirrorLowerTriangle(Eigen::MatrixXd &mat) {
+    for (Eigen::Index col = 1; col < mat.cols(); col++) {
+        for (Eigen::Index row = 0; row < col; row++) {
+            mat(row, col) = mat(col, row);
+        }
+    }
+} // MirrorLowerTriangle
+
+//! Computes the lower triangle of C = A * A^T into column-major C.
+/*!
+  Micro-tiles wholly above the diagonal are skipped. Tiles straddling it
+  are computed whole, leaving a few elements above the diagonal for the
+  caller to overwrite.
+  \param n the order of C and the number of rows of A
+  \param k the number of columns of A
+  \param a the operand A
+  \param a_transpose the operand A^T, read however is cheapest
+  \param c pointer to C
+  \param ldc the leading dimension of C
+  \param thread_count the number of threads, 0 for one per hardware thread
+  \param blocking the cache block sizes to use
+ */
+template <typename OperandA, typename OperandAT>
+void SyrkLowerOperands(Eigen::Index n, Eigen::Index k, const OperandA &a,
+                       const OperandAT &a_transpose, double *c,
+                       Eigen::Index ldc, unsigned int thread_count,
+                       const GemmBlocking &blocking) {
+    GemmMaskedParallel(n, n, k, a, a_transpose, c, ldc,
+                       [](Eigen::Index, Eigen::Index, Eigen::Index row,
+                          Eigen::Index rows, Eigen::Index col, Eigen::Index) {
+                           return row + rows > col;
+                       },
+                       false, 0.5 * static_cast<double>(n) * n * k,
+                       thread_count, blocking);
+} // SyrkLowerOperands
+
+//! Computes the Gram matrix of input, computing only one triangle.
+/*!
+  \param input the matrix A
+  \param transpose_first false for A * A^T, true for A^T * A
+  \param product the output, resized to fit
+  \param thread_count the number of threads, 0 for one per hardware thread
+  \param blocking the cache block sizes to use
+ */
+void GemmGram(const Eigen::MatrixXd &input, bool transpose_first,
+              Eigen::MatrixXd &product, unsigned int thread_count = 0,
+              const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    const Eigen::Index kOrder = transpose_first ? input.cols() : input.rows();
+    const Eigen::Index kDepth = transpose_first ? input.rows() : input.cols();
+    const StridedOperand kStored =
+        ColMajorOperand(input.data(), input.outerStride());
+    const StridedOperand kTransposed =
+        TransposedOperand(input.data(), input.outerStride());
+
+    product.setZero(kOrder, kOrder);
+    if (transpose_first) {
+        SyrkLowerOperands(kOrder, kDepth, kTransposed, kStored,
+                          product.data(), product.outerStride(),
+                          thread_count, blocking);
+    } else {
+        SyrkLowerOperands(kOrder, kDepth, kStored, kTransposed,
+                          product.data(), product.outerStride(),
+                          thread_count, blocking);
+    }
+    MirrorLowerTriangle(product);
+} // GemmGram
+
+//! Computes product = op(input_1) * op(input_2) without copying transposes.
+/*!
+  \param input_1 the left operand
+  \param transpose_1 whether op(input_1) is input_1^T
+  \param input_2 the right operand
+  \param transpose_2 whether op(input_2) is input_2^T
+  \param product the output, resized to fit
+  \param thread_count the number of threads, 0 for one per hardware thread
+  \param blocking the cache block sizes to use
+ */
+void GemmTransposed(const Eigen::MatrixXd &input_1, bool transpose_1,
+                    const Eigen::MatrixXd &input_2, bool transpose_2,
+                    Eigen::MatrixXd &product, unsigned int thread_count = 0,
+                    const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    const Eigen::Index kRows = transpose_1 ? input_1.cols() : input_1.rows();
+    const Eigen::Index kDepth = transpose_1 ? input_1.rows() : input_1.cols();
+    const Eigen::Index kCols = transpose_2 ? input_2.rows() : input_2.cols();
+    assert(kDepth == (transpose_2 ? input_2.cols() : input_2.rows()));
+
+    const StridedOperand kLeft = transpose_1
+        ? TransposedOperand(input_1.data(), input_1.outerStride())
+        : ColMajorOperand(input_1.data(), input_1.outerStride());
+    const StridedOperand kRight = transpose_2
+        ? TransposedOperand(input_2.data(), input_2.outerStride())
+        : ColMajorOperand(input_2.data(), input_2.outerStride());
+
+    product.setZero(kRows, kCols);
+    const double kWork = static_cast<double>(kRows) * kCols * kDepth;
+    if (ResolveThreadCount(thread_count) == 1 ||
+            kWork < kParallelGemmMinWork) {
+        GemmBlockedOperands(kRows, kCols, kDepth, kLeft, kRight,
+                            product.data(), product.outerStride(), blocking);
+        return;
+    }
+
+    ThreadPool pool(thread_count);
+    GemmParallelOperands(pool, kRows, kCols, kDepth, kLeft, kRight,
+                         product.data(), product.outerStride(), blocking);
+} // GemmTransposed
+
+//! Computes product = triangular * input_2, skipping the zero triangle.
+/*!
+  Rows of a lower triangle only meet depth slabs up to the row, and rows of
+  an upper one only slabs from the row on.
+  \param triangular a square triangular matrix
+  \param lower whether triangular is lower (else upper) triangular
+  \param input_2 the right operand
+  \param product the output, resized to fit
+  \param thread_count the number of threads, 0 for one per hardware thread
+  \param blocking the cache block sizes to use
+ */
+void GemmTriangularLeft(const Eigen::MatrixXd &triangular, bool lower,
+                        const Eigen::MatrixXd &input_2,
+                        Eigen::MatrixXd &product,
+                        unsigned int thread_count = 0,
+                        const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    assert(triangular.rows() == triangular.cols());
+    assert(triangular.cols() == input_2.rows());
+
+    const Eigen::Index kOrder = triangular.rows();
+    const Eigen::Index kCols = input_2.cols();
+
+    const double kWork = 0.5 * static_cast<double>(kOrder) * kOrder * kCols;
+
+    product.setZero(kOrder, kCols);
+    GemmMaskedParallel(kOrder, kCols, kOrder,
+                       ColMajorOperand(triangular.data(),
+                                       triangular.outerStride()),
+                       ColMajorOperand(input_2.data(), input_2.outerStride()),
+                       product.data(), product.outerStride(),
+                       [lower](Eigen::Index pc, Eigen::Index kc,
+                               Eigen::Index row, Eigen::Index rows,
+                               Eigen::Index, Eigen::Index) {
+                           return lower ? pc < row + rows : pc + kc > row;
+                       },
+                       true, kWork, thread_count, blocking);
+} // GemmTriangularLeft
+
+//! Computes product = input_1 * triangular, skipping the zero triangle.
+/*!
+  Columns of a lower triangle only meet depth slabs from the column on, and
+  columns of an upper one only slabs up to the column.
+  \param input_1 the left operand
+  \param triangular a square triangular matrix
+  \param lower whether triangular is lower (else upper) triangular
+  \param product the output, resized to fit
+  \param thread_count the number of threads, 0 for one per hardware thread
+  \param blocking the cache block sizes to use
+ */
+void GemmTriangularRight(const Eigen::MatrixXd &input_1,
+                         const Eigen::MatrixXd &triangular, bool lower,
+                         Eigen::MatrixXd &product,
+                         unsigned int thread_count = 0,
+                         const GemmBlocking &blocking = kDefaultGemmBlocking) {
+    assert(triangular.rows() == triangular.cols());
+    assert(input_1.cols() == triangular.rows());
+
+    const Eigen::Index kRows = input_1.rows();
+    const Eigen::Index kOrder = triangular.cols();
+
+    const double kWork = 0.5 * static_cast<double>(kRows) * kOrder * kOrder;
+
+    product.setZero(kRows, kOrder);
+    GemmMaskedParallel(kRows, kOrder, kOrder,
+                       ColMajorOperand(input_1.data(), input_1.outerStride()),
+                       ColMajorOperand(triangular.data(),
+                                       triangular.outerStride()),
+                       product.data(), product.outerStride(),
+                       [lower](Eigen::Index pc, Eigen::Index kc,
+                               Eigen::Index, Eigen::Index,
+                               Eigen::Index col, Eigen::Index cols) {
+                           return lower ? pc + kc > col : pc < col + cols;
+                       },
+                       false, kWork, thread_count, blocking);
+} // GemmTriangularRight
+
+//! Computes product = diagonal * input_2 by scaling input_2's rows.
+/*!
+  \param diagonal a square diagonal matrix; only its diagonal is read
+  \param input_2 the right operand
+  \param product the output, resized to fit
+ */
+void GemmDiagonalLeft(const Eigen::MatrixXd &diagonal,
+                      const Eigen::MatrixXd &input_2,
+                      Eigen::MatrixXd &product) {
+    assert(diagonal.cols() == input_2.rows());
+
+    // adding 0.0 turns -0 into +0, as the general kernel's sums would
+    product.resize(input_2.rows(), input_2.cols());
+    for (Eigen::Index col = 0; col < input_2.cols(); col++) {
+        for (Eigen::Index row = 0; row < input_2.rows(); row++) {
+            product(row, col) = diagonal(row, row) * input_2(row, col) + 0.0;
+        }
+    }
+} // GemmDiagonalLeft
+
+//! Computes product = input_1 * diagonal by scaling input_1's columns.
+/*!
+  \param input_1 the left operand
+  \param diagonal a square diagonal matrix; only its diagonal is read
+  \param product the output, resized to fit
+ */
+void GemmDiagonalRight(const Eigen::MatrixXd &input_1,
+                       const Eigen::MatrixXd &diagonal,
+                       Eigen::MatrixXd &product) {
+    assert(input_1.cols() == diagonal.rows());
+
+    product.resize(input_1.rows(), input_1.cols());
+    for (Eigen::Index col = 0; col < input_1.cols(); col++) {
+        const double kScale = diagonal(col, col);
+        for (Eigen::Index row = 0; row < input_1.rows(); row++) {
+            product(row, col) = input_1(row, col) * kScale + 0.0;
+        }
+    }
+} // GemmDiagonalRight
+
+//! Computes product = input_1 * input_2 if either operand has structure.
+/*!
+  Checks, in order, for a Gram product (input_2 is input_1's transpose,
+  which includes a symmetric matrix times itself), then a diagonal or
+  triangular input_1, then a diagonal or triangular input_2.
+  \param input_1 the left operand
+  \param input_2 the right operand
+  \param product the output, resized to fit when structure was found
+  \param thread_count the number of threads, 0 for one per hardware thread
+  \param blocking the cache block sizes to use
+  \return False, leaving product untouched, if neither operand has any
+ */
+bool MultiplyIfStructured(const Eigen::MatrixXd &input_1,
+                          const Eigen::MatrixXd &input_2,
+                          Eigen::MatrixXd &product,
+                          unsigned int thread_count = 0,
+                          const GemmBlocking &blocking =
+                              kDefaultGemmBlocking) {
+    assert(input_1.cols() == input_2.rows());
+
+    if (IsTransposeOf(input_2, input_1)) {
+        // input_2 holds input_1^T contiguously, which packs faster than
+        // reading input_1 across its rows
+        product.setZero(input_1.rows(), input_1.rows());
+        SyrkLowerOperands(input_1.rows(), input_1.cols(),
+                          ColMajorOperand(input_1.data(),
+                                          input_1.outerStride()),
+                          ColMajorOperand(input_2.data(),
+                                          input_2.outerStride()),
+                          product.data(), product.outerStride(),
+                          thread_count, blocking);
+        MirrorLowerTriangle(product);
+        return true;
+    }
+
+    const MatStructure kStructure1 = DetectMatStructure(input_1);
+    if (kStructure1 == MatStructure::kDiagonal) {
+        GemmDiagonalLeft(input_1, input_2, product);
+        return true;
+    }
+    if (kStructure1 != MatStructure::kGeneral) {
+        GemmTriangularLeft(input_1,
+                           kStructure1 == MatStructure::kLowerTriangular,
+                           input_2, product, thread_count, blocking);
+        return true;
+    }
+
+    const MatStructure kStructure2 = DetectMatStructure(input_2);
+    if (kStructure2 == MatStructure::kDiagonal) {
+        GemmDiagonalRight(input_1, input_2, product);
+        return true;
+    }
+    if (kStructure2 != MatStructure::kGeneral) {
+        GemmTriangularRight(input_1, input_2,
+                            kStructure2 == MatStructure::kLowerTriangular,
+                            product, thread_count, blocking);
+        return true;
+    }
+
+    return false;
+} // MultiplyIfStructured
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+//!  A fixed-size pool of worker threads fed from a shared task queue.
+/*!
+  \file thread_pool.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+//! Resolves a requested thread count, where 0 means one per hardware thread.
+/*!
+  \param requested the requested number of threads
+  \return A thread count of at least 1
+ */
+unsigned int ResolveThreadCount(unsigned int requested) {
+    if (requested == 0) {
+        requested = std::thread::hardware_concurrency();
+    }
+
+    return requested == 0 ? 1 : requested;
+} // ResolveThreadCount
+
+//! Class that runs submitted tasks on a fixed set of worker threads.
+class ThreadPool {
+  public:
+    //! Starts the worker threads.
+    /*!
+      \param thread_count the number of workers, 0 for one per hardware thread
+     */
+    explicit ThreadPool(unsigned int thread_count = 0) {
+        thread_count = ResolveThreadCount(thread_count);
+
+        for (unsigned int index = 0; index < thread_count; index++) {
+            workers_.emplace_back([this] { RunWorker(); });
+        }
+    } // constructor
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    //! Finishes the queued tasks and joins the workers.
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        task_ready_.notify_all();
+
+        for (std::thread &worker : workers_) {
+            worker.join();
+        }
+    } // destructor
+
+    //! Queues a task.
+    /*!
+      \param task a callable taking no arguments
+      \return A future for the task's result, which also carries exceptions
+     */
+    template <typename Task>
+    std::future<typename std::invoke_result<Task>::type> Submit(Task task) {
+        typedef typename std::invoke_result<Task>::type Result;
+
+        auto packaged =
+            std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> result = packaged->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace_back([packaged] { (*packaged)(); });
+        }
+        task_ready_.notify_one();
+
+        return result;
+    } // Submit
+
+    //! Returns the number of worker threads.
+    unsigned int GetThreadCount() const {
+        return static_cast<unsigned int>(workers_.size());
+    } // GetThreadCount
+
+  private:
+    //! Pulls tasks off the queue until the pool is stopped and drained.
+    void RunWorker() {
+        while (true) {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                task_ready_.wait(lock, [this] {
+                    return stopping_ || !tasks_.empty();
+                });
+
+                if (tasks_.empty()) {
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+
+            task();
+        }
+    } // RunWorker
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable task_ready_;
+    bool stopping_ = false;
+};
+
+#endif
@@ -0,0 +1,641 @@
+#ifndef TILED_MAT_FILE_H_
+#define TILED_MAT_FILE_H_
+
+//!  On-disk matrices stored as fixed-size square tiles.
+/*!
+  \file tiled_mat_file.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  A tiled file is a 64 byte header followed by tile_size x tile_size tiles in
+  column-major tile order. Every tile is column-major internally and padded
+  with zeros past the matrix edge, so tile (i, j) always sits at a fixed
+  offset and can be read or written with a single pread/pwrite from any
+  thread.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./mat_io.hpp"
+#include "./mat_stream.hpp"
+#include "./mat_text_writer.hpp"
+
+//! Magic bytes at the start of every tiled matrix file.
+const char kTiledMatMagic[8] = {'P', 'A', '1', 'T', 'I', 'L', 'E', '\0'};
+
+//! The tiled format version written by this header.
+const std::uint32_t kTiledMatVersion = 1;
+
+//! Tile edge used when none is given; a 1024 x 1024 tile is 8 MiB.
+const Eigen::Index kDefaultTileSize = 1024;
+
+//! Default bound on the matrix data a conversion to or from tiles holds.
+const std::size_t kDefaultTiledMemoryLimit = std::size_t(1) << 30;
+
+//! On-disk header of a tiled matrix file.
+struct TiledMatHeader {
+    //! Always kTiledMatMagic.
+    char magic[8];
+    //! Format version, kTiledMatVersion for files written here.
+    std::uint32_t version;
+    //! Byte offset of the first tile.
+    std::uint32_t data_offset;
+    //! Number of rows of the matrix.
+    std::uint64_t rows;
+    //! Number of columns of the matrix.
+    std::uint64_t cols;
+    //! Edge length of every tile.
+    std::uint64_t tile_size;
+    //! Pads the header out to 64 bytes.
+    std::uint8_t reserved[24];
+};
+
+static_assert(sizeof(TiledMatHeader) == 64,
+              "TiledMatHeader must match the on-disk header size");
+
+
+//! Rejects tile edge lengths that cannot tile anything.
+/*!
+  \param tile_size the tile edge length
+  \throws std::runtime_error if tile_size is not positive
+ */
+void CheckTileSize(Eigen::Index tile_size) {
+    if (tile_size <= 0) {
+        throw std::runtime_error("tile size must be positive, not " +
+                                 std::to_string(tile_size));
+    }
+} // CheckTileSize
+
+//! Checks whether the file at read_file_path starts with the tiled magic.
+/*!
+  \param read_file_path the path of the file
+  \return Whether the file is a tiled matrix file
+ */
+bool IsTiledMatFile(const std::string &read_file_path) {
+    std::ifstream read_file(read_file_path, std::ios::binary);
+    char magic[sizeof(kTiledMatMagic)] = {};
+    read_file.read(magic, sizeof(magic));
+
+    return read_file.gcount() == sizeof(magic) &&
+           std::memcmp(magic, kTiledMatMagic, sizeof(magic)) == 0;
+} // IsTiledMatFile
+
+//! Class giving thread-safe random access to the tiles of a tiled file.
+class TiledMatFile {
+  public:
+    //! Opens an existing tiled file.
+    /*!
+      \param file_path the path of the tiled file
+      \param writable whether tiles will be written
+     */
+    TiledMatFile(const std::string &file_path, bool writable)
+        : file_path_(file_path) {
+        descriptor_ = open(file_path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (descriptor_ < 0) {
+            throw std::runtime_error(file_path + ": cannot open file");
+        }
+
+        if (pread(descriptor_, &header_, sizeof(header_), 0) !=
+                static_cast<ssize_t>(sizeof(header_)) ||
+                std::memcmp(header_.magic, kTiledMatMagic,
+                            sizeof(header_.magic)) != 0) {
+            close(descriptor_);
+            throw std::runtime_error(file_path + ": not a tiled matrix file");
+        }
+        if (header_.version != kTiledMatVersion || header_.tile_size == 0) {
+            close(descriptor_);
+            throw std::runtime_error(file_path + ": malformed tiled header");
+        }
+
+        struct stat file_stat;
+        if (fstat(descriptor_, &file_stat) != 0 ||
+                static_cast<std::uint64_t>(file_stat.st_size) <
+                    header_.data_offset + GetTileCount() * GetTileBytes()) {
+            close(descriptor_);
+            throw std::runtime_error(file_path + ": tiled file is truncated");
+        }
+    } // constructor
+
+    //! Creates a zero-filled tiled file for a rows x cols matrix.
+    /*!
+      \param file_path the path of the new file, replaced if it exists
+      \param rows the number of rows
+      \param cols the number of columns
+      \param tile_size the tile edge length
+      \return The opened, writable file
+      \throws std::runtime_error if tile_size is not positive or the file
+      cannot be created
+     */
+    static TiledMatFile Create(const std::string &file_path, Eigen::Index rows,
+                               Eigen::Index cols, Eigen::Index tile_size) {
+        CheckTileSize(tile_size);
+
+        TiledMatHeader header = {};
+        std::memcpy(header.magic, kTiledMatMagic, sizeof(header.magic));
+        header.version = kTiledMatVersion;
+        header.data_offset = sizeof(TiledMatHeader);
+        header.rows = static_cast<std::uint64_t>(rows);
+        header.cols = static_cast<std::uint64_t>(cols);
+        header.tile_size = static_cast<std::uint64_t>(tile_size);
+
+        int descriptor = open(file_path.c_str(),
+                              O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (descriptor < 0) {
+            throw std::runtime_error(file_path + ": cannot create file");
+        }
+
+        // ftruncate leaves a sparse, zero-filled file for the tiles
+        const std::uint64_t tile_count =
+            static_cast<std::uint64_t>(CountTiles(rows, tile_size)) *
+            static_cast<std::uint64_t>(CountTiles(cols, tile_size));
+        const std::uint64_t tile_bytes =
+            header.tile_size * header.tile_size * sizeof(double);
+        const bool ok =
+            pwrite(descriptor, &header, sizeof(header), 0) ==
+                static_cast<ssize_t>(sizeof(header)) &&
+            ftruncate(descriptor, static_cast<off_t>(
+                header.data_offset + tile_count * tile_bytes)) == 0;
+        close(descriptor);
+
+        if (!ok) {
+            throw std::runtime_error(file_path + ": cannot size file");
+        }
+
+        return TiledMatFile(file_path, true);
+    } // Create
+
+    TiledMatFile(TiledMatFile &&other) noexcept
+        : file_path_(std::move(other.file_path_)),
+          descriptor_(other.descriptor_), header_(other.header_) {
+        other.descriptor_ = -1;
+    } // move constructor
+
+    TiledMatFile(const TiledMatFile &) = delete;
+    TiledMatFile &operator=(const TiledMatFile &) = delete;
+
+    //! Closes the file.
+    ~TiledMatFile() {
+        if (descriptor_ >= 0) {
+            close(descriptor_);
+        }
+    } // destructor
+
+    //! Returns how many tiles of tile_size cover extent elements.
+    static Eigen::Index CountTiles(Eigen::Index extent,
+                                   Eigen::Index tile_size) {
+        return (extent + tile_size - 1) / tile_size;
+    } // CountTiles
+
+    //! Returns the number of rows of the matrix.
+    Eigen::Index GetRows() const {
+        return static_cast<Eigen::Index>(header_.rows);
+    } // GetRows
+
+    //! Returns the number of columns of the matrix.
+    Eigen::Index GetCols() const {
+        return static_cast<Eigen::Index>(header_.cols);
+    } // GetCols
+
+    //! Returns the tile edge length, which is also every tile's stride.
+    Eigen::Index GetTileSize() const {
+        return static_cast<Eigen::Index>(header_.tile_size);
+    } // GetTileSize
+
+    //! Returns the number of tile rows.
+    Eigen::Index GetTileRows() const {
+        return CountTiles(GetRows(), GetTileSize());
+    } // GetTileRows
+
+    //! Returns the number of tile columns.
+    Eigen::Index GetTileCols() const {
+        return CountTiles(GetCols(), GetTileSize());
+    } // GetTileCols
+
+    //! Returns the number of matrix rows inside tile row tile_row.
+    Eigen::Index GetRowsInTile(Eigen::Index tile_row) const {
+        return std::min(GetTileSize(), GetRows() - tile_row * GetTileSize());
+    } // GetRowsInTile
+
+    //! Returns the number of matrix columns inside tile column tile_col.
+    Eigen::Index GetColsInTile(Eigen::Index tile_col) const {
+        return std::min(GetTileSize(), GetCols() - tile_col * GetTileSize());
+    } // GetColsInTile
+
+    //! Returns the size of one tile in bytes.
+    std::uint64_t GetTileBytes() const {
+        return header_.tile_size * header_.tile_size * sizeof(double);
+    } // GetTileBytes
+
+    //! Reads tile (tile_row, tile_col) into out.
+    /*!
+      \param tile_row the tile's row in the tile grid
+      \param tile_col the tile's column in the tile grid
+      \param out room for GetTileSize() squared doubles
+     */
+    void ReadTile(Eigen::Index tile_row, Eigen::Index tile_col,
+                  double *out) const {
+        TransferTile(tile_row, tile_col, out, false);
+    } // ReadTile
+
+    //! Writes tile (tile_row, tile_col) from tile.
+    /*!
+      \param tile_row the tile's row in the tile grid
+      \param tile_col the tile's column in the tile grid
+      \param tile GetTileSize() squared doubles, zero past the matrix edge
+     */
+    void WriteTile(Eigen::Index tile_row, Eigen::Index tile_col,
+                   const double *tile) const {
+        TransferTile(tile_row, tile_col, const_cast<double *>(tile), true);
+    } // WriteTile
+
+    //! Reads part of tile (tile_row, tile_col) into column-major storage.
+    /*!
+      \param tile_row the tile's row in the tile grid
+      \param tile_col the tile's column in the tile grid
+      \param first_row the block's first row inside the tile
+      \param first_col the block's first column inside the tile
+      \param rows the number of rows of the block
+      \param cols the number of columns of the block
+      \param out room for the block
+      \param ld the leading dimension of out
+     */
+    void ReadTileBlock(Eigen::Index tile_row, Eigen::Index tile_col,
+                       Eigen::Index first_row, Eigen::Index first_col,
+                       Eigen::Index rows, Eigen::Index cols, double *out,
+                       Eigen::Index ld) const {
+        TransferTileBlock(tile_row, tile_col, first_row, first_col, rows,
+                          cols, out, ld, false);
+    } // ReadTileBlock
+
+    //! Writes part of tile (tile_row, tile_col) from column-major storage.
+    /*!
+      \param tile_row the tile's row in the tile grid
+      \param tile_col the tile's column in the tile grid
+      \param first_row the block's first row inside the tile
+      \param first_col the block's first column inside the tile
+      \param rows the number of rows of the block
+      \param cols the number of columns of the block
+      \param block the block's elements
+      \param ld the leading dimension of block
+     */
+    void WriteTileBlock(Eigen::Index tile_row, Eigen::Index tile_col,
+                        Eigen::Index first_row, Eigen::Index first_col,
+                        Eigen::Index rows, Eigen::Index cols,
+                        const double *block, Eigen::Index ld) const {
+        TransferTileBlock(tile_row, tile_col, first_row, first_col, rows,
+                          cols, const_cast<double *>(block), ld, true);
+    } // WriteTileBlock
+
+  private:
+    //! Returns the total number of tiles.
+    std::uint64_t GetTileCount() const {
+        return static_cast<std::uint64_t>(GetTileRows()) *
+               static_cast<std::uint64_t>(GetTileCols());
+    } // GetTileCount
+
+    //! Returns the file offset of tile (tile_row, tile_col).
+    std::uint64_t GetTileOffset(Eigen::Index tile_row,
+                                Eigen::Index tile_col) const {
+        const std::uint64_t index =
+            static_cast<std::uint64_t>(tile_row + tile_col * GetTileRows());
+        return header_.data_offset + index * GetTileBytes();
+    } // GetTileOffset
+
+    //! Moves one tile between memory and the file.
+    void TransferTile(Eigen::Index tile_row, Eigen::Index tile_col,
+                      double *tile, bool write) const {
+        TransferBytes(GetTileOffset(tile_row, tile_col), tile,
+                      GetTileBytes(), write);
+    } // TransferTile
+
+    //! Moves a block of one tile between memory and the file, one column at
+    //! a time unless the block is whole columns stored at the tile's stride.
+    void TransferTileBlock(Eigen::Index tile_row, Eigen::Index tile_col,
+                           Eigen::Index first_row, Eigen::Index first_col,
+                           Eigen::Index rows, Eigen::Index cols,
+                           double *block, Eigen::Index ld,
+                           bool write) const {
+        const Eigen::Index tile_size = GetTileSize();
+        const std::uint64_t offset = GetTileOffset(tile_row, tile_col) +
+            static_cast<std::uint64_t>(first_row + first_col * tile_size) *
+                sizeof(double);
+
+        if (rows == tile_size && ld == tile_size) {
+            TransferBytes(offset, block, static_cast<std::uint64_t>(
+                rows * cols) * sizeof(double), write);
+            return;
+        }
+
+        for (Eigen::Index col = 0; col < cols; col++) {
+            TransferBytes(offset + static_cast<std::uint64_t>(
+                              col * tile_size) * sizeof(double),
+                          block + col * ld,
+                          static_cast<std::uint64_t>(rows) * sizeof(double),
+                          write);
+        }
+    } // TransferTileBlock
+
+    //! Moves size bytes between memory and the file, retrying short
+    //! transfers.
+    void TransferBytes(std::uint64_t file_offset, double *data,
+                       std::uint64_t size, bool write) const {
+        off_t offset = static_cast<off_t>(file_offset);
+        char *bytes = reinterpret_cast<char *>(data);
+        std::uint64_t left = size;
+
+        while (left > 0) {
+            const ssize_t done = write
+                ? pwrite(descriptor_, bytes, left, offset)
+                : pread(descriptor_, bytes, left, offset);
+            if (done <= 0) {
+                throw std::runtime_error(file_path_ + (write
+                    ? ": tile write failed" : ": tile read failed"));
+            }
+
+            bytes += done;
+            offset += done;
+            left -= static_cast<std::uint64_t>(done);
+        }
+    } // TransferBytes
+
+    std::string file_path_;
+    int descriptor_ = -1;
+    TiledMatHeader header_;
+};
+
+//! How much of a matrix a conversion holds at once: piece_rows rows of
+//! piece_cols columns.
+struct TiledPiece {
+    //! Rows per piece; the whole height, or a multiple of the tile size.
+    Eigen::Index piece_rows;
+    //! Columns per piece; more than one only when piece_rows is the whole
+    //! height, so pieces follow column-major order exactly.
+    Eigen::Index piece_cols;
+};
+
+//! Sizes the pieces of a column-major pass to fit memory_limit.
+/*!
+  Whole columns are taken, up to a tile's width, while they fit; taller
+  matrices go down a single column in runs of whole tiles.
+  \param rows the number of rows of the matrix
+  \param tile_size the tile edge length
+  \param memory_limit upper bound on the bytes of one piece
+  \return The piece shape
+ */
+TiledPiece PlanColumnPieces(Eigen::Index rows, Eigen::Index tile_size,
+                            std::size_t memory_limit) {
+    const Eigen::Index kBudget = static_cast<Eigen::Index>(
+        std::max<std::size_t>(memory_limit / sizeof(double), 1));
+
+    if (rows <= kBudget) {
+        return {rows, std::clamp<Eigen::Index>(
+                          kBudget / std::max<Eigen::Index>(rows, 1), 1,
+                          tile_size)};
+    }
+
+    return {std::max<Eigen::Index>(kBudget / tile_size, 1) * tile_size, 1};
+} // PlanColumnPieces
+
+//! Sizes the strips of whole rows a row-major pass holds to fit memory_limit.
+/*!
+  A strip never goes below one row, since text is read and written a row
+  at a time.
+  \param row_elements the elements held per row of the strip
+  \param tile_size the tile edge length, the most rows a strip needs
+  \param memory_limit upper bound on the bytes of one strip
+  \return The number of rows per strip
+ */
+Eigen::Index PlanRowStrip(Eigen::Index row_elements, Eigen::Index tile_size,
+                          std::size_t memory_limit) {
+    return std::clamp<Eigen::Index>(
+        static_cast<Eigen::Index>(memory_limit / sizeof(double)) /
+            std::max<Eigen::Index>(row_elements, 1),
+        1, tile_size);
+} // PlanRowStrip
+
+//! Converts a text or binary matrix file into a tiled file.
+/*!
+  Binary files are read as whole columns, or as runs of whole tiles down one
+  column when a column alone would not fit, and text files as strips of up
+  to tile_size rows, so memory stays within memory_limit however large the
+  matrix is (text always holds at least one row).
+  \param input_path the path of a text or binary matrix file
+  \param tiled_path the path of the tiled file to create
+  \param tile_size the tile edge length
+  \param memory_limit upper bound on the bytes of matrix data held at once
+  \throws std::runtime_error if tile_size is not positive
+ */
+void ConvertMatFileToTiled(const std::string &input_path,
+                           const std::string &tiled_path,
+                           Eigen::Index tile_size = kDefaultTileSize,
+                           std::size_t memory_limit =
+                               kDefaultTiledMemoryLimit) {
+    CheckTileSize(tile_size);
+
+    if (IsBinaryMatFile(input_path)) {
+        MatBinaryStreamReader reader(input_path);
+        const Eigen::Index rows =
+            static_cast<Eigen::Index>(reader.GetHeader().rows);
+        const Eigen::Index cols =
+            static_cast<Eigen::Index>(reader.GetHeader().cols);
+        TiledMatFile tiled = TiledMatFile::Create(tiled_path, rows, cols,
+                                                  tile_size);
+        const TiledPiece kPiece =
+            PlanColumnPieces(rows, tile_size, memory_limit);
+        std::vector<double> piece(static_cast<std::size_t>(
+            std::min(kPiece.piece_rows, rows) * kPiece.piece_cols));
+
+        for (Eigen::Index tile_col = 0; tile_col < tiled.GetTileCols();
+                tile_col++) {
+            const Eigen::Index tile_cols = tiled.GetColsInTile(tile_col);
+
+            for (Eigen::Index col = 0; col < tile_cols;
+                    col += kPiece.piece_cols) {
+                const Eigen::Index count =
+                    std::min(kPiece.piece_cols, tile_cols - col);
+
+                for (Eigen::Index row = 0; row < rows;
+                        row += kPiece.piece_rows) {
+                    const Eigen::Index height =
+                        std::min(kPiece.piece_rows, rows - row);
+                    reader.ReadElements(
+                        static_cast<std::uint64_t>(height * count),
+                        piece.data());
+
+                    // pieces start on tile boundaries
+                    for (Eigen::Index tile_row = row / tile_size;
+                            tile_row * tile_size < row + height; tile_row++) {
+                        tiled.WriteTileBlock(
+                            tile_row, tile_col, 0, col,
+                            tiled.GetRowsInTile(tile_row), count,
+                            piece.data() + (tile_row * tile_size - row),
+                            height);
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    MatTextStreamReader reader(input_path);
+    const Eigen::Index cols = reader.GetCols();
+    TiledMatFile tiled = TiledMatFile::Create(tiled_path, reader.GetRows(),
+                                              cols, tile_size);
+    // a row-major strip, and one tile's share of it in column-major order
+    const Eigen::Index strip_rows =
+        PlanRowStrip(cols + tile_size, tile_size, memory_limit);
+    std::vector<double> strip(static_cast<std::size_t>(strip_rows * cols));
+    std::vector<double> block(static_cast<std::size_t>(
+        strip_rows * std::min(tile_size, cols)));
+
+    for (Eigen::Index tile_row = 0; tile_row < tiled.GetTileRows();
+            tile_row++) {
+        const Eigen::Index tile_rows = tiled.GetRowsInTile(tile_row);
+
+        for (Eigen::Index row = 0; row < tile_rows; row += strip_rows) {
+            const Eigen::Index height = std::min(strip_rows, tile_rows - row);
+            reader.ReadRows(height, strip.data());
+
+            for (Eigen::Index tile_col = 0; tile_col < tiled.GetTileCols();
+                    tile_col++) {
+                const Eigen::Index tile_cols = tiled.GetColsInTile(tile_col);
+                TransposeBlock(strip.data() + tile_col * tile_size, cols,
+                               block.data(), height, tile_cols, height);
+                tiled.WriteTileBlock(tile_row, tile_col, row, 0, height,
+                                     tile_cols, block.data(), height);
+            }
+        }
+    }
+
+    reader.ExpectEnd();
+} // ConvertMatFileToTiled
+
+//! Converts a tiled file into a binary matrix file, in the same pieces
+//! ConvertMatFileToTiled reads binary files in.
+/*!
+  \param tiled_path the path of the tiled file
+  \param output_path the path of the binary file to write
+  \param memory_limit upper bound on the bytes of matrix data held at once
+ */
+void ConvertTiledToBinary(const std::string &tiled_path,
+                          const std::string &output_path,
+                          std::size_t memory_limit =
+                              kDefaultTiledMemoryLimit) {
+    TiledMatFile tiled(tiled_path, false);
+    const Eigen::Index rows = tiled.GetRows();
+    const Eigen::Index tile_size = tiled.GetTileSize();
+    const TiledPiece kPiece = PlanColumnPieces(rows, tile_size, memory_limit);
+    std::vector<double> piece(static_cast<std::size_t>(
+        std::min(kPiece.piece_rows, rows) * kPiece.piece_cols));
+    MatBinaryStreamWriter writer(output_path, rows, tiled.GetCols());
+
+    for (Eigen::Index tile_col = 0; tile_col < tiled.GetTileCols();
+            tile_col++) {
+        const Eigen::Index tile_cols = tiled.GetColsInTile(tile_col);
+
+        for (Eigen::Index col = 0; col < tile_cols; col += kPiece.piece_cols) {
+            const Eigen::Index count =
+                std::min(kPiece.piece_cols, tile_cols - col);
+
+            for (Eigen::Index row = 0; row < rows; row += kPiece.piece_rows) {
+                const Eigen::Index height =
+                    std::min(kPiece.piece_rows, rows - row);
+
+                for (Eigen::Index tile_row = row / tile_size;
+                        tile_row * tile_size < row + height; tile_row++) {
+                    tiled.ReadTileBlock(
+                        tile_row, tile_col, 0, col,
+                        tiled.GetRowsInTile(tile_row), count,
+                        piece.data() + (tile_row * tile_size - row), height);
+                }
+                writer.WriteElements(piece.data(),
+                                     static_cast<std::size_t>(height * count));
+            }
+        }
+    }
+
+    writer.Close();
+} // ConvertTiledToBinary
+
+//! Converts a tiled file into a text matrix file, in strips of rows.
+/*!
+  \param tiled_path the path of the tiled file
+  \param output_path the path of the text file to write
+  \param format the element layout; kEigenAligned scans the tiles twice
+  \param memory_limit upper bound on the bytes of matrix data held at once,
+  though a strip always holds at least one row
+ */
+void ConvertTiledToText(const std::string &tiled_path,
+                        const std::string &output_path,
+                        MatTextFormat format = MatTextFormat::kCompact,
+                        std::size_t memory_limit = kDefaultTiledMemoryLimit) {
+    typedef Eigen::Map<const Eigen::MatrixXd> StripMap;
+
+    TiledMatFile tiled(tiled_path, false);
+    const Eigen::Index cols = tiled.GetCols();
+    const Eigen::Index tile_size = tiled.GetTileSize();
+    const Eigen::Index strip_rows =
+        PlanRowStrip(cols, tile_size, memory_limit);
+    std::vector<double> strip(static_cast<std::size_t>(strip_rows * cols));
+
+    // calls visit(strip, first_row) for every strip, top to bottom
+    const auto for_each_strip = [&](auto visit) {
+        for (Eigen::Index tile_row = 0; tile_row < tiled.GetTileRows();
+                tile_row++) {
+            const Eigen::Index tile_rows = tiled.GetRowsInTile(tile_row);
+
+            for (Eigen::Index row = 0; row < tile_rows; row += strip_rows) {
+                const Eigen::Index height =
+                    std::min(strip_rows, tile_rows - row);
+                for (Eigen::Index tile_col = 0;
+                        tile_col < tiled.GetTileCols(); tile_col++) {
+                    tiled.ReadTileBlock(
+                        tile_row, tile_col, row, 0, height,
+                        tiled.GetColsInTile(tile_col),
+                        strip.data() + tile_col * tile_size * height,
+                        height);
+                }
+
+                visit(StripMap(strip.data(), height, cols),
+                      tile_row * tile_size + row);
+            }
+        }
+    };
+
+    std::size_t width = 0;
+    if (format == MatTextFormat::kEigenAligned) {
+        for_each_strip([&](const StripMap &rows, Eigen::Index) {
+            width = std::max(width, FindStreamDefaultWidth(rows));
+        });
+    }
+
+    MatTextWriter writer(output_path);
+    WriteMatTextHeader(tiled.GetRows(), cols, writer);
+
+    // like Eigen, an empty matrix has no body at all
+    if (tiled.GetRows() == 0 || cols == 0) {
+        writer.Close();
+        return;
+    }
+
+    for_each_strip([&](const StripMap &rows, Eigen::Index first_row) {
+        WriteMatTextRows(rows, first_row, width, writer, format);
+    });
+
+    writer.Close();
+} // ConvertTiledToText
+
+#endif
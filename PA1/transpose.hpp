@@ -0,0 +1,197 @@
+#ifndef TRANSPOSE_H_
+#define TRANSPOSE_H_
+
+//!  Cache-oblivious transposes and row-major / column-major conversion.
+/*!
+  \file transpose.hpp
+  \author Jacob Hartt (jacobjhartt@gmail.com)
+  \version 1.0
+  \date 10-16-2026
+
+  A naive transpose reads one matrix contiguously and writes the other a
+  whole stride apart, so past the cache size every write misses. These
+  kernels halve the longer side of the block until it fits in L1, which
+  keeps both sides cache resident at every level of the hierarchy without
+  knowing its sizes. Square matrices are transposed in place by swapping
+  mirrored blocks the same way.
+
+  A row-major matrix holds the same bytes as the column-major storage of its
+  transpose, so converting between storage orders is one of these
+  transposes, with no intermediate copy.
+ */
+
+#include <eigen3/Eigen/Dense>
+
+#include <cassert>
+#include <utility>
+
+//! Side of the blocks the recursion stops at: a 32 x 32 block of doubles
+//! and its transpose take 16 KiB together, well inside L1.
+const Eigen::Index kTransposeLeaf = 32;
+
+//! A dense double matrix stored row by row.
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    MatrixXdRowMajor;
+
+
+//! Writes the transpose of a column-major block into another buffer.
+/*!
+  Element (row, col) of the input, in[row + col * ld_in], is written to
+  out[col + row * ld_out], so out holds the cols x rows transpose in
+  column-major order (equivalently, the input in row-major order).
+  \param in the input block
+  \param ld_in the input's leading dimension
+  \param out the output block; must not overlap the input
+  \param ld_out the output's leading dimension
+  \param rows the number of rows of the input block
+  \param cols the number of columns of the input block
+ */
+void TransposeBlock(const double *in, Eigen::Index ld_in, double *out,
+                    Eigen::Index ld_out, Eigen::Index rows,
+                    Eigen::Index cols) {
+    if (rows <= kTransposeLeaf && cols <= kTransposeLeaf) {
+        for (Eigen::Index col = 0; col < cols; col++) {
+            for (Eigen::Index row = 0; row < rows; row++) {
+                out[col + row * ld_out] = in[row + col * ld_in];
+            }
+        }
+        return;
+    }
+
+    if (rows >= cols) {
+        const Eigen::Index half = rows / 2;
+        TransposeBlock(in, ld_in, out, ld_out, half, cols);
+        TransposeBlock(in + half, ld_in, out + half * ld_out, ld_out,
+                       rows - half, cols);
+    } else {
+        const Eigen::Index half = cols / 2;
+        TransposeBlock(in, ld_in, out, ld_out, rows, half);
+        TransposeBlock(in + half * ld_in, ld_in, out + half, ld_out, rows,
+                       cols - half);
+    }
+} // TransposeBlock
+
+//! Swaps a block with the transpose of its mirror image, both in one matrix.
+/*!
+  Exchanges lower[row + col * ld] with upper[col + row * ld] for every row
+  below rows and col below cols.
+  \param lower the rows x cols block
+  \param upper the cols x rows block mirrored across the diagonal
+  \param ld the leading dimension of both
+  \param rows the number of rows of the lower block
+  \param cols the number of columns of the lower block
+ */
+void TransposeSwapBlocks(double *lower, double *upper, Eigen::Index ld,
+                         Eigen::Index rows, Eigen::Index cols) {
+    if (rows <= kTransposeLeaf && cols <= kTransposeLeaf) {
+        for (Eigen::Index col = 0; col < cols; col++) {
+            for (Eigen::Index row = 0; row < rows; row++) {
+                std::swap(lower[row + col * ld], upper[col + row * ld]);
+            }
+        }
+        return;
+    }
+
+    if (rows >= cols) {
+        const Eigen::Index half = rows / 2;
+        TransposeSwapBlocks(lower, upper, ld, half, cols);
+        TransposeSwapBlocks(lower + half, upper + half * ld, ld, rows - half,
+                            cols);
+    } else {
+        const Eigen::Index half = cols / 2;
+        TransposeSwapBlocks(lower, upper, ld, rows, half);
+        TransposeSwapBlocks(lower + half * ld, upper + half, ld, rows,
+                            cols - half);
+    }
+} // TransposeSwapBlocks
+
+//! Transposes a square column-major block in place.
+/*!
+  The two diagonal quarters are transposed recursively and the off-diagonal
+  quarters swapped with each other's transpose.
+  \param data the block's first element
+  \param ld the leading dimension
+  \param order the number of rows and columns
+ */
+void TransposeSquareInPlace(double *data, Eigen::Index ld,
+                            Eigen::Index order) {
+    if (order <= kTransposeLeaf) {
+        for (Eigen::Index col = 1; col < order; col++) {
+            for (Eigen::Index row = 0; row < col; row++) {
+                std::swap(data[row + col * ld], data[col + row * ld]);
+            }
+        }
+        return;
+    }
+
+    const Eigen::Index half = order / 2;
+    TransposeSquareInPlace(data, ld, half);
+    TransposeSquareInPlace(data + half + half * ld, ld, order - half);
+    TransposeSwapBlocks(data + half, data + half * ld, ld, order - half,
+                        half);
+} // TransposeSquareInPlace
+
+//! Computes transpose = mat^T.
+/*!
+  \param mat the matrix
+  \param transpose the output, resized to fit; must not be mat
+ */
+void Transpose(const Eigen::MatrixXd &mat, Eigen::MatrixXd &transpose) {
+    assert(&mat != &transpose);
+
+    transpose.resize(mat.cols(), mat.rows());
+    TransposeBlock(mat.data(), mat.outerStride(), transpose.data(),
+                   transpose.outerStride(), mat.rows(), mat.cols());
+} // Transpose
+
+//! Replaces mat with its transpose.
+/*!
+  Square matrices are transposed in place; any other shape needs a second
+  buffer, which takes mat's place.
+  \param mat the matrix
+ */
+void TransposeInPlace(Eigen::MatrixXd &mat) {
+    if (mat.rows() == mat.cols()) {
+        TransposeSquareInPlace(mat.data(), mat.outerStride(), mat.rows());
+        return;
+    }
+
+    Eigen::MatrixXd transpose;
+    Transpose(mat, transpose);
+    mat.swap(transpose);
+} // TransposeInPlace
+
+//! Copies a column-major matrix into row-major storage.
+/*!
+  \param col_major a matrix with contiguous column-major storage
+  \param row_major the output, resized to fit
+ */
+template <typename Derived>
+void ToRowMajor(const Eigen::MatrixBase<Derived> &col_major,
+                MatrixXdRowMajor &row_major) {
+    static_assert(!Derived::IsRowMajor, "ToRowMajor needs column-major input");
+
+    row_major.resize(col_major.rows(), col_major.cols());
+    TransposeBlock(col_major.derived().data(), col_major.outerStride(),
+                   row_major.data(), row_major.outerStride(),
+                   col_major.rows(), col_major.cols());
+} // ToRowMajor
+
+//! Copies a row-major matrix into column-major storage.
+/*!
+  \param row_major a matrix with contiguous row-major storage
+  \param col_major the output, resized to fit
+ */
+template <typename Derived>
+void ToColMajor(const Eigen::MatrixBase<Derived> &row_major,
+                Eigen::MatrixXd &col_major) {
+    static_assert(Derived::IsRowMajor, "ToColMajor needs row-major input");
+
+    // row-major rows x cols storage is column-major cols x rows storage
+    col_major.resize(row_major.rows(), row_major.cols());
+    TransposeBlock(row_major.derived().data(), row_major.outerStride(),
+                   col_major.data(), col_major.outerStride(),
+                   row_major.cols(), row_major.rows());
+} // ToColMajor
+
+#endif